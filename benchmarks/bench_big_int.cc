@@ -0,0 +1,274 @@
+#include "benchmark_helpers.h"
+#include "helpers/printing_helpers.h"
+#include "helpers/random_generators.h"
+#include "bignum/big_int.h"
+#include "bignum/montgomery.h"
+#include "bignum/fixed_int.h"
+#include "chapter31/number_theoretic.h"
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <climits>
+#include <iostream>
+#include <tuple>
+#include <utility>
+
+// Times BigInt multiplication and squaring per tier over operand sizes, searches for the
+// Karatsuba, Toom-3 and NTT crossovers, and times decimal parsing and printing, in-place
+// accumulation, modular exponentiation, gcd and fixed-width FixedInt arithmetic against BigInt.
+//
+// Options:
+//   --max-bits N   largest operand size in bits (default 100000, up to 1048576)
+//   --max-digits N largest decimal conversion in digits (default 100000, up to 1000000)
+//   --tune         also search for the crossover thresholds, in limbs
+//   --json PATH    also write the results as JSON to PATH ("-" for stdout)
+
+using BigNum::BigInt;
+
+namespace {
+  struct Tier {
+    std::string name;
+    int karatsubaThreshold;
+    int toom3Threshold;
+    int nttThreshold;
+  };
+
+  // median time of op in ns, repeating until about 50ms have been spent
+  double timeOperation(const std::function<void()> &op) {
+    std::vector<double> times;
+    double total = 0;
+    while (times.empty() || (total < 5e7 && times.size() < 1000)) {
+      Benchmark::Timer timer;
+      op();
+      times.push_back(timer.elapsedNanoseconds());
+      total += times.back();
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+  }
+
+  std::string randomDigits(std::mt19937_64 &gen, int digits) {
+    std::string str(digits, '0');
+    for (auto &c : str) c = '0' + gen() % 10;
+    str[0] = '1' + gen() % 9;
+    return str;
+  }
+
+  void setThresholds(int karatsuba, int toom3, int ntt) {
+    BigInt::KARATSUBA_THRESHOLD = karatsuba;
+    BigInt::TOOM3_THRESHOLD = toom3;
+    BigInt::NTT_THRESHOLD = ntt;
+  }
+
+  // Smallest size in limbs at which using the faster tier at the top level (with the current
+  // thresholds below it) beats the slower tier, found by timing both around each candidate
+  int findCrossover(const std::vector<int> &candidates, const std::function<void(int, bool)> &useFaster, std::mt19937_64 &gen) {
+    for (int limbs : candidates) {
+      BigInt a = randomBigInt(gen, limbs * BigInt::BASE), b = randomBigInt(gen, limbs * BigInt::BASE);
+      useFaster(limbs, false);
+      double slower = timeOperation([&] { BigInt c = a * b; });
+      useFaster(limbs, true);
+      double faster = timeOperation([&] { BigInt c = a * b; });
+      if (faster < slower) return limbs;
+    }
+    return candidates.back();
+  }
+
+  // ns per addition and multiplication of operands filling half of Bits, FixedInt against
+  // BigInt, averaged over a batch of independent operations so the timer does not dominate
+  template <int Bits>
+  void compareFixedWidth(std::mt19937_64 &gen, TableDisplay &table, Benchmark::JsonWriter &json) {
+    using Fixed = BigNum::FixedInt<Bits>;
+    const int batch = 1000;
+    std::vector<BigInt> a, b, c(batch, BigInt(0));
+    std::vector<Fixed> x, y, z(batch);
+    for (int i = 0; i < batch; ++i) {
+      a.push_back(randomBigInt(gen, Bits / 2 - 1));
+      b.push_back(randomBigInt(gen, Bits / 2 - 1));
+      x.emplace_back(a.back());
+      y.emplace_back(b.back());
+    }
+    double bigAdd = timeOperation([&] { for (int i = 0; i < batch; ++i) c[i] = a[i] + b[i]; }) / batch;
+    double bigMultiply = timeOperation([&] { for (int i = 0; i < batch; ++i) c[i] = a[i] * b[i]; }) / batch;
+    double fixedAdd = timeOperation([&] { for (int i = 0; i < batch; ++i) z[i] = x[i] + y[i]; }) / batch;
+    double fixedMultiply = timeOperation([&] { for (int i = 0; i < batch; ++i) z[i] = x[i] * y[i]; }) / batch;
+    for (auto [type, add, multiply] : {std::tuple{"BigInt", bigAdd, bigMultiply}, std::tuple{"FixedInt", fixedAdd, fixedMultiply}}) {
+      table.printRow(std::to_string(Bits), type, formatFloatPrecision(add, 1), formatFloatPrecision(multiply, 1));
+      json.field("operation", "fixed_width").field("bits", Bits).field("type", std::string(type))
+          .field("add_ns", add).field("multiply_ns", multiply).record();
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  Benchmark::Options options(argc, argv);
+  int maxBits = options.integer("max-bits", 100000);
+  std::mt19937_64 gen(options.integer("seed", 1));
+  const int defaultKaratsuba = BigInt::KARATSUBA_THRESHOLD;
+  const int defaultToom3 = BigInt::TOOM3_THRESHOLD;
+  const int defaultNtt = BigInt::NTT_THRESHOLD;
+
+  Benchmark::OutputScope output(options, "big_int");
+  std::ostream &log = output.log();
+  Benchmark::JsonWriter &json = output.json();
+
+  std::vector<Tier> tiers{
+    {"schoolbook", INT_MAX, INT_MAX, INT_MAX},
+    {"karatsuba", defaultKaratsuba, INT_MAX, INT_MAX},
+    {"toom3", defaultKaratsuba, defaultToom3, INT_MAX},
+    {"ntt", defaultKaratsuba, defaultToom3, defaultNtt},
+  };
+
+  std::vector<int> sizes{64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536, 100000, 262144, 1048576};
+  TableDisplay table{12, 12, 16, 16};
+  log << "Thresholds: KARATSUBA_THRESHOLD = " << defaultKaratsuba << ", TOOM3_THRESHOLD = " << defaultToom3
+      << ", NTT_THRESHOLD = " << defaultNtt << " limbs" << std::endl;
+  table.printHeader("bits", "tier", "multiply (ns)", "square (ns)");
+  for (int bits : sizes) {
+    if (bits > maxBits) break;
+    BigInt a = randomBigInt(gen, bits), b = randomBigInt(gen, bits);
+    for (const auto &tier : tiers) {
+      // quadratic tiers get slow quickly; skip them past the point they are useful to compare
+      if (tier.name == "schoolbook" && bits > 32768) continue;
+      if (tier.name == "karatsuba" && bits > 262144) continue;
+      setThresholds(tier.karatsubaThreshold, tier.toom3Threshold, tier.nttThreshold);
+      double multiply = timeOperation([&] { BigInt c = a * b; });
+      double square = timeOperation([&] { BigInt c = a.square(); });
+      table.printRow(std::to_string(bits), tier.name, formatFloatPrecision(multiply, 0), formatFloatPrecision(square, 0));
+      json.field("operation", "multiply").field("bits", bits).field("tier", tier.name)
+          .field("multiply_ns", multiply).field("square_ns", square).record();
+    }
+  }
+
+  if (options.flag("tune")) {
+    std::vector<int> candidates{4, 8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096, 6144, 8192};
+    int karatsuba = findCrossover(candidates, [&](int limbs, bool faster) {
+      setThresholds(faster ? limbs : limbs + 1, INT_MAX, INT_MAX);
+    }, gen);
+    // each tier only takes over from the previous one, so start its search above that threshold
+    candidates.erase(candidates.begin(), std::upper_bound(candidates.begin(), candidates.end(), karatsuba));
+    int toom3 = findCrossover(candidates, [&](int limbs, bool faster) {
+      setThresholds(karatsuba, faster ? limbs : limbs + 1, INT_MAX);
+    }, gen);
+    int ntt = findCrossover(candidates, [&](int limbs, bool faster) {
+      setThresholds(karatsuba, toom3, faster ? limbs : limbs + 1);
+    }, gen);
+    log << std::endl << "Measured crossovers: KARATSUBA_THRESHOLD = " << karatsuba << ", TOOM3_THRESHOLD = " << toom3
+        << ", NTT_THRESHOLD = " << ntt << " limbs" << std::endl;
+    json.field("operation", "crossover").field("karatsuba_threshold", karatsuba).field("toom3_threshold", toom3)
+        .field("ntt_threshold", ntt).record();
+  }
+  setThresholds(defaultKaratsuba, defaultToom3, defaultNtt);
+
+  // decimal conversion: one 19-digit chunk per limb division or multiplication ("chunked")
+  // against splitting by powers of ten ("split")
+  int maxDigits = options.integer("max-digits", 100000);
+  const int defaultRadixSplit = BigInt::RADIX_SPLIT_THRESHOLD;
+  log << std::endl << "Conversion: RADIX_SPLIT_THRESHOLD = " << defaultRadixSplit << ", BARRETT_THRESHOLD = "
+      << BigInt::BARRETT_THRESHOLD << " limbs" << std::endl;
+  table.printHeader("digits", "method", "parse (ns)", "print (ns)");
+  for (int digits : {100, 1000, 10000, 100000, 1000000}) {
+    if (digits > maxDigits) break;
+    std::string str = randomDigits(gen, digits);
+    for (bool split : {false, true}) {
+      // the chunked conversion is quadratic
+      if (!split && digits > 100000) continue;
+      BigInt::RADIX_SPLIT_THRESHOLD = split ? defaultRadixSplit : INT_MAX;
+      BigInt value = 0;
+      double parse = timeOperation([&] { value = BigInt(str); });
+      double print = timeOperation([&] { std::string printed = value.toString(); });
+      std::string method = split ? "split" : "chunked";
+      table.printRow(std::to_string(digits), method, formatFloatPrecision(parse, 0), formatFloatPrecision(print, 0));
+      json.field("operation", "convert").field("digits", digits).field("method", method)
+          .field("parse_ns", parse).field("print_ns", print).record();
+    }
+  }
+  BigInt::RADIX_SPLIT_THRESHOLD = defaultRadixSplit;
+
+  // accumulation into a 1024-bit total: time and heap allocations per operation
+  struct Accumulation {
+    std::string name;
+    std::function<void(BigInt &, const BigInt &, const BigInt &)> op;
+  };
+  std::vector<Accumulation> accumulations{
+    {"x = x + y", [](BigInt &x, const BigInt &y, const BigInt &) { x = x + y; }},
+    {"x += y", [](BigInt &x, const BigInt &y, const BigInt &) { x += y; }},
+    {"x = x + 1", [](BigInt &x, const BigInt &, const BigInt &) { x = x + BigInt(1); }},
+    {"++x", [](BigInt &x, const BigInt &, const BigInt &) { ++x; }},
+    {"x = x + y * c", [](BigInt &x, const BigInt &y, const BigInt &c) { x = x + y * c; }},
+    {"x.addmul(y, c)", [](BigInt &x, const BigInt &y, const BigInt &c) { x.addmul(y, c); }},
+  };
+  const int accumulationSteps = 100000;
+  log << std::endl;
+  TableDisplay accumulationTable{16, 12, 16};
+  accumulationTable.printHeader("operation", "ns/op", "allocs/op");
+  BigInt y = randomBigInt(gen, 1000), c = BigInt(static_cast<long long>(gen() >> 1));
+  for (const auto &accumulation : accumulations) {
+    BigInt x = randomBigInt(gen, 1024);
+    accumulation.op(x, y, c); // let the storage grow first
+    Benchmark::AllocationScope allocations;
+    Benchmark::Timer timer;
+    for (int i = 0; i < accumulationSteps; ++i) accumulation.op(x, y, c);
+    double nanoseconds = timer.elapsedNanoseconds() / accumulationSteps;
+    double allocationsPerOp = static_cast<double>(allocations.stop().allocations) / accumulationSteps;
+    accumulationTable.printRow(accumulation.name, formatFloatPrecision(nanoseconds, 1), formatFloatPrecision(allocationsPerOp, 2));
+    json.field("operation", "accumulate").field("name", accumulation.name)
+        .field("ns_per_op", nanoseconds).field("allocations_per_op", allocationsPerOp).record();
+  }
+
+  // modular exponentiation with a full-width exponent: square-and-multiply with a division per
+  // step against the Montgomery context
+  log << std::endl;
+  TableDisplay powmodTable{12, 16, 16};
+  powmodTable.printHeader("bits", "division (ns)", "montgomery (ns)");
+  for (int bits : {256, 512, 1024, 2048, 4096}) {
+    if (bits > maxBits) break;
+    BigInt modulus = randomBigInt(gen, bits);
+    if (modulus.even()) ++modulus;
+    BigInt base = randomBigInt(gen, bits - 1), exponent = randomBigInt(gen, bits);
+    BigNum::MontgomeryContext context(modulus);
+    double division = timeOperation([&] {
+      BigInt result = 1, power = base, e = exponent;
+      for (; !e.zero(); e >>= 1) {
+        if (e.odd()) result = result * power % modulus;
+        power = power.square() % modulus;
+      }
+    });
+    double montgomery = timeOperation([&] { BigInt result = context.powmod(base, exponent); });
+    powmodTable.printRow(std::to_string(bits), formatFloatPrecision(division, 0), formatFloatPrecision(montgomery, 0));
+    json.field("operation", "powmod").field("bits", bits)
+        .field("division_ns", division).field("montgomery_ns", montgomery).record();
+  }
+
+  // gcd of coprime-ish random operands: Euclid with a full division per step, Stein's binary gcd
+  // and Lehmer's gcd
+  log << std::endl;
+  TableDisplay gcdTable{12, 16, 16, 16};
+  gcdTable.printHeader("bits", "euclid (ns)", "binary (ns)", "lehmer (ns)");
+  for (int bits : {256, 1024, 4096, 16384}) {
+    if (bits > maxBits) break;
+    BigInt a = randomBigInt(gen, bits), b = randomBigInt(gen, bits);
+    double euclid = timeOperation([&] {
+      BigInt x = a, y = b;
+      while (!y.zero()) x = std::exchange(y, x % y);
+    });
+    double binary = timeOperation([&] { BigInt d = NumberTheory::binaryGcd(a, b); });
+    double lehmer = timeOperation([&] { BigInt d = NumberTheory::gcd(a, b); });
+    gcdTable.printRow(std::to_string(bits), formatFloatPrecision(euclid, 0), formatFloatPrecision(binary, 0), formatFloatPrecision(lehmer, 0));
+    json.field("operation", "gcd").field("bits", bits).field("euclid_ns", euclid)
+        .field("binary_ns", binary).field("lehmer_ns", lehmer).record();
+  }
+
+  // fixed-width arithmetic: stack limbs with compile-time loop bounds against heap-backed BigInt
+  log << std::endl;
+  TableDisplay fixedTable{12, 12, 12, 16};
+  fixedTable.printHeader("bits", "type", "add (ns)", "multiply (ns)");
+  compareFixedWidth<128>(gen, fixedTable, json);
+  compareFixedWidth<256>(gen, fixedTable, json);
+  compareFixedWidth<512>(gen, fixedTable, json);
+  compareFixedWidth<2048>(gen, fixedTable, json);
+  return 0;
+}
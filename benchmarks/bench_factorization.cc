@@ -0,0 +1,64 @@
+#include "benchmark_helpers.h"
+#include "helpers/printing_helpers.h"
+#include "helpers/random_generators.h"
+#include "bignum/big_int.h"
+#include "chapter31/factorization.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <iostream>
+
+// Wall time of factor() on products of random primes too large for the unit tests, over 1, 2, 4, ...
+// threads with the speedup over one thread. Primes up to about 36 bits fall to Pollard-Brent, and
+// the larger small factors need ECM curves run against a big cofactor.
+//
+// Options:
+//   --max-threads N   largest thread count, doubling from 1 (default: the hardware concurrency)
+//   --seed S          seed for the primes (default 1)
+//   --json PATH       also write the results as JSON to PATH ("-" for stdout)
+
+using BigNum::BigInt;
+
+namespace {
+  // bit sizes of the prime factors of each input
+  const std::vector<std::vector<int>> CASES{{20, 36, 40, 120}, {42, 160}, {48, 200}};
+}
+
+int main(int argc, char **argv) {
+  Benchmark::Options options(argc, argv);
+  int maxThreads = options.integer("max-threads", std::max(1u, std::thread::hardware_concurrency()));
+  std::mt19937_64 gen(options.integer("seed", 1));
+
+  Benchmark::OutputScope output(options, "factorization");
+  std::ostream &log = output.log();
+  Benchmark::JsonWriter &json = output.json();
+
+  log << "seconds per factorization" << std::endl;
+  TableDisplay table{20, 10, 12, 10};
+  table.printHeader("primes (bits)", "threads", "seconds", "speedup");
+  for (const auto &primeBits : CASES) {
+    std::string name;
+    for (int bits : primeBits) name += (name.empty() ? "" : "+") + std::to_string(bits);
+    std::vector<BigInt> primes;
+    for (int bits : primeBits) primes.push_back(randomPrime(gen, bits));
+    std::sort(primes.begin(), primes.end());
+    BigInt n = 1;
+    for (const auto &p : primes) n = n * p;
+
+    double baseline = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+      Benchmark::Timer timer;
+      std::vector<BigInt> factors = NumberTheory::factor(n, threads);
+      double seconds = timer.elapsedNanoseconds() * 1e-9;
+      if (factors != primes) std::cerr << "factorization mismatch for " << name << std::endl;
+      if (threads == 1) baseline = seconds;
+      table.printRow(name, std::to_string(threads), formatFloatPrecision(seconds, 3), formatFloatPrecision(baseline / seconds, 2));
+      json.field("primes", name).field("threads", threads).field("seconds", seconds)
+          .field("speedup", baseline / seconds).record();
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include "benchmark_helpers.h"
+#include "helpers/printing_helpers.h"
+#include "chapter11/open_addressing.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <iostream>
+
+// Times std::unordered_map against Chapter11::FlatHashMap with int and string keys over table
+// sizes. Each (map, key, size) cell reports ns per operation for
+//   insert       inserting n distinct keys into an empty map
+//   hit          finding keys that are present, in random order
+//   miss         finding keys that are absent
+//   erase        erasing every key, in random order
+// and the heap allocations made by the inserts.
+//
+// Options:
+//   --max-size N   largest table size, powers of ten from 1000 (default 1e6)
+//   --seed S       seed for the keys (default 1)
+//   --json PATH    also write the results as JSON to PATH ("-" for stdout)
+
+namespace {
+  struct Result {
+    double insert, hit, miss, erase, allocationsPerInsert;
+  };
+
+  // Strings of 12 to 31 characters, some short enough for the small string buffer
+  std::string toKey(uint64_t value, std::string*) {
+    std::string key = "key:" + std::to_string(value);
+    key.resize(12 + value % 20, '#');
+    return key;
+  }
+  int toKey(uint64_t value, int*) { return static_cast<int>(value & 0x7FFFFFFF); }
+
+  template <typename Map>
+  Result measure(const std::vector<typename Map::key_type> &keys, const std::vector<typename Map::key_type> &absent,
+                 const std::vector<typename Map::key_type> &shuffled) {
+    const double n = keys.size();
+    Result result{};
+    Map map;
+    Benchmark::AllocationScope allocations;
+    Benchmark::Timer insertTimer;
+    for (const auto &key : keys) map.emplace(key, 1);
+    result.insert = insertTimer.elapsedNanoseconds() / n;
+    result.allocationsPerInsert = allocations.stop().allocations / n;
+
+    long long found = 0;
+    Benchmark::Timer hitTimer;
+    for (const auto &key : shuffled) found += map.count(key);
+    result.hit = hitTimer.elapsedNanoseconds() / n;
+    Benchmark::Timer missTimer;
+    for (const auto &key : absent) found += map.count(key);
+    result.miss = missTimer.elapsedNanoseconds() / n;
+    if (found != static_cast<long long>(n)) std::cerr << "lookup mismatch" << std::endl;
+
+    Benchmark::Timer eraseTimer;
+    for (const auto &key : shuffled) map.erase(key);
+    result.erase = eraseTimer.elapsedNanoseconds() / n;
+    return result;
+  }
+
+  template <typename Key>
+  void compare(const std::string &keyName, int size, std::mt19937_64 &gen, TableDisplay &table, Benchmark::JsonWriter &json) {
+    // distinct keys: the even draws are inserted and the odd ones only looked up
+    std::vector<Key> keys, absent;
+    for (int i = 0; i < size; ++i) {
+      uint64_t value = gen() & ~uint64_t{1} & 0x7FFFFFFF;
+      keys.push_back(toKey(value, static_cast<Key*>(nullptr)));
+      absent.push_back(toKey(value | 1, static_cast<Key*>(nullptr)));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::shuffle(keys.begin(), keys.end(), gen);
+    std::vector<Key> shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), gen);
+
+    auto report = [&](const std::string &mapName, const Result &r) {
+      table.printRow(std::to_string(size), keyName, mapName, formatFloatPrecision(r.insert, 1), formatFloatPrecision(r.hit, 1),
+                     formatFloatPrecision(r.miss, 1), formatFloatPrecision(r.erase, 1),
+                     formatFloatPrecision(r.allocationsPerInsert, 2));
+      json.field("size", size).field("key", keyName).field("map", mapName).field("insert_ns", r.insert)
+          .field("hit_ns", r.hit).field("miss_ns", r.miss).field("erase_ns", r.erase)
+          .field("allocations_per_insert", r.allocationsPerInsert).record();
+    };
+    report("unordered_map", measure<std::unordered_map<Key, int>>(keys, absent, shuffled));
+    report("flat", measure<Chapter11::FlatHashMap<Key, int>>(keys, absent, shuffled));
+  }
+}
+
+int main(int argc, char **argv) {
+  Benchmark::Options options(argc, argv);
+  long long maxSize = options.integer("max-size", 1000000);
+  std::mt19937_64 gen(options.integer("seed", 1));
+
+  Benchmark::OutputScope output(options, "hash_map");
+  std::ostream &log = output.log();
+  Benchmark::JsonWriter &json = output.json();
+
+  log << "ns/op" << std::endl;
+  TableDisplay table{10, 8, 14, 10, 10, 10, 10, 14};
+  table.printHeader("size", "key", "map", "insert", "hit", "miss", "erase", "allocs/insert");
+  for (long long size = 1000; size <= maxSize; size *= 10) {
+    compare<int>("int", size, gen, table, json);
+    compare<std::string>("string", size, gen, table, json);
+  }
+  return 0;
+}
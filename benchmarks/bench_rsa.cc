@@ -0,0 +1,86 @@
+#include "benchmark_helpers.h"
+#include "helpers/printing_helpers.h"
+#include "helpers/random_generators.h"
+#include "bignum/big_int.h"
+#include "chapter31/rsa.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <iostream>
+
+// Throughput of RSA with e = 65537 over modulus sizes, in operations per second: generating one key,
+// encryption, decryption by a single exponentiation modulo n and by the Chinese remainder theorem,
+// and batch signing over several threads.
+//
+// Options:
+//   --max-bits N   largest modulus in bits, doubling from 1024 (default 4096)
+//   --threads N    threads for batch signing (default: the hardware concurrency)
+//   --seed S       seed for the keys and messages (default 1)
+//   --json PATH    also write the results as JSON to PATH ("-" for stdout)
+
+using BigNum::BigInt;
+using NumberTheory::RsaPrivateKey;
+using NumberTheory::RsaPublicKey;
+
+namespace {
+  // operations per second of op applied to every input, repeating whole passes until about
+  // 200ms have been spent
+  template <typename Op>
+  double throughput(const std::vector<BigInt> &inputs, Op op) {
+    long long operations = 0;
+    Benchmark::Timer timer;
+    do {
+      for (const auto &input : inputs) op(input);
+      operations += inputs.size();
+    } while (timer.elapsedNanoseconds() < 2e8);
+    return operations / (timer.elapsedNanoseconds() * 1e-9);
+  }
+}
+
+int main(int argc, char **argv) {
+  Benchmark::Options options(argc, argv);
+  int maxBits = options.integer("max-bits", 4096);
+  int threads = options.integer("threads", std::max(1u, std::thread::hardware_concurrency()));
+  std::mt19937_64 gen(options.integer("seed", 1));
+
+  Benchmark::OutputScope output(options, "rsa");
+  std::ostream &log = output.log();
+  Benchmark::JsonWriter &json = output.json();
+
+  log << "ops/sec; batch signing uses " << threads << " thread(s)" << std::endl;
+  TableDisplay table{8, 12, 12, 14, 14, 10, 14};
+  table.printHeader("bits", "keygen", "encrypt", "decrypt", "decrypt crt", "speedup", "batch sign");
+  for (int bits = 1024; bits <= maxBits; bits *= 2) {
+    Benchmark::Timer keygenTimer;
+    RsaPrivateKey key = RsaPrivateKey::generate(bits, gen);
+    double keygen = 1 / (keygenTimer.elapsedNanoseconds() * 1e-9);
+    RsaPublicKey publicKey = key.publicKey();
+
+    std::vector<BigInt> messages;
+    for (int i = 0; i < 32; ++i) messages.push_back(randomBelow(gen, key.modulus()));
+    std::vector<BigInt> ciphertexts;
+    for (const auto &m : messages) ciphertexts.push_back(publicKey.encrypt(m));
+
+    double encrypt = throughput(messages, [&](const BigInt &m) { BigInt c = publicKey.encrypt(m); });
+    double plain = throughput(ciphertexts, [&](const BigInt &c) { BigInt m = key.decryptWithoutCrt(c); });
+    double crt = throughput(ciphertexts, [&](const BigInt &c) { BigInt m = key.decrypt(c); });
+    long long signatures = 0;
+    Benchmark::Timer batchTimer;
+    do {
+      signatures += key.sign(messages, threads).size();
+    } while (batchTimer.elapsedNanoseconds() < 2e8);
+    double batch = signatures / (batchTimer.elapsedNanoseconds() * 1e-9);
+
+    table.printRow(std::to_string(bits), formatFloatPrecision(keygen, 2), formatFloatPrecision(encrypt, 0),
+                   formatFloatPrecision(plain, 1), formatFloatPrecision(crt, 1), formatFloatPrecision(crt / plain, 2),
+                   formatFloatPrecision(batch, 1));
+    json.field("bits", bits).field("threads", threads).field("keygen_per_sec", keygen)
+        .field("encrypt_per_sec", encrypt).field("decrypt_per_sec", plain).field("decrypt_crt_per_sec", crt)
+        .field("batch_sign_per_sec", batch).record();
+  }
+
+  return 0;
+}
@@ -0,0 +1,331 @@
+#include "benchmark_helpers.h"
+#include "helpers/printing_helpers.h"
+#include "chapter2/sorting.h"
+#include "chapter5/random.h"
+#include "chapter6/heaps.h"
+#include "chapter7/quick_sort.h"
+#include "chapter8/linear_sorting.h"
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <random>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+// Runs every sort in Chapter2, Chapter6, Chapter7 and Chapter8 over a matrix of input sizes and
+// distributions. Each (sort, distribution, size) cell reports
+//   ns/element   median wall time of the timed runs on std::vector<int> divided by n
+//   comparisons  comparator calls, from one extra run on Tracked elements
+//   moves        copies/moves of Tracked elements (a std::swap is 3 moves)
+//   allocations  heap allocations (and bytes) made by one timed run
+//
+// Options:
+//   --max-size N          largest input size, powers of ten from 10 (default 1e6, up to 1e8)
+//   --count-max-size N    largest size that also gets the counting run (default 1e6)
+//   --filter TEXT         only sorts whose name contains TEXT
+//   --distribution NAME   only this distribution
+//   --seed S              seed for the inputs and the randomized partitions (default 1)
+//   --max-threads N       thread counts swept by the parallel scaling table, doubling from 1
+//                         (default: the hardware concurrency, at least 2)
+//   --json PATH           also write the results as JSON to PATH ("-" for stdout)
+//
+// After the matrix, the parallel sorts are timed on random input of --max-size elements for each
+// thread count, with the speedup over one thread. Those JSON records carry a "threads" field.
+
+namespace {
+  // sorts with quadratic running time on the given inputs are only run up to this size
+  constexpr int QUADRATIC_SIZE_CAP = 20000;
+
+  enum class Distribution { Random, Sorted, Reverse, OrganPipe, FewUnique, Zipf, AllEqual, NearlySorted };
+
+  const std::vector<std::pair<Distribution, std::string>> DISTRIBUTIONS{
+    {Distribution::Random, "random"},
+    {Distribution::Sorted, "sorted"},
+    {Distribution::Reverse, "reverse"},
+    {Distribution::OrganPipe, "organ-pipe"},
+    {Distribution::FewUnique, "few-unique"},
+    {Distribution::Zipf, "zipf"},
+    {Distribution::AllEqual, "all-equal"},
+    {Distribution::NearlySorted, "nearly-sorted"},
+  };
+
+  // Values are in [0, n) so the counting and decimal radix sorts apply to every input
+  std::vector<int> generateInput(Distribution distribution, int n, uint64_t seed) {
+    Chapter5::Xoshiro256 gen(seed);
+    std::vector<int> vec(n);
+    switch (distribution) {
+      case Distribution::Random: {
+        std::uniform_int_distribution<int> uniform(0, n - 1);
+        for (auto &x : vec) x = uniform(gen);
+        break;
+      }
+      case Distribution::Sorted:
+        std::iota(vec.begin(), vec.end(), 0);
+        break;
+      case Distribution::Reverse:
+        std::iota(vec.rbegin(), vec.rend(), 0);
+        break;
+      case Distribution::OrganPipe:
+        for (int i = 0; i < n; ++i) vec[i] = std::min(i, n - 1 - i);
+        break;
+      case Distribution::FewUnique: {
+        std::uniform_int_distribution<int> uniform(0, std::min(n, 16) - 1);
+        for (auto &x : vec) x = uniform(gen);
+        break;
+      }
+      case Distribution::Zipf: {
+        // P(value = k) proportional to 1 / (k + 1), sampled by inverting the cdf
+        int universe = std::min(n, 1 << 20);
+        std::vector<double> cdf(universe);
+        double total = 0;
+        for (int k = 0; k < universe; ++k) cdf[k] = total += 1.0 / (k + 1);
+        std::uniform_real_distribution<double> uniform(0, total);
+        for (auto &x : vec) {
+          x = std::lower_bound(cdf.begin(), cdf.end(), uniform(gen)) - cdf.begin();
+          x = std::min(x, universe - 1);
+        }
+        break;
+      }
+      case Distribution::AllEqual:
+        std::fill(vec.begin(), vec.end(), n / 2);
+        break;
+      case Distribution::NearlySorted: {
+        std::iota(vec.begin(), vec.end(), 0);
+        std::uniform_int_distribution<int> index(0, n - 1);
+        for (int swaps = std::max(1, n / 100); swaps > 0; --swaps) std::swap(vec[index(gen)], vec[index(gen)]);
+        break;
+      }
+    }
+    return vec;
+  }
+
+  // Element that counts its copies and moves
+  struct Tracked {
+    int value = 0;
+    static inline std::atomic<long long> moves{0};
+
+    Tracked() = default;
+    Tracked(int v) : value{v} {}
+    Tracked(const Tracked &other) : value{other.value} { moves.fetch_add(1, std::memory_order_relaxed); }
+    Tracked(Tracked &&other) noexcept : value{other.value} { moves.fetch_add(1, std::memory_order_relaxed); }
+    Tracked &operator=(const Tracked &other) {
+      value = other.value;
+      moves.fetch_add(1, std::memory_order_relaxed);
+      return *this;
+    }
+    Tracked &operator=(Tracked &&other) noexcept {
+      value = other.value;
+      moves.fetch_add(1, std::memory_order_relaxed);
+      return *this;
+    }
+  };
+
+  struct CountingLess {
+    static inline std::atomic<long long> comparisons{0};
+    bool operator()(const Tracked &a, const Tracked &b) const {
+      comparisons.fetch_add(1, std::memory_order_relaxed);
+      return a.value < b.value;
+    }
+  };
+
+  struct SortEntry {
+    std::string name;
+    std::function<void(std::vector<int> &)> sort;
+    // counting run on Tracked elements; empty for sorts that only accept arithmetic types
+    std::function<void(std::vector<Tracked> &)> countedSort;
+    // distributions on which the sort is quadratic, capped at QUADRATIC_SIZE_CAP
+    std::vector<Distribution> quadraticOn;
+  };
+
+  const std::vector<Distribution> ALL_DISTRIBUTIONS{
+    Distribution::Random, Distribution::Sorted, Distribution::Reverse, Distribution::OrganPipe,
+    Distribution::FewUnique, Distribution::Zipf, Distribution::AllEqual, Distribution::NearlySorted};
+
+  const std::vector<Distribution> DUPLICATE_KEYS{Distribution::FewUnique, Distribution::Zipf, Distribution::AllEqual};
+
+  // comparison sorts are written once as a generic lambda and run on both element types
+  template <typename Sort>
+  SortEntry comparisonSort(const std::string &name, Sort sort, std::vector<Distribution> quadraticOn = {}) {
+    return {name,
+            [sort](std::vector<int> &vec) { sort(vec, std::less<int>()); },
+            [sort](std::vector<Tracked> &vec) { sort(vec, CountingLess()); },
+            quadraticOn};
+  }
+
+  int maxValue(const std::vector<int> &vec) {
+    return vec.empty() ? 0 : *std::max_element(vec.begin(), vec.end());
+  }
+
+  std::vector<SortEntry> sortEntries() {
+    using Chapter7::PartitionScheme;
+    return {
+      comparisonSort("Chapter2::insertionSort", [](auto &vec, auto comp) { Chapter2::insertionSort(vec, comp); }, ALL_DISTRIBUTIONS),
+      comparisonSort("Chapter2::selectionSort", [](auto &vec, auto comp) { Chapter2::selectionSort(vec, comp); }, ALL_DISTRIBUTIONS),
+      comparisonSort("Chapter2::mergeSort", [](auto &vec, auto comp) { Chapter2::mergeSort(vec, comp); }),
+      comparisonSort("Chapter2::bufferedMergeSort", [](auto &vec, auto comp) { Chapter2::bufferedMergeSort(vec, comp); }),
+      comparisonSort("Chapter2::parallelMergeSort", [](auto &vec, auto comp) { Chapter2::parallelMergeSort(vec, comp); }),
+      comparisonSort("Chapter6::heapSort", [](auto &vec, auto comp) { Chapter6::heapSort(vec, comp); }),
+      comparisonSort("Chapter7::quickSort", [](auto &vec, auto comp) { Chapter7::quickSort(vec, comp); }),
+      comparisonSort("Chapter7::quickSort<Block>", [](auto &vec, auto comp) {
+        Chapter7::quickSort<typename std::decay_t<decltype(vec)>::value_type, decltype(comp), PartitionScheme::Block>(vec, comp);
+      }),
+      comparisonSort("Chapter7::randomQuickSort", [](auto &vec, auto comp) { Chapter7::randomQuickSort(vec, comp); }, DUPLICATE_KEYS),
+      comparisonSort("Chapter7::randomQuickSort<Block>", [](auto &vec, auto comp) {
+        Chapter7::randomQuickSort<typename std::decay_t<decltype(vec)>::value_type, decltype(comp), PartitionScheme::Block>(vec, comp);
+      }, DUPLICATE_KEYS),
+      comparisonSort("Chapter7::parallelQuickSort", [](auto &vec, auto comp) { Chapter7::parallelQuickSort(vec, comp); }),
+      comparisonSort("Chapter7::introSort", [](auto &vec, auto comp) { Chapter7::introSort(vec, comp); }),
+      {"Chapter8::countingSort",
+       [](std::vector<int> &vec) { Chapter8::countingSort(vec, maxValue(vec)); },
+       [](std::vector<Tracked> &vec) {
+         int k = 0;
+         for (const auto &x : vec) k = std::max(k, x.value);
+         Chapter8::countingSort(vec, k, [](const Tracked &x) { return x.value; });
+       }},
+      // the key through a std::function, i.e. an indirect call per element, against the inlined key above
+      {"Chapter8::countingSort(function)", [](std::vector<int> &vec) {
+         std::function<int(int)> key = [](int x) { return x; };
+         Chapter8::countingSort(vec, maxValue(vec), key);
+       }},
+      {"Chapter8::radixSort", [](std::vector<int> &vec) { Chapter8::radixSort(vec); }},
+      {"Chapter8::lsdRadixSort",
+       [](std::vector<int> &vec) { Chapter8::lsdRadixSort(vec); },
+       [](std::vector<Tracked> &vec) { Chapter8::lsdRadixSortByKey(vec, [](const Tracked &x) { return x.value; }); }},
+      {"Chapter8::parallelRadixSort", [](std::vector<int> &vec) { Chapter8::parallelRadixSort(vec); }},
+      {"Chapter8::bucketSort", [](std::vector<int> &vec) { Chapter8::bucketSort(vec); }},
+    };
+  }
+
+  double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    int n = values.size();
+    return n % 2 ? values[n/2] : (values[n/2 - 1] + values[n/2]) / 2;
+  }
+
+  struct ParallelEntry {
+    std::string name;
+    std::function<void(std::vector<int> &, int)> sort; // sorts with the given number of threads
+  };
+
+  std::vector<ParallelEntry> parallelEntries() {
+    return {
+      {"Chapter2::parallelMergeSort", [](std::vector<int> &vec, int threads) { Chapter2::parallelMergeSort(vec, std::less<int>(), threads); }},
+      {"Chapter7::parallelQuickSort", [](std::vector<int> &vec, int threads) { Chapter7::parallelQuickSort(vec, std::less<int>(), threads); }},
+      {"Chapter8::parallelRadixSort", [](std::vector<int> &vec, int threads) { Chapter8::parallelRadixSort(vec, threads); }},
+    };
+  }
+}
+
+int main(int argc, char **argv) {
+  Benchmark::Options options(argc, argv);
+  long long maxSize = std::clamp(options.integer("max-size", 1000000), 10LL, 100000000LL);
+  long long countMaxSize = options.integer("count-max-size", 1000000);
+  std::string filter = options.string("filter", "");
+  std::string onlyDistribution = options.string("distribution", "");
+  uint64_t seed = options.integer("seed", 1);
+  int maxThreads = options.integer("max-threads", std::max(2u, std::thread::hardware_concurrency()));
+
+  // the benchmark builds with -O2, but keep a volatile sink so a sort is never optimized away
+  volatile int sink = 0;
+  TableDisplay table{34, 14, 10, 6, 12, 14, 14, 12};
+  Benchmark::OutputScope output(options, "sorting");
+  std::ostream &log = output.log();
+  Benchmark::JsonWriter &json = output.json();
+
+  for (const auto &[distribution, distributionName] : DISTRIBUTIONS) {
+    if (!onlyDistribution.empty() && onlyDistribution != distributionName) continue;
+    log << "\nDistribution: " << distributionName << std::endl;
+    table.printHeader("sort", "distribution", "n", "reps", "ns/element", "comparisons", "moves", "allocations");
+
+    for (const auto &entry : sortEntries()) {
+      if (entry.name.find(filter) == std::string::npos) continue;
+      bool quadratic = std::find(entry.quadraticOn.begin(), entry.quadraticOn.end(), distribution) != entry.quadraticOn.end();
+      long long sizeCap = quadratic ? std::min<long long>(maxSize, QUADRATIC_SIZE_CAP) : maxSize;
+
+      for (long long n = 10; n <= sizeCap; n *= 10) {
+        std::vector<int> input = generateInput(distribution, n, seed);
+
+        // repeat small sizes until about 0.2s of sorting, so short runs aren't dominated by noise
+        std::vector<double> times;
+        Benchmark::AllocationCount allocations;
+        double total = 0;
+        while (times.empty() || (total < 2e8 && times.size() < 1000)) {
+          std::vector<int> vec = input;
+          Chapter5::seedThreadRandom(seed);
+          Benchmark::AllocationScope allocationScope;
+          Benchmark::Timer timer;
+          entry.sort(vec);
+          double elapsed = timer.elapsedNanoseconds();
+          if (times.empty()) allocations = allocationScope.stop();
+          times.push_back(elapsed);
+          total += elapsed;
+          sink = sink + vec[n / 2];
+        }
+        double nsPerElement = median(times) / n;
+
+        long long comparisons = -1, moves = -1;
+        if (entry.countedSort && n <= countMaxSize) {
+          std::vector<Tracked> tracked(input.begin(), input.end());
+          Chapter5::seedThreadRandom(seed);
+          CountingLess::comparisons = 0;
+          Tracked::moves = 0;
+          entry.countedSort(tracked);
+          comparisons = CountingLess::comparisons;
+          moves = Tracked::moves;
+        }
+
+        auto countString = [](long long count) { return count < 0 ? std::string("-") : std::to_string(count); };
+        table.printRow(entry.name, distributionName, std::to_string(n), std::to_string(times.size()),
+                       formatFloatPrecision(nsPerElement, 2), countString(comparisons), countString(moves),
+                       std::to_string(allocations.allocations));
+
+        json.field("sort", entry.name)
+            .field("distribution", distributionName)
+            .field("size", n)
+            .field("repetitions", static_cast<long long>(times.size()))
+            .field("ns_per_element", nsPerElement)
+            .field("min_ns_per_element", *std::min_element(times.begin(), times.end()) / n);
+        if (comparisons < 0) json.nullField("comparisons").nullField("moves");
+        else json.field("comparisons", comparisons).field("moves", moves);
+        json.field("allocations", allocations.allocations).field("allocated_bytes", allocations.bytes);
+        json.record();
+      }
+    }
+  }
+
+  bool anyParallel = false;
+  for (const auto &entry : parallelEntries()) anyParallel = anyParallel || entry.name.find(filter) != std::string::npos;
+  if (anyParallel && (onlyDistribution.empty() || onlyDistribution == "random")) {
+    int n = maxSize;
+    std::vector<int> input = generateInput(Distribution::Random, n, seed);
+    log << "\nParallel scaling, random input, n = " << n << std::endl;
+    TableDisplay scalingTable{34, 10, 14, 12};
+    scalingTable.printHeader("sort", "threads", "ns/element", "speedup");
+    for (const auto &entry : parallelEntries()) {
+      if (entry.name.find(filter) == std::string::npos) continue;
+      double baseline = 0;
+      for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        std::vector<double> times;
+        for (int rep = 0; rep < 3; ++rep) {
+          std::vector<int> vec = input;
+          Benchmark::Timer timer;
+          entry.sort(vec, threads);
+          times.push_back(timer.elapsedNanoseconds());
+          sink = sink + vec[n / 2];
+        }
+        double nsPerElement = median(times) / n;
+        if (threads == 1) baseline = nsPerElement;
+        scalingTable.printRow(entry.name, std::to_string(threads), formatFloatPrecision(nsPerElement, 2),
+                              formatFloatPrecision(baseline / nsPerElement, 2));
+        json.field("sort", entry.name).field("distribution", "random").field("size", n).field("threads", threads)
+            .field("ns_per_element", nsPerElement).field("speedup", baseline / nsPerElement).record();
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,147 @@
+#include "benchmark_helpers.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+
+namespace {
+  std::atomic<long long> allocations{0};
+  std::atomic<long long> allocatedBytes{0};
+
+  void *countedAllocate(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+  }
+
+  void *countedAllocate(std::size_t size, std::align_val_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    // aligned_alloc requires the size to be a multiple of the alignment
+    if (void *p = std::aligned_alloc(align, (std::max(size, std::size_t{1}) + align - 1) / align * align)) return p;
+    throw std::bad_alloc();
+  }
+}
+
+void *operator new(std::size_t size) { return countedAllocate(size); }
+void *operator new[](std::size_t size) { return countedAllocate(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return countedAllocate(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return countedAllocate(size, alignment); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace Benchmark {
+  AllocationCount allocationCount() {
+    return {allocations.load(std::memory_order_relaxed), allocatedBytes.load(std::memory_order_relaxed)};
+  }
+
+  AllocationCount AllocationScope::stop() const {
+    AllocationCount now = allocationCount();
+    return {now.allocations - start.allocations, now.bytes - start.bytes};
+  }
+
+  double Timer::elapsedNanoseconds() const {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  Options::Options(int argc, char **argv) : args(argv + 1, argv + argc) {}
+
+  bool Options::flag(const std::string &name) const {
+    return std::find(args.begin(), args.end(), "--" + name) != args.end();
+  }
+
+  std::optional<std::string> Options::value(const std::string &name) const {
+    auto it = std::find(args.begin(), args.end(), "--" + name);
+    if (it == args.end() || it + 1 == args.end() || (it + 1)->rfind("--", 0) == 0) return std::nullopt;
+    return *(it + 1);
+  }
+
+  long long Options::integer(const std::string &name, long long fallback) const {
+    auto v = value(name);
+    return v ? std::llround(std::stod(*v)) : fallback;
+  }
+
+  std::string Options::string(const std::string &name, const std::string &fallback) const {
+    return value(name).value_or(fallback);
+  }
+
+  std::string escapeJson(const std::string &s) {
+    std::string escaped;
+    for (char c : s) {
+      if (c == '"' || c == '\\') escaped += '\\';
+      escaped += c;
+    }
+    return escaped;
+  }
+
+  JsonWriter &JsonWriter::field(const std::string &key, const std::string &value) {
+    current << (firstField ? "" : ", ") << '"' << escapeJson(key) << "\": \"" << escapeJson(value) << '"';
+    firstField = false;
+    return *this;
+  }
+
+  JsonWriter &JsonWriter::field(const std::string &key, const char *value) {
+    return field(key, std::string(value));
+  }
+
+  JsonWriter &JsonWriter::field(const std::string &key, double value) {
+    current << (firstField ? "" : ", ") << '"' << escapeJson(key) << "\": " << std::setprecision(6) << value;
+    firstField = false;
+    return *this;
+  }
+
+  JsonWriter &JsonWriter::field(const std::string &key, long long value) {
+    current << (firstField ? "" : ", ") << '"' << escapeJson(key) << "\": " << value;
+    firstField = false;
+    return *this;
+  }
+
+  JsonWriter &JsonWriter::nullField(const std::string &key) {
+    current << (firstField ? "" : ", ") << '"' << escapeJson(key) << "\": null";
+    firstField = false;
+    return *this;
+  }
+
+  void JsonWriter::record() {
+    records << (recordCount++ ? ",\n" : "\n") << "    {" << current.str() << "}";
+    current.str("");
+    firstField = true;
+  }
+
+  void JsonWriter::write(std::ostream &os, const std::string &benchmarkName) const {
+    os << "{\n  \"benchmark\": \"" << escapeJson(benchmarkName) << "\",\n  \"results\": [" << records.str() << "\n  ]\n}\n";
+  }
+
+  OutputScope::OutputScope(const Options &options, const std::string &suiteName)
+      : jsonPath{options.value("json")}, suiteName{suiteName}, previous{std::cout.rdbuf()} {
+    if (jsonPath && *jsonPath == "-") std::cout.rdbuf(std::cerr.rdbuf());
+  }
+
+  OutputScope::~OutputScope() {
+    std::cout.rdbuf(previous);
+    if (!jsonPath) return;
+    if (*jsonPath == "-") {
+      writer.write(std::cout, suiteName);
+    } else {
+      std::ofstream file(*jsonPath);
+      writer.write(file, suiteName);
+    }
+  }
+
+  std::ostream &OutputScope::log() const {
+    return jsonPath && *jsonPath == "-" ? std::cerr : std::cout;
+  }
+}
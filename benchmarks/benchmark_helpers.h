@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <sstream>
+#include <optional>
+#include <streambuf>
+
+// Shared pieces of the benchmark executables: allocation counting, timing, command line
+// options and JSON output. Linking benchmarks_common_library replaces the global operator
+// new/delete so every heap allocation in the process is counted.
+
+namespace Benchmark {
+  struct AllocationCount {
+    long long allocations = 0;
+    long long bytes = 0;
+  };
+
+  // allocations since the start of the program, from all threads
+  AllocationCount allocationCount();
+
+  // difference of allocationCount() between construction and stop()
+  class AllocationScope {
+    AllocationCount start;
+   public:
+    AllocationScope() : start{allocationCount()} {}
+    AllocationCount stop() const;
+  };
+
+  class Timer {
+    std::chrono::steady_clock::time_point start;
+   public:
+    Timer() : start{std::chrono::steady_clock::now()} {}
+    double elapsedNanoseconds() const;
+  };
+
+  // Parses "--name value" and "--name" style flags. Values accept exponent notation so
+  // --max-size 1e8 works.
+  class Options {
+    std::vector<std::string> args;
+   public:
+    Options(int argc, char **argv);
+    bool flag(const std::string &name) const;
+    std::optional<std::string> value(const std::string &name) const;
+    long long integer(const std::string &name, long long fallback) const;
+    std::string string(const std::string &name, const std::string &fallback) const;
+  };
+
+  // Writes an array of flat JSON objects, one per record(). Fields are emitted in insertion order.
+  class JsonWriter {
+    std::ostringstream records;
+    std::ostringstream current;
+    int recordCount = 0;
+    bool firstField = true;
+   public:
+    JsonWriter &field(const std::string &key, const std::string &value);
+    JsonWriter &field(const std::string &key, const char *value);
+    JsonWriter &field(const std::string &key, double value);
+    JsonWriter &field(const std::string &key, long long value);
+    JsonWriter &field(const std::string &key, int value) { return field(key, static_cast<long long>(value)); }
+    JsonWriter &nullField(const std::string &key);
+    void record();
+    // {"benchmark": name, "results": [...]}
+    void write(std::ostream &os, const std::string &benchmarkName) const;
+  };
+
+  // Output of a benchmark main for its lifetime. With --json - the JSON goes to stdout, so std::cout
+  // (which TableDisplay prints to) is redirected to stderr until the scope ends. On destruction
+  // json() is written to the --json path, if one was given, under the suite name.
+  class OutputScope {
+    std::optional<std::string> jsonPath;
+    std::string suiteName;
+    std::streambuf *previous;
+    JsonWriter writer;
+   public:
+    OutputScope(const Options &options, const std::string &suiteName);
+    ~OutputScope();
+    OutputScope(const OutputScope &) = delete;
+    OutputScope &operator=(const OutputScope &) = delete;
+
+    // where progress and tables go: std::cerr under --json -, else std::cout
+    std::ostream &log() const;
+    JsonWriter &json() { return writer; }
+  };
+
+  std::string escapeJson(const std::string &s);
+}
@@ -2,27 +2,42 @@
 
 #include "bignum/operations.h"
 
-#include <deque>
+#include <vector>
 #include <string>
 #include <iostream>
 #include <concepts>
 #include <compare>
 #include <chrono>
+#include <charconv>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 #include <unordered_map>
-#include <vector>
 
 
 namespace BigNum {
 
+class MontgomeryContext;
+template <int Bits> class FixedInt;
+
 class BigInt {
-  using bit_type = uint32_t;
-  using signed_bit_type = int64_t;
-  using bit_vector = std::deque<bit_type>;
+  using bit_type = uint64_t;
+  using double_bit_type = unsigned __int128;
+  using bit_vector = std::vector<bit_type>;
 
  public:
-  static int BASE; // = 2; // each bit is a unsigned 32-bit integer i.e. in the range [0, 2^32 - 1]
-  static uint64_t BIT_SIZE; // = static_cast<uint64_t>(1) << BASE; // 2 ^ BASE
-  bit_vector bits;
+  static constexpr int BASE = 64; // each bit is a full 64-bit limb i.e. in the range [0, 2^64 - 1]
+  // Multiplication switches from schoolbook to Karatsuba, and from Karatsuba to Toom-3, once the
+  // shorter operand has at least this many limbs. Tunable; see benchmarks/bench_big_int.
+  static int KARATSUBA_THRESHOLD; // = 48
+  static int TOOM3_THRESHOLD; // = 384
+  // Above this many limbs (and within NTT_MAX_LENGTH) multiplication uses the NTT in bignum/ntt.h
+  static int NTT_THRESHOLD; // = 4096
+  // Decimal conversion splits by powers of ten above this many limbs, and divides by those
+  // powers with a Newton reciprocal instead of long division once they reach BARRETT_THRESHOLD
+  static int RADIX_SPLIT_THRESHOLD; // = 24
+  static int BARRETT_THRESHOLD; // = 64
+  bit_vector bits; // least significant limb first
   bool isPositive = true;
 
 
@@ -50,13 +65,20 @@ class BigInt {
   BigInt &operator--();
   BigInt operator--(int);
 
-  BigInt operator*(const BigInt& other) const;
+  BigInt operator*(const BigInt& other) const; // squares when both operands are equal
   BigInt &operator*=(const BigInt& other);
+  BigInt square() const;
+  // *this += b * c and *this -= b * c. A single-limb factor accumulates straight into the limbs;
+  // otherwise the product goes through a reused per-thread buffer.
+  BigInt &addmul(const BigInt& b, const BigInt& c);
+  BigInt &submul(const BigInt& b, const BigInt& c);
   
   BigInt operator/(const BigInt& other) const;
   BigInt &operator/=(const BigInt& other);
   BigInt operator%(const BigInt& other) const;
   BigInt &operator%=(const BigInt& other);
+  // Truncated division: the quotient rounds toward zero and the remainder takes the dividend's sign
+  std::pair<BigInt, BigInt> divmod(const BigInt& other) const;
 
 
   // Special-case procedures
@@ -64,6 +86,10 @@ class BigInt {
   BigInt half() const;
   BigInt binaryScaleDown(int k) const;
   BigInt binaryScaleUp(int k) const;
+  // In-place binaryScaleUp/binaryScaleDown. Like them these shift the magnitude, so >>= rounds
+  // negative values toward zero.
+  BigInt &operator<<=(int k);
+  BigInt &operator>>=(int k);
   bool positive() const;
   bool negative() const;
   bool zero() const;
@@ -71,6 +97,7 @@ class BigInt {
   bool even() const;
   bool odd() const;
   static bit_type leastBits(bit_type num, int k);
+  int bitLength() const; // bits in the magnitude, 0 for zero
 
 
   // Comparison methods
@@ -79,31 +106,70 @@ class BigInt {
   std::strong_ordering operator<=>(const BigInt& other) const;
 
   // Output methods
-  long long toNum() const;
-  std::string toString() const;
+  long long toNum() const; // low 64 bits with the sign applied, wrapping like a cast to long long
+  std::string toString(int base = 10) const;
+  // Like std::to_chars: writes an optional '-' and the digits into [first, last) without
+  // building a string. base is 10 or a power of two up to 32; other bases give invalid_argument.
+  std::to_chars_result toChars(char* first, char* last, int base = 10) const;
+  // Like std::from_chars: parses an optional '-' and the longest run of base digits starting
+  // at first, assigning value only on success
+  static std::from_chars_result fromChars(const char* first, const char* last, BigInt& value, int base = 10);
   friend std::ostream &operator<<(std::ostream &out, const BigInt& num);
+  friend class MontgomeryContext; // builds results straight from its limb arrays
+  template <int Bits> friend class FixedInt; // converts to and from its fixed limb arrays
 
 
  private:
   void repairBits();
   static bool compareBitMagnitude(const bit_vector& a, const bit_vector& b);
+  static bool compareBitMagnitude(const bit_type* a, int n, const bit_type* b, int m);
+  // In-place arithmetic on bits. These only allocate when the result outgrows the capacity.
+  // b may alias bits; the result is not repaired.
+  void addMagnitude(const bit_type* b, int m); // |this| += b
+  void subtractMagnitude(const bit_type* b, int m); // |this| -= b, for |this| >= b
+  void subtractFromMagnitude(const bit_type* b, int m); // |this| = b - |this|, for b > |this|
+  void addSigned(const bit_type* b, int m, bool bNegative); // this += (bNegative ? -b : b)
+  BigInt &multiplyAccumulate(const BigInt& b, const BigInt& c, bool subtract);
   BigInt unsignedAddition(const bit_vector& a, const bit_vector& b) const;
   BigInt unsignedSubtraction(const bit_vector& a, const bit_vector& b) const;
   BigInt unsignedMultiplication(const bit_vector& a, const bit_vector& b) const;
+  // Multiplication tiers on raw limbs. out holds n + m zeroed limbs; a == b with n == m squares.
+  static void multiplyLimbs(const bit_type* a, int n, const bit_type* b, int m, bit_type* out);
+  static void schoolbookMultiply(const bit_type* a, int n, const bit_type* b, int m, bit_type* out);
+  static void schoolbookSquare(const bit_type* a, int n, bit_type* out);
+  static void karatsubaMultiply(const bit_type* a, int n, const bit_type* b, int m, bit_type* out);
+  static void toomCook3Multiply(const bit_type* a, int n, const bit_type* b, int m, bit_type* out);
+  // out[offset, outSize) += src[0, srcSize), propagating the carry up to outSize
+  static void addLimbs(bit_type* out, int outSize, int offset, const bit_type* src, int srcSize);
   std::pair<BigInt, BigInt> unsignedDivision(const bit_vector& a, const bit_vector& b) const;
+  // a = a * multiplier + addend, in place
+  static void multiplyAddSmall(bit_vector& a, bit_type multiplier, bit_type addend);
+  // a /= divisor in place, returning the remainder
+  static bit_type divideBySmall(bit_vector& a, bit_type divisor);
+  // Divide-and-conquer decimal conversion over cached powers 10^(19 * 2^k)
+  struct DecimalPowers;
+  static BigInt parseDecimal(const char* first, const char* last, DecimalPowers& powers);
+  // Writes |value| so it ends just before end, zero-padded to width digits; returns the first
+  // digit. value must be below powers[level + 1].
+  static char* writeDecimal(const BigInt& value, char* end, int width, int level, DecimalPowers& powers);
+  // floor(2^(2 * bits) / p) for p of the given bit length
+  static BigInt reciprocal(const BigInt& p, int bits);
 };
 
 
 template <std::integral Int>
 BigInt::BigInt(Int num) {
+  // negate in the unsigned type so the minimum value of a signed type doesn't overflow
+  using UnsignedInt = std::make_unsigned_t<Int>;
+  UnsignedInt magnitude = static_cast<UnsignedInt>(num);
   if (num < 0) {
-    num *= -1;
+    magnitude = UnsignedInt(0) - magnitude;
     isPositive = false;
   }
-  while (num != 0) {
-    bit_type firstBit = num % BIT_SIZE; // get least significant bit
-    bits.push_back(firstBit);
-    num /= BIT_SIZE;
+  if constexpr (sizeof(UnsignedInt) > sizeof(bit_type)) {
+    for (; magnitude != 0; magnitude >>= BASE) bits.push_back(static_cast<bit_type>(magnitude));
+  } else {
+    if (magnitude != 0) bits.push_back(magnitude);
   }
   repairBits(); // removes trailing 0's for proper representation
 }
@@ -0,0 +1,428 @@
+#pragma once
+
+#include "bignum/big_int.h"
+#include "bignum/operations.h"
+
+#include <array>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace BigNum {
+
+// Signed two's complement integer of exactly Bits bits, held in Bits / 64 limbs inside the
+// object, so no operation allocates. Arithmetic wraps modulo 2^Bits like the built-in integers
+// and division truncates toward zero. Every loop runs over the compile-time limb count, which
+// lets the compiler unroll them. FixedInt has the same special-case members as BigInt, so the
+// IntType helpers and the generic NumberTheory algorithms accept it.
+template <int Bits>
+class FixedInt {
+  static_assert(Bits >= 64 && Bits % 64 == 0, "FixedInt needs a positive multiple of 64 bits");
+
+ public:
+  using limb = uint64_t;
+  static constexpr int BASE = 64;
+  static constexpr int LIMBS = Bits / BASE;
+  using limb_array = std::array<limb, LIMBS>;
+
+  limb_array limbs{}; // least significant limb first
+
+  constexpr FixedInt() = default;
+  template <std::integral Int> constexpr FixedInt(Int num);
+  explicit FixedInt(const BigInt& num); // the low Bits bits of num, wrapping like a cast
+  explicit FixedInt(const std::string& str); // decimal digits with an optional leading '-'
+
+  // Operations
+  constexpr FixedInt operator+(const FixedInt& other) const { FixedInt result = *this; return result += other; }
+  constexpr FixedInt &operator+=(const FixedInt& other);
+  constexpr FixedInt &operator++() { return *this += FixedInt(1); }
+  constexpr FixedInt operator++(int) { FixedInt tmp = *this; ++*this; return tmp; }
+
+  constexpr FixedInt operator-() const;
+  constexpr FixedInt operator-(const FixedInt& other) const { FixedInt result = *this; return result -= other; }
+  constexpr FixedInt &operator-=(const FixedInt& other);
+  constexpr FixedInt &operator--() { return *this -= FixedInt(1); }
+  constexpr FixedInt operator--(int) { FixedInt tmp = *this; --*this; return tmp; }
+
+  constexpr FixedInt operator*(const FixedInt& other) const;
+  constexpr FixedInt &operator*=(const FixedInt& other) { return *this = *this * other; }
+
+  constexpr FixedInt operator/(const FixedInt& other) const { return divmod(other).first; }
+  constexpr FixedInt &operator/=(const FixedInt& other) { return *this = *this / other; }
+  constexpr FixedInt operator%(const FixedInt& other) const { return divmod(other).second; }
+  constexpr FixedInt &operator%=(const FixedInt& other) { return *this = *this % other; }
+  // Truncated division: the quotient rounds toward zero and the remainder takes the dividend's sign
+  constexpr std::pair<FixedInt, FixedInt> divmod(const FixedInt& other) const;
+
+  // Shifts like the built-in integers: >> is arithmetic, so it rounds toward negative infinity
+  constexpr FixedInt operator<<(int k) const { return binaryScaleUp(k); }
+  constexpr FixedInt operator>>(int k) const;
+
+  // Special-case procedures, with BigInt's semantics: binaryScaleDown shifts the magnitude
+  constexpr FixedInt twice() const { return binaryScaleUp(1); }
+  constexpr FixedInt half() const { return binaryScaleDown(1); }
+  constexpr FixedInt binaryScaleDown(int k) const;
+  constexpr FixedInt binaryScaleUp(int k) const;
+  constexpr bool positive() const { return !negative() && !zero(); }
+  constexpr bool negative() const { return (limbs[LIMBS-1] >> (BASE - 1)) != 0; }
+  constexpr bool zero() const;
+  constexpr bool one() const { return *this == FixedInt(1); }
+  constexpr bool even() const { return (limbs[0] & 1) == 0; }
+  constexpr bool odd() const { return (limbs[0] & 1) == 1; }
+
+  // Comparison methods
+  constexpr bool operator==(const FixedInt& other) const = default;
+  constexpr std::strong_ordering operator<=>(const FixedInt& other) const;
+
+  // Output methods
+  constexpr long long toNum() const { return static_cast<long long>(limbs[0]); } // low 64 bits
+  BigInt toBigInt() const;
+  std::string toString() const;
+  friend std::ostream &operator<<(std::ostream &out, const FixedInt& num) { return out << num.toString(); }
+
+ private:
+  using double_limb = unsigned __int128;
+  static constexpr limb DECIMAL_CHUNK = 10000000000000000000ull; // 10^19
+
+  // |this| as an unsigned limb array; the minimum value maps to 2^(Bits - 1)
+  constexpr limb_array magnitude() const { return negative()? (-*this).limbs: limbs; }
+  static constexpr int significantLimbs(const limb_array& a);
+  static constexpr bool lessMagnitude(const limb_array& a, const limb_array& b);
+  static constexpr void shiftLeft(limb_array& a, int k);
+  static constexpr void shiftRight(limb_array& a, int k, limb fill);
+  // a /= divisor, returning the remainder
+  static constexpr limb divideBySmall(limb_array& a, limb divisor);
+  // a = a * multiplier + addend, wrapping
+  static constexpr void multiplyAddSmall(limb_array& a, limb multiplier, limb addend);
+  static constexpr std::pair<limb_array, limb_array> divideMagnitudes(const limb_array& a, const limb_array& b);
+};
+
+// Common widths
+using Int128 = FixedInt<128>;
+using Int256 = FixedInt<256>;
+using Int512 = FixedInt<512>;
+using Int2048 = FixedInt<2048>;
+
+
+template <int Bits>
+template <std::integral Int>
+constexpr FixedInt<Bits>::FixedInt(Int num) {
+  // sign-extend through every limb
+  using UnsignedInt = std::make_unsigned_t<Int>;
+  UnsignedInt value = static_cast<UnsignedInt>(num);
+  limb fill = (num < 0)? ~limb(0): 0;
+  limbs.fill(fill);
+  if constexpr (sizeof(UnsignedInt) > sizeof(limb)) {
+    for (int i = 0; i < LIMBS && i * BASE < static_cast<int>(sizeof(UnsignedInt) * 8); ++i) {
+      limbs[i] = static_cast<limb>(value >> (i * BASE));
+    }
+  } else {
+    // converting to a limb sign-extends signed types and zero-extends unsigned ones
+    limbs[0] = static_cast<limb>(num);
+  }
+}
+
+template <int Bits>
+FixedInt<Bits>::FixedInt(const BigInt& num) {
+  for (int i = 0; i < LIMBS && i < static_cast<int>(num.bits.size()); ++i) limbs[i] = num.bits[i];
+  if (num.negative()) *this = -*this;
+}
+
+template <int Bits>
+FixedInt<Bits>::FixedInt(const std::string& str) {
+  std::size_t start = (!str.empty() && str[0] == '-')? 1: 0;
+  if (start == str.size()) throw std::out_of_range("String must be valid base ten number");
+  for (std::size_t i = start; i < str.size(); ++i) {
+    if (str[i] < '0' || str[i] > '9') throw std::out_of_range("String must be valid base ten number");
+  }
+  // 19 digits per multiply-add, the first chunk taking the leftover digits
+  std::size_t n = str.size() - start;
+  std::size_t chunkEnd = start + (n % 19? n % 19: 19);
+  for (std::size_t i = start; i < str.size(); i = chunkEnd, chunkEnd += 19) {
+    limb chunk = 0, scale = 1;
+    for (std::size_t j = i; j < chunkEnd; ++j) {
+      chunk = chunk * 10 + (str[j] - '0');
+      scale *= 10;
+    }
+    multiplyAddSmall(limbs, scale, chunk);
+  }
+  if (start == 1) *this = -*this;
+}
+
+
+// Operations
+
+template <int Bits>
+constexpr FixedInt<Bits> &FixedInt<Bits>::operator+=(const FixedInt& other) {
+  limb carry = 0;
+  for (int i = 0; i < LIMBS; ++i) {
+    double_limb sum = static_cast<double_limb>(limbs[i]) + other.limbs[i] + carry;
+    limbs[i] = static_cast<limb>(sum);
+    carry = static_cast<limb>(sum >> BASE);
+  }
+  return *this;
+}
+
+template <int Bits>
+constexpr FixedInt<Bits> &FixedInt<Bits>::operator-=(const FixedInt& other) {
+  limb borrow = 0;
+  for (int i = 0; i < LIMBS; ++i) {
+    limb second = other.limbs[i];
+    limb diff = limbs[i] - second - borrow;
+    borrow = (limbs[i] < second) || (limbs[i] - second < borrow);
+    limbs[i] = diff;
+  }
+  return *this;
+}
+
+template <int Bits>
+constexpr FixedInt<Bits> FixedInt<Bits>::operator-() const {
+  // two's complement: invert and add one
+  FixedInt result;
+  limb carry = 1;
+  for (int i = 0; i < LIMBS; ++i) {
+    result.limbs[i] = ~limbs[i] + carry;
+    carry = (carry != 0 && result.limbs[i] == 0);
+  }
+  return result;
+}
+
+template <int Bits>
+constexpr FixedInt<Bits> FixedInt<Bits>::operator*(const FixedInt& other) const {
+  // schoolbook, keeping only the partial products below 2^Bits; two's complement makes the
+  // truncated unsigned product the correctly signed result. Past a few limbs it pays to skip the
+  // zero high limbs of nonnegative operands, which is where most values sit.
+  FixedInt result;
+  int n = LIMBS, m = LIMBS;
+  if constexpr (LIMBS > 4) {
+    n = significantLimbs(limbs);
+    m = significantLimbs(other.limbs);
+  }
+  for (int i = 0; i < n; ++i) {
+    limb carry = 0;
+    for (int j = 0; j < m && i + j < LIMBS; ++j) {
+      double_limb t = static_cast<double_limb>(limbs[i]) * other.limbs[j] + result.limbs[i+j] + carry;
+      result.limbs[i+j] = static_cast<limb>(t);
+      carry = static_cast<limb>(t >> BASE);
+    }
+    if (i + m < LIMBS) result.limbs[i+m] = carry;
+  }
+  return result;
+}
+
+template <int Bits>
+constexpr std::pair<FixedInt<Bits>, FixedInt<Bits>> FixedInt<Bits>::divmod(const FixedInt& other) const {
+  if (other.zero()) throw std::runtime_error("Division By 0 in FixedInt");
+  auto [quotientMagnitude, remainderMagnitude] = divideMagnitudes(magnitude(), other.magnitude());
+  FixedInt quotient, remainder;
+  quotient.limbs = quotientMagnitude;
+  remainder.limbs = remainderMagnitude;
+  if (negative() != other.negative()) quotient = -quotient;
+  if (negative()) remainder = -remainder;
+  return {quotient, remainder};
+}
+
+template <int Bits>
+constexpr FixedInt<Bits> FixedInt<Bits>::operator>>(int k) const {
+  FixedInt result = *this;
+  shiftRight(result.limbs, k, negative()? ~limb(0): 0);
+  return result;
+}
+
+
+// Special Operations
+
+template <int Bits>
+constexpr FixedInt<Bits> FixedInt<Bits>::binaryScaleDown(int k) const {
+  FixedInt result;
+  result.limbs = magnitude();
+  shiftRight(result.limbs, k, 0);
+  return negative()? -result: result;
+}
+
+template <int Bits>
+constexpr FixedInt<Bits> FixedInt<Bits>::binaryScaleUp(int k) const {
+  FixedInt result = *this;
+  shiftLeft(result.limbs, k);
+  return result;
+}
+
+template <int Bits>
+constexpr bool FixedInt<Bits>::zero() const {
+  for (int i = 0; i < LIMBS; ++i) {
+    if (limbs[i] != 0) return false;
+  }
+  return true;
+}
+
+
+// Comparison methods
+
+template <int Bits>
+constexpr std::strong_ordering FixedInt<Bits>::operator<=>(const FixedInt& other) const {
+  if (negative() != other.negative()) return negative()? std::strong_ordering::less: std::strong_ordering::greater;
+  // with equal signs, two's complement limbs order like unsigned numbers
+  for (int i = LIMBS - 1; i >= 0; --i) {
+    if (limbs[i] != other.limbs[i]) return limbs[i] <=> other.limbs[i];
+  }
+  return std::strong_ordering::equal;
+}
+
+
+// Output methods
+
+template <int Bits>
+BigInt FixedInt<Bits>::toBigInt() const {
+  limb_array value = magnitude();
+  BigInt result(BigInt::bit_vector(value.begin(), value.end()));
+  return negative()? -result: result;
+}
+
+template <int Bits>
+std::string FixedInt<Bits>::toString() const {
+  // peel off 19 decimal digits per single-limb division
+  limb_array value = magnitude();
+  std::string result;
+  do {
+    limb chunk = divideBySmall(value, DECIMAL_CHUNK);
+    bool last = (significantLimbs(value) == 0);
+    for (int i = 0; i < 19 && (!last || chunk != 0 || i == 0); ++i, chunk /= 10) result.push_back('0' + chunk % 10);
+  } while (significantLimbs(value) != 0);
+  if (negative()) result.push_back('-');
+  return std::string(result.rbegin(), result.rend());
+}
+
+
+// Helpers
+
+template <int Bits>
+constexpr int FixedInt<Bits>::significantLimbs(const limb_array& a) {
+  int n = LIMBS;
+  while (n > 0 && a[n-1] == 0) --n;
+  return n;
+}
+
+template <int Bits>
+constexpr bool FixedInt<Bits>::lessMagnitude(const limb_array& a, const limb_array& b) {
+  for (int i = LIMBS - 1; i >= 0; --i) {
+    if (a[i] != b[i]) return a[i] < b[i];
+  }
+  return false;
+}
+
+template <int Bits>
+constexpr void FixedInt<Bits>::shiftLeft(limb_array& a, int k) {
+  int limbShift = k / BASE, bitShift = k % BASE;
+  for (int i = LIMBS - 1; i >= 0; --i) {
+    int j = i - limbShift;
+    limb high = (j >= 0)? a[j] << bitShift: 0;
+    limb low = (bitShift != 0 && j > 0)? a[j-1] >> (BASE - bitShift): 0;
+    a[i] = high | low;
+  }
+}
+
+template <int Bits>
+constexpr void FixedInt<Bits>::shiftRight(limb_array& a, int k, limb fill) {
+  int limbShift = k / BASE, bitShift = k % BASE;
+  for (int i = 0; i < LIMBS; ++i) {
+    int j = i + limbShift;
+    limb low = (j < LIMBS)? a[j] >> bitShift: fill >> bitShift;
+    limb next = (j + 1 < LIMBS)? a[j+1]: fill;
+    limb high = (bitShift != 0)? next << (BASE - bitShift): 0;
+    a[i] = low | high;
+  }
+}
+
+template <int Bits>
+constexpr typename FixedInt<Bits>::limb FixedInt<Bits>::divideBySmall(limb_array& a, limb divisor) {
+  double_limb remainder = 0;
+  for (int i = LIMBS - 1; i >= 0; --i) {
+    double_limb current = (remainder << BASE) | a[i];
+    a[i] = static_cast<limb>(current / divisor);
+    remainder = current % divisor;
+  }
+  return static_cast<limb>(remainder);
+}
+
+template <int Bits>
+constexpr void FixedInt<Bits>::multiplyAddSmall(limb_array& a, limb multiplier, limb addend) {
+  limb carry = addend;
+  for (int i = 0; i < LIMBS; ++i) {
+    double_limb t = static_cast<double_limb>(a[i]) * multiplier + carry;
+    a[i] = static_cast<limb>(t);
+    carry = static_cast<limb>(t >> BASE);
+  }
+}
+
+template <int Bits>
+constexpr std::pair<typename FixedInt<Bits>::limb_array, typename FixedInt<Bits>::limb_array>
+FixedInt<Bits>::divideMagnitudes(const limb_array& a, const limb_array& b) {
+  limb_array quotient{}, remainder{};
+  if (lessMagnitude(a, b)) return {quotient, a};
+  int n = significantLimbs(b);
+  if (n == 1) {
+    quotient = a;
+    remainder[0] = divideBySmall(quotient, b[0]);
+    return {quotient, remainder};
+  }
+
+  // Knuth's TAOCP Volume 2, Algorithm 4.3.1D, as in BigInt::unsignedDivision but on fixed arrays
+  int m = significantLimbs(a) - n;
+  int shift = std::countl_zero(b[n-1]);
+  limb_array v{};
+  std::array<limb, LIMBS + 1> u{};
+  for (int i = n - 1; i > 0; --i) v[i] = (b[i] << shift) | (shift? b[i-1] >> (BASE - shift): 0);
+  v[0] = b[0] << shift;
+  u[m+n] = shift? a[m+n-1] >> (BASE - shift): 0;
+  for (int i = m + n - 1; i > 0; --i) u[i] = (a[i] << shift) | (shift? a[i-1] >> (BASE - shift): 0);
+  u[0] = a[0] << shift;
+
+  for (int j = m; j >= 0; --j) {
+    double_limb numerator = (static_cast<double_limb>(u[j+n]) << BASE) | u[j+n-1];
+    double_limb qhat = numerator / v[n-1];
+    double_limb rhat = numerator % v[n-1];
+    while ((qhat >> BASE) != 0 || qhat * v[n-2] > ((rhat << BASE) | u[j+n-2])) {
+      --qhat;
+      rhat += v[n-1];
+      if ((rhat >> BASE) != 0) break;
+    }
+
+    limb carry = 0, borrow = 0;
+    for (int i = 0; i < n; ++i) {
+      double_limb product = static_cast<double_limb>(static_cast<limb>(qhat)) * v[i] + carry;
+      carry = static_cast<limb>(product >> BASE);
+      limb low = static_cast<limb>(product);
+      limb diff = u[i+j] - low;
+      limb nextBorrow = (u[i+j] < low);
+      nextBorrow += (diff < borrow);
+      u[i+j] = diff - borrow;
+      borrow = nextBorrow;
+    }
+    double_limb owed = static_cast<double_limb>(carry) + borrow;
+    bool negative = u[j+n] < owed;
+    u[j+n] -= static_cast<limb>(owed);
+
+    if (negative) {
+      --qhat;
+      limb addCarry = 0;
+      for (int i = 0; i < n; ++i) {
+        double_limb sum = static_cast<double_limb>(u[i+j]) + v[i] + addCarry;
+        u[i+j] = static_cast<limb>(sum);
+        addCarry = static_cast<limb>(sum >> BASE);
+      }
+      u[j+n] += addCarry;
+    }
+    quotient[j] = static_cast<limb>(qhat);
+  }
+
+  for (int i = 0; i < n; ++i) remainder[i] = (u[i] >> shift) | (shift? u[i+1] << (BASE - shift): 0);
+  return {quotient, remainder};
+}
+
+} // end namespace BigNum
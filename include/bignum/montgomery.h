@@ -0,0 +1,118 @@
+#pragma once
+
+#include "bignum/big_int.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace BigNum {
+
+// Modular arithmetic for a fixed odd modulus n > 1 in Montgomery form, where a residue a is
+// stored as a * R mod n with R = 2^(64 * size()). Residues are fixed-width arrays of size()
+// limbs, least significant first. mulmod, sqrmod and powmod work on caller-provided arrays and a
+// per-thread workspace, so they do not allocate once that workspace has grown. A context is
+// immutable after construction and may be shared between threads.
+class MontgomeryContext {
+ public:
+  using limb = uint64_t;
+  using Residue = std::vector<limb>; // exactly size() limbs
+
+  // Throws std::invalid_argument unless modulus is odd and greater than 1
+  explicit MontgomeryContext(const BigInt& modulus);
+
+  int size() const { return n; }
+  const BigInt& modulus() const { return modulusValue; }
+
+  // a mod n in Montgomery form; a may be negative or at least n
+  Residue toMontgomery(const BigInt& a) const;
+  BigInt fromMontgomery(const limb* a) const;
+  BigInt fromMontgomery(const Residue& a) const { return fromMontgomery(a.data()); }
+  // 1 in Montgomery form, i.e. R mod n
+  const Residue& one() const { return rModN; }
+
+  // out = a * b / R mod n by coarsely integrated operand scanning (CIOS). out may alias a or b.
+  void mulmod(const limb* a, const limb* b, limb* out) const;
+  // out = a * a / R mod n, sharing the cross products of the square. out may alias a.
+  void sqrmod(const limb* a, limb* out) const;
+  // out = a + b, a - b and a / 2 mod n, for a, b in [0, n). Montgomery form is linear, so these
+  // apply to residues unchanged. out may alias a or b.
+  void addmod(const limb* a, const limb* b, limb* out) const;
+  void submod(const limb* a, const limb* b, limb* out) const;
+  void halve(const limb* a, limb* out) const;
+  // out = base^exponent in Montgomery form by sliding-window exponentiation, for exponent >= 0.
+  // The window table is the only allocation, once per call.
+  void powmod(const limb* base, const BigInt& exponent, limb* out) const;
+
+  // Conveniences that convert in and out of Montgomery form; results are in [0, n)
+  BigInt mulmod(const BigInt& a, const BigInt& b) const;
+  BigInt powmod(const BigInt& base, const BigInt& exponent) const;
+
+  // Window width used by powmod for an exponent of the given bit length
+  static int windowBits(int exponentBits);
+
+ private:
+  int n; // limbs in the modulus
+  BigInt modulusValue;
+  Residue modulusLimbs;
+  limb inverse; // -n^-1 mod 2^64
+  Residue rModN;
+  Residue r2ModN; // R^2 mod n, for converting into Montgomery form
+
+  // out = t / R mod n for t < n * R held in 2n + 1 limbs, which it clobbers
+  void reduce(limb* t, limb* out) const;
+  // out = t - n when t (n limbs plus a carry limb) is at least n, else t
+  void finalSubtract(const limb* t, limb carry, limb* out) const;
+};
+
+
+// Montgomery arithmetic for an odd single-limb modulus n > 1 with R = 2^64. Residues are plain
+// uint64_t values in [0, n), so everything stays in registers; only toMontgomery divides.
+class Montgomery64 {
+ public:
+  using limb = uint64_t;
+
+  // Throws std::invalid_argument unless modulus is odd and greater than 1
+  constexpr explicit Montgomery64(limb modulus) : n{modulus} {
+    if (modulus % 2 == 0 || modulus == 1) throw std::invalid_argument("Montgomery modulus must be odd and greater than 1");
+    // Newton's iteration for n^-1 mod 2^64, as in MontgomeryContext
+    limb x = n;
+    for (int i = 0; i < 5; ++i) x *= 2 - n * x;
+    inverse = limb(0) - x;
+    rModN = (limb(0) - n) % n; // 2^64 mod n
+  }
+
+  constexpr limb modulus() const { return n; }
+  constexpr limb toMontgomery(limb a) const { return static_cast<limb>((static_cast<wide>(a % n) << 64) % n); }
+  constexpr limb fromMontgomery(limb a) const { return reduce(a); }
+  constexpr limb one() const { return rModN; }
+
+  constexpr limb mulmod(limb a, limb b) const { return reduce(static_cast<wide>(a) * b); }
+  constexpr limb addmod(limb a, limb b) const { return (a >= n - b)? a - (n - b): a + b; }
+  constexpr limb submod(limb a, limb b) const { return (a >= b)? a - b: a + (n - b); }
+  // base^exponent with base and result in Montgomery form
+  constexpr limb powmod(limb base, limb exponent) const {
+    limb result = rModN;
+    for (; exponent != 0; exponent >>= 1) {
+      if (exponent & 1) result = mulmod(result, base);
+      base = mulmod(base, base);
+    }
+    return result;
+  }
+
+ private:
+  using wide = unsigned __int128;
+  limb n;
+  limb inverse = 0; // -n^-1 mod 2^64
+  limb rModN = 0;
+
+  // t / 2^64 mod n for t < n * 2^64
+  constexpr limb reduce(wide t) const {
+    limb q = static_cast<limb>(t) * inverse;
+    // t + q n clears the low limb, which carries out exactly when it was nonzero
+    wide high = (t >> 64) + ((static_cast<wide>(q) * n) >> 64) + (static_cast<limb>(t) != 0);
+    return static_cast<limb>(high >= n? high - n: high);
+  }
+};
+
+} // end namespace BigNum
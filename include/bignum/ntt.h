@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace BigNum {
+
+// Exact multiplication of limb arrays by number-theoretic transforms. The operands are split
+// into 32-bit digits and convolved modulo three NTT-friendly primes; Garner's algorithm
+// reconstructs each coefficient (< 2^89) from its three residues, so no floating point is used.
+
+// Largest transform length supported by all three primes
+constexpr int NTT_MAX_LENGTH = 1 << 25;
+
+// True when an n by m limb product fits in one transform
+bool nttSupports(int n, int m);
+
+// out[0, n + m) = a[0, n) * b[0, m). Squares with one transform when a == b.
+void nttMultiply(const uint64_t* a, int n, const uint64_t* b, int m, uint64_t* out);
+
+} // end namespace BigNum
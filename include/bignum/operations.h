@@ -27,22 +27,22 @@ bool odd(Int n);
 
 template <std::integral Int>
 Int half(Int n) {
-  return n << 1;
+  return n >> 1;
 }
 
 template <std::integral Int>
 Int twice(Int n) {
-  return n >> 1;
+  return n << 1;
 }
 
 template <std::integral Int>
 Int binary_scale_up(Int n, int k) {
-  return n >> k;
+  return n << k;
 }
 
 template <std::integral Int>
 Int binary_scale_down(Int n, int k) {
-  return n << k;
+  return n >> k;
 }
 
 template <std::integral Int>
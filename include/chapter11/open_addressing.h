@@ -0,0 +1,595 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Chapter11 {
+
+// Open addressing in the Swiss table layout. Every slot has a control byte: empty, deleted, or for
+// a full slot the low 7 bits of its key's hash (H2). The rest of the hash (H1) picks where probing
+// starts, and probing moves by groups of control bytes, comparing a whole group against H2 at
+// once, so keys are only compared on a 1-in-128 false match. The byte after the last slot is a
+// sentinel that stops iteration, and the first GROUP_WIDTH - 1 bytes are cloned after it, so a
+// group can be loaded starting at any slot.
+using ControlByte = int8_t;
+constexpr ControlByte CTRL_EMPTY = -128;
+constexpr ControlByte CTRL_DELETED = -2;
+constexpr ControlByte CTRL_SENTINEL = -1;
+
+// The control bytes of every table that has not allocated: a sentinel followed by empty bytes, so
+// that lookups in it need no special case. Never written.
+extern const ControlByte EMPTY_GROUP[16];
+
+// The positions of the matching bytes in a group, lowest first, as one bit per byte (SSE2) or the
+// top bit of each byte (portable)
+template <int Shift, int Width>
+class BitMask {
+  uint64_t mask;
+ public:
+  explicit BitMask(uint64_t mask) : mask{mask} {}
+  explicit operator bool() const { return mask != 0; }
+  int lowest() const { return std::countr_zero(mask) >> Shift; }
+  void clearLowest() { mask &= mask - 1; }
+  // bytes before the first match and after the last one
+  int trailingZeros() const { return lowest(); }
+  int leadingZeros() const { return (std::countl_zero(mask) - (64 - (Width << Shift))) >> Shift; }
+};
+
+// Eight control bytes in a word, matched with bit tricks. match may report a full byte right after
+// a true match as a false positive, which the key comparison then rejects.
+class GroupPortable {
+  static constexpr uint64_t LSBS = 0x0101010101010101ull;
+  static constexpr uint64_t MSBS = 0x8080808080808080ull;
+  uint64_t ctrl = 0;
+ public:
+  static constexpr int WIDTH = 8;
+  using Mask = BitMask<3, WIDTH>;
+
+  explicit GroupPortable(const ControlByte *position) {
+    for (int i = 0; i < WIDTH; ++i) ctrl |= static_cast<uint64_t>(static_cast<uint8_t>(position[i])) << (8 * i);
+  }
+  Mask match(ControlByte h2) const {
+    uint64_t x = ctrl ^ (LSBS * static_cast<uint8_t>(h2));
+    return Mask((x - LSBS) & ~x & MSBS);
+  }
+  // empty is the only value with the top bit set and bit 1 clear
+  Mask matchEmpty() const { return Mask(ctrl & ~(ctrl << 6) & MSBS); }
+  // and empty or deleted the only ones with the top bit set and bit 0 clear
+  Mask matchEmptyOrDeleted() const { return Mask(ctrl & ~(ctrl << 7) & MSBS); }
+  int countLeadingEmptyOrDeleted() const {
+    return std::countr_zero(~(ctrl & ~(ctrl << 7)) & MSBS) >> 3;
+  }
+};
+
+#ifdef __SSE2__
+// Sixteen control bytes in a vector register: one compare and one movemask per query
+class GroupSse2 {
+  __m128i ctrl;
+  uint64_t maskOf(__m128i matches) const { return static_cast<uint16_t>(_mm_movemask_epi8(matches)); }
+ public:
+  static constexpr int WIDTH = 16;
+  using Mask = BitMask<0, WIDTH>;
+
+  explicit GroupSse2(const ControlByte *position) : ctrl{_mm_loadu_si128(reinterpret_cast<const __m128i *>(position))} {}
+  Mask match(ControlByte h2) const { return Mask(maskOf(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))); }
+  Mask matchEmpty() const { return Mask(maskOf(_mm_cmpeq_epi8(_mm_set1_epi8(CTRL_EMPTY), ctrl))); }
+  // empty and deleted are the control bytes below the sentinel
+  Mask matchEmptyOrDeleted() const { return Mask(maskOf(_mm_cmpgt_epi8(_mm_set1_epi8(CTRL_SENTINEL), ctrl))); }
+  int countLeadingEmptyOrDeleted() const {
+    return std::countr_one(static_cast<uint32_t>(maskOf(_mm_cmpgt_epi8(_mm_set1_epi8(CTRL_SENTINEL), ctrl))));
+  }
+};
+
+using ControlGroup = GroupSse2;
+#else
+using ControlGroup = GroupPortable;
+#endif
+
+// Triangular probing over groups: h, h + W, h + 3W, h + 6W, ... modulo a power of two at least W,
+// which reaches every group before repeating
+template <int Width>
+class ProbeSequence {
+  std::size_t mask, position, stride = 0;
+ public:
+  ProbeSequence(std::size_t hash, std::size_t mask) : mask{mask}, position{hash & mask} {}
+  std::size_t offset() const { return position; }
+  std::size_t offset(int i) const { return (position + i) & mask; }
+  void next() {
+    stride += Width;
+    position = (position + stride) & mask;
+  }
+};
+
+// Lookups by any type the hasher and key comparison both accept, like std::unordered_map in C++20
+template <typename Hash, typename KeyEqual>
+concept TransparentLookup = requires {
+  typename Hash::is_transparent;
+  typename KeyEqual::is_transparent;
+};
+
+// A hash map with the interface of std::unordered_map, storing its elements in one flat array of
+// slots instead of a node per element. Capacities are 2^k - 1 and at most 7/8 of the slots are
+// ever full or deleted. Erasing leaves a slot empty rather than deleted when no probe sequence
+// can have passed over it, which is the common case below the maximum load.
+//
+// Unlike std::unordered_map, rehashing moves elements, so it invalidates references as well as
+// iterators. The key is const in value_type, so a rehash copies keys and moves mapped values;
+// reserve up front to avoid rehashing long string keys.
+template <typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+
+  static constexpr int GROUP_WIDTH = ControlGroup::WIDTH;
+  // the smallest allocated table, so that a group never reads past the cloned bytes
+  static constexpr size_type MIN_CAPACITY = 15;
+
+ private:
+  template <bool Const>
+  class Iterator {
+    friend class FlatHashMap;
+    template <bool> friend class Iterator;
+    ControlByte *ctrl = nullptr;
+    FlatHashMap::value_type *slot = nullptr;
+
+    Iterator(ControlByte *ctrl, FlatHashMap::value_type *slot) : ctrl{ctrl}, slot{slot} {}
+    void skipEmptyOrDeleted() {
+      while (*ctrl < CTRL_SENTINEL) {
+        int shift = ControlGroup(ctrl).countLeadingEmptyOrDeleted();
+        ctrl += shift;
+        slot += shift;
+      }
+    }
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = FlatHashMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+    using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+    Iterator() = default;
+    // a template, so that it does not replace the copy constructor of iterator itself
+    template <bool WasConst = Const> requires WasConst
+    Iterator(const Iterator<false> &other) : ctrl{other.ctrl}, slot{other.slot} {}
+    reference operator*() const { return *slot; }
+    pointer operator->() const { return slot; }
+    Iterator &operator++() {
+      ++ctrl;
+      ++slot;
+      skipEmptyOrDeleted();
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+    friend bool operator==(const Iterator &a, const Iterator &b) { return a.ctrl == b.ctrl; }
+  };
+
+ public:
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  // Constructors and Destructors
+  FlatHashMap() {}
+  explicit FlatHashMap(size_type bucketCount, const Hash &hashFunction = Hash(), const KeyEqual &keyEqual = KeyEqual())
+      : hash{hashFunction}, equal{keyEqual} {
+    if (bucketCount > 0) resize(normalizeCapacity(bucketCount));
+  }
+  template <std::input_iterator InputIt>
+  FlatHashMap(InputIt first, InputIt last, size_type bucketCount = 0, const Hash &hashFunction = Hash(),
+              const KeyEqual &keyEqual = KeyEqual())
+      : FlatHashMap(bucketCount, hashFunction, keyEqual) {
+    insert(first, last);
+  }
+  FlatHashMap(std::initializer_list<value_type> il, size_type bucketCount = 0, const Hash &hashFunction = Hash(),
+              const KeyEqual &keyEqual = KeyEqual())
+      : FlatHashMap(il.begin(), il.end(), bucketCount, hashFunction, keyEqual) {}
+  FlatHashMap(const FlatHashMap &other) : FlatHashMap(0, other.hash, other.equal) {
+    reserve(other.size());
+    for (const auto &value : other) insert(value);
+  }
+  FlatHashMap(FlatHashMap &&other) noexcept
+      : ctrl{std::exchange(other.ctrl, emptyGroup())}, slots{std::exchange(other.slots, nullptr)},
+        capacity{std::exchange(other.capacity, 0)}, items{std::exchange(other.items, 0)},
+        growthLeft{std::exchange(other.growthLeft, 0)}, hash{other.hash}, equal{other.equal} {}
+  FlatHashMap &operator=(FlatHashMap other) noexcept {
+    swap(other);
+    return *this;
+  }
+  ~FlatHashMap() { release(); }
+
+  // Iterators
+  iterator begin() {
+    iterator it(ctrl, slots);
+    it.skipEmptyOrDeleted();
+    return it;
+  }
+  const_iterator begin() const {
+    const_iterator it(ctrl, slots);
+    it.skipEmptyOrDeleted();
+    return it;
+  }
+  iterator end() { return iterator(ctrl + capacity, slots + capacity); }
+  const_iterator end() const { return const_iterator(ctrl + capacity, slots + capacity); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  // Capacity
+  bool empty() const { return items == 0; }
+  size_type size() const { return items; }
+  size_type max_size() const { return std::numeric_limits<difference_type>::max() / sizeof(value_type); }
+
+  // Modifiers
+  void clear();
+  std::pair<iterator, bool> insert(const value_type &value) { return try_emplace(value.first, value.second); }
+  std::pair<iterator, bool> insert(value_type &&value) { return try_emplace(value.first, std::move(value.second)); }
+  template <typename P>
+    requires (!std::same_as<std::remove_cvref_t<P>, value_type> && std::constructible_from<value_type, P &&>)
+  std::pair<iterator, bool> insert(P &&value) {
+    return emplace(std::forward<P>(value));
+  }
+  template <std::input_iterator InputIt>
+  void insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) insert(*first);
+  }
+  void insert(std::initializer_list<value_type> il) { insert(il.begin(), il.end()); }
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const key_type &key, M &&obj) { return insertOrAssign(key, std::forward<M>(obj)); }
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(key_type &&key, M &&obj) { return insertOrAssign(std::move(key), std::forward<M>(obj)); }
+  // The key is only known once the element is constructed, so this builds it before the lookup,
+  // as std::unordered_map does; try_emplace does not.
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    value_type value(std::forward<Args>(args)...);
+    return try_emplace(value.first, std::move(value.second));
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const key_type &key, Args &&...args) { return tryEmplace(key, std::forward<Args>(args)...); }
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(key_type &&key, Args &&...args) { return tryEmplace(std::move(key), std::forward<Args>(args)...); }
+  // Erasing never moves other elements, so iterators to them stay valid
+  iterator erase(iterator position) { return erase(const_iterator(position)); }
+  iterator erase(const_iterator position) {
+    iterator next(position.ctrl, position.slot);
+    ++next;
+    eraseAt(position.slot - slots);
+    return next;
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last) first = erase(first);
+    return iterator(last.ctrl, last.slot);
+  }
+  size_type erase(const key_type &key) {
+    size_type index = findIndex(key, hashOf(key));
+    if (index == NOT_FOUND) return 0;
+    eraseAt(index);
+    return 1;
+  }
+  void swap(FlatHashMap &other) noexcept {
+    using std::swap;
+    swap(ctrl, other.ctrl);
+    swap(slots, other.slots);
+    swap(capacity, other.capacity);
+    swap(items, other.items);
+    swap(growthLeft, other.growthLeft);
+    swap(hash, other.hash);
+    swap(equal, other.equal);
+  }
+
+  // Lookup
+  T &at(const key_type &key) { return const_cast<T &>(std::as_const(*this).at(key)); }
+  const T &at(const key_type &key) const {
+    size_type index = findIndex(key, hashOf(key));
+    if (index == NOT_FOUND) throw std::out_of_range("FlatHashMap::at: key not found");
+    return slots[index].second;
+  }
+  T &operator[](const key_type &key) { return try_emplace(key).first->second; }
+  T &operator[](key_type &&key) { return try_emplace(std::move(key)).first->second; }
+  iterator find(const key_type &key) { return iteratorAt(findIndex(key, hashOf(key))); }
+  const_iterator find(const key_type &key) const { return iteratorAt(findIndex(key, hashOf(key))); }
+  template <typename K> requires TransparentLookup<Hash, KeyEqual>
+  iterator find(const K &key) { return iteratorAt(findIndex(key, hashOf(key))); }
+  template <typename K> requires TransparentLookup<Hash, KeyEqual>
+  const_iterator find(const K &key) const { return iteratorAt(findIndex(key, hashOf(key))); }
+  bool contains(const key_type &key) const { return findIndex(key, hashOf(key)) != NOT_FOUND; }
+  template <typename K> requires TransparentLookup<Hash, KeyEqual>
+  bool contains(const K &key) const { return findIndex(key, hashOf(key)) != NOT_FOUND; }
+  size_type count(const key_type &key) const { return contains(key); }
+  template <typename K> requires TransparentLookup<Hash, KeyEqual>
+  size_type count(const K &key) const { return contains(key); }
+  std::pair<iterator, iterator> equal_range(const key_type &key) {
+    iterator it = find(key);
+    return {it, it == end() ? it : std::next(it)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const {
+    const_iterator it = find(key);
+    return {it, it == end() ? it : std::next(it)};
+  }
+
+  // Bucket interface: a bucket is a slot
+  size_type bucket_count() const { return capacity; }
+  float load_factor() const { return capacity == 0 ? 0.0f : static_cast<float>(items) / capacity; }
+  float max_load_factor() const { return 7.0f / 8; }
+  void max_load_factor(float) {} // fixed by the probing scheme
+  // Rebuilds the table with at least count slots and room for the current elements, dropping every
+  // deleted slot. rehash(0) on an empty map frees its memory.
+  void rehash(size_type count);
+  void reserve(size_type count) { rehash(growthToLowerboundCapacity(count)); }
+
+  // Observers
+  hasher hash_function() const { return hash; }
+  key_equal key_eq() const { return equal; }
+
+  friend bool operator==(const FlatHashMap &a, const FlatHashMap &b) {
+    if (a.size() != b.size()) return false;
+    for (const auto &[key, value] : a) {
+      auto it = b.find(key);
+      if (it == b.end() || !(it->second == value)) return false;
+    }
+    return true;
+  }
+
+ private:
+  static constexpr size_type NOT_FOUND = std::numeric_limits<size_type>::max();
+
+  ControlByte *ctrl = emptyGroup();
+  value_type *slots = nullptr;
+  size_type capacity = 0;
+  size_type items = 0;
+  size_type growthLeft = 0; // insertions into empty slots before the next rehash
+  [[no_unique_address]] hasher hash;
+  [[no_unique_address]] key_equal equal;
+
+  static ControlByte *emptyGroup() { return const_cast<ControlByte *>(EMPTY_GROUP); }
+  static bool isFull(ControlByte c) { return c >= 0; }
+  static size_type normalizeCapacity(size_type n) { return n <= MIN_CAPACITY ? MIN_CAPACITY : std::bit_ceil(n + 1) - 1; }
+  static size_type capacityToGrowth(size_type n) { return n - n / 8; }
+  // the smallest capacity whose growth is at least the given count
+  static size_type growthToLowerboundCapacity(size_type n) { return n == 0 ? 0 : n + (n - 1) / 7; }
+
+  // std::hash is the identity on integers in common implementations, so the hash is mixed by a
+  // multiplication before its bits are split into H1 and H2
+  template <typename K>
+  std::size_t hashOf(const K &key) const {
+    unsigned __int128 product = static_cast<unsigned __int128>(hash(key)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(product) ^ static_cast<std::size_t>(product >> 64);
+  }
+  static std::size_t h1(std::size_t h) { return h >> 7; }
+  static ControlByte h2(std::size_t h) { return static_cast<ControlByte>(h & 0x7F); }
+
+  iterator iteratorAt(size_type index) { return index == NOT_FOUND ? end() : iterator(ctrl + index, slots + index); }
+  const_iterator iteratorAt(size_type index) const {
+    return index == NOT_FOUND ? end() : const_iterator(ctrl + index, slots + index);
+  }
+
+  // Writes a control byte and its clone past the sentinel, if it has one
+  void setCtrl(size_type index, ControlByte c) {
+    ctrl[index] = c;
+    ctrl[((index - (GROUP_WIDTH - 1)) & capacity) + (GROUP_WIDTH - 1)] = c;
+  }
+
+  template <typename K>
+  size_type findIndex(const K &key, std::size_t h) const;
+  size_type findFirstNonFull(std::size_t h) const;
+  size_type prepareInsert(std::size_t h);
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> tryEmplace(K &&key, Args &&...args);
+  template <typename K, typename M>
+  std::pair<iterator, bool> insertOrAssign(K &&key, M &&obj);
+  void eraseAt(size_type index);
+  void resize(size_type newCapacity);
+  void destroySlots();
+  void release();
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K>
+typename FlatHashMap<Key, T, Hash, KeyEqual>::size_type
+FlatHashMap<Key, T, Hash, KeyEqual>::findIndex(const K &key, std::size_t h) const {
+  ProbeSequence<GROUP_WIDTH> probe(h1(h), capacity);
+  for (;;) {
+    ControlGroup group(ctrl + probe.offset());
+    for (auto match = group.match(h2(h)); match; match.clearLowest()) {
+      size_type index = probe.offset(match.lowest());
+      if (equal(slots[index].first, key)) return index;
+    }
+    // an insertion would have stopped at this empty slot, so the key is nowhere further on
+    if (group.matchEmpty()) return NOT_FOUND;
+    probe.next();
+  }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename FlatHashMap<Key, T, Hash, KeyEqual>::size_type
+FlatHashMap<Key, T, Hash, KeyEqual>::findFirstNonFull(std::size_t h) const {
+  ProbeSequence<GROUP_WIDTH> probe(h1(h), capacity);
+  for (;;) {
+    auto mask = ControlGroup(ctrl + probe.offset()).matchEmptyOrDeleted();
+    if (mask) return probe.offset(mask.lowest());
+    probe.next();
+  }
+}
+
+// The slot for a new element with hash h. Reusing a deleted slot costs no growth; otherwise a
+// table out of growth is rebuilt first, at the same capacity if deleted slots are what filled it.
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename FlatHashMap<Key, T, Hash, KeyEqual>::size_type
+FlatHashMap<Key, T, Hash, KeyEqual>::prepareInsert(std::size_t h) {
+  size_type index = findFirstNonFull(h);
+  if (growthLeft == 0 && ctrl[index] != CTRL_DELETED) {
+    if (capacity == 0) {
+      resize(MIN_CAPACITY);
+    } else if (items * 32 <= capacity * 25) {
+      resize(capacity);
+    } else {
+      resize(capacity * 2 + 1);
+    }
+    index = findFirstNonFull(h);
+  }
+  return index;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K, typename... Args>
+std::pair<typename FlatHashMap<Key, T, Hash, KeyEqual>::iterator, bool>
+FlatHashMap<Key, T, Hash, KeyEqual>::tryEmplace(K &&key, Args &&...args) {
+  std::size_t h = hashOf(key);
+  size_type index = findIndex(key, h);
+  if (index != NOT_FOUND) return {iteratorAt(index), false};
+  index = prepareInsert(h);
+  // nothing is recorded until the element exists, so a throwing constructor leaves no trace
+  std::construct_at(slots + index, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+  growthLeft -= ctrl[index] == CTRL_EMPTY;
+  setCtrl(index, h2(h));
+  ++items;
+  return {iteratorAt(index), true};
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K, typename M>
+std::pair<typename FlatHashMap<Key, T, Hash, KeyEqual>::iterator, bool>
+FlatHashMap<Key, T, Hash, KeyEqual>::insertOrAssign(K &&key, M &&obj) {
+  // try_emplace leaves obj alone when the key is already present
+  auto result = tryEmplace(std::forward<K>(key), std::forward<M>(obj));
+  if (!result.second) result.first->second = std::forward<M>(obj);
+  return result;
+}
+
+// A probe for some other key passes over this slot only if it lies in a run of at least
+// GROUP_WIDTH slots with no empty one; otherwise the slot can go straight back to empty.
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void FlatHashMap<Key, T, Hash, KeyEqual>::eraseAt(size_type index) {
+  std::destroy_at(slots + index);
+  --items;
+  auto emptyBefore = ControlGroup(ctrl + ((index - GROUP_WIDTH) & capacity)).matchEmpty();
+  auto emptyAfter = ControlGroup(ctrl + index).matchEmpty();
+  bool neverPassed = emptyBefore && emptyAfter &&
+                     emptyAfter.trailingZeros() + emptyBefore.leadingZeros() < GROUP_WIDTH;
+  setCtrl(index, neverPassed ? CTRL_EMPTY : CTRL_DELETED);
+  growthLeft += neverPassed;
+}
+
+// If copying a key throws partway through, the elements not yet moved are destroyed and the map
+// keeps the rest
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void FlatHashMap<Key, T, Hash, KeyEqual>::resize(size_type newCapacity) {
+  ControlByte *oldCtrl = ctrl;
+  value_type *oldSlots = slots;
+  size_type oldCapacity = capacity;
+
+  std::allocator<value_type> allocator;
+  value_type *newSlots = allocator.allocate(newCapacity);
+  try {
+    ctrl = new ControlByte[newCapacity + GROUP_WIDTH];
+  } catch (...) {
+    allocator.deallocate(newSlots, newCapacity);
+    throw;
+  }
+  std::fill_n(ctrl, newCapacity + GROUP_WIDTH, CTRL_EMPTY);
+  ctrl[newCapacity] = CTRL_SENTINEL;
+  slots = newSlots;
+  capacity = newCapacity;
+
+  size_type moved = 0;
+  size_type i = 0;
+  auto finish = [&] {
+    items = moved;
+    growthLeft = capacityToGrowth(capacity) - items;
+    if (oldCapacity > 0) {
+      delete[] oldCtrl;
+      allocator.deallocate(oldSlots, oldCapacity);
+    }
+  };
+  try {
+    for (; i < oldCapacity; ++i) {
+      if (!isFull(oldCtrl[i])) continue;
+      std::size_t h = hashOf(oldSlots[i].first);
+      size_type index = findFirstNonFull(h);
+      std::construct_at(slots + index, std::move(oldSlots[i]));
+      setCtrl(index, h2(h));
+      ++moved;
+      std::destroy_at(oldSlots + i);
+    }
+  } catch (...) {
+    for (; i < oldCapacity; ++i) {
+      if (isFull(oldCtrl[i])) std::destroy_at(oldSlots + i);
+    }
+    finish();
+    throw;
+  }
+  finish();
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void FlatHashMap<Key, T, Hash, KeyEqual>::rehash(size_type count) {
+  if (count == 0 && items == 0) {
+    release();
+    return;
+  }
+  size_type target = normalizeCapacity(std::max(count, growthToLowerboundCapacity(items)));
+  // at the same capacity a rebuild is only worth it to clear deleted slots
+  if (target != capacity || growthLeft != capacityToGrowth(capacity) - items) resize(target);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void FlatHashMap<Key, T, Hash, KeyEqual>::clear() {
+  if (capacity == 0) return;
+  destroySlots();
+  items = 0;
+  std::fill_n(ctrl, capacity + GROUP_WIDTH, CTRL_EMPTY);
+  ctrl[capacity] = CTRL_SENTINEL;
+  growthLeft = capacityToGrowth(capacity);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void FlatHashMap<Key, T, Hash, KeyEqual>::destroySlots() {
+  if constexpr (!std::is_trivially_destructible_v<value_type>) {
+    for (size_type i = 0; i < capacity; ++i) {
+      if (isFull(ctrl[i])) std::destroy_at(slots + i);
+    }
+  }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void FlatHashMap<Key, T, Hash, KeyEqual>::release() {
+  if (capacity == 0) return;
+  destroySlots();
+  delete[] ctrl;
+  std::allocator<value_type>().deallocate(slots, capacity);
+  ctrl = emptyGroup();
+  slots = nullptr;
+  capacity = items = growthLeft = 0;
+}
+
+} // end namespace Chapter11
@@ -2,6 +2,10 @@
 
 #include <vector>
 #include <functional>
+#include <utility>
+#include <algorithm>
+#include <future>
+#include <thread>
 
 namespace Chapter2 {
   // merges the two sorted subarrays with elements in [start, mid) and [mid, end)
@@ -11,6 +15,25 @@ namespace Chapter2 {
   template <typename T, typename Compare = std::less<T>>
   void mergeSort(std::vector<T> &arr, Compare comp = Compare());
 
+  // ranges of at most this many elements are finished with insertion sort by bufferedMergeSort
+  inline constexpr int MERGE_SORT_CUTOFF = 16;
+
+  // mergeSort that allocates a single scratch buffer up front instead of two vectors per merge
+  template <typename T, typename Compare = std::less<T>>
+  void bufferedMergeSort(std::vector<T> &arr, Compare comp = Compare(), int cutoff = MERGE_SORT_CUTOFF);
+
+  // same as bufferedMergeSort, but reuses the caller's buffer so repeated sorts don't reallocate
+  template <typename T, typename Compare = std::less<T>>
+  void mergeSortWithBuffer(std::vector<T> &arr, std::vector<T> &buffer, Compare comp = Compare(), int cutoff = MERGE_SORT_CUTOFF);
+
+  // ranges smaller than this are not split across threads by parallelMergeSort
+  inline constexpr int PARALLEL_GRAIN_SIZE = 1 << 14;
+
+  // bufferedMergeSort that sorts and merges the halves of large ranges on separate threads.
+  // The result is identical to mergeSort since both are stable.
+  template <typename T, typename Compare = std::less<T>>
+  void parallelMergeSort(std::vector<T> &arr, Compare comp = Compare(), int threads = std::thread::hardware_concurrency(), int grain = PARALLEL_GRAIN_SIZE);
+
   template <typename T, typename Compare = std::less<T>>
   void selectionSort(std::vector<T> &arr, Compare comp = Compare());
 
@@ -65,6 +88,105 @@ namespace Chapter2 {
     mergeSortHelp(arr, 0, arr.size(), comp);
   }
 
+  // merges the sorted ranges src[i, iEnd) and src[j, jEnd) into dst starting at index,
+  // taking from the first range on ties
+  template <typename T, typename Compare>
+  void mergeRangesInto(std::vector<T> &src, int i, int iEnd, int j, int jEnd, std::vector<T> &dst, int index, const Compare &comp) {
+    while (i < iEnd && j < jEnd) {
+      if (!comp(src[j], src[i])) { // if L <= R
+        dst[index++] = std::move(src[i++]);
+      } else {
+        dst[index++] = std::move(src[j++]);
+      }
+    }
+    while (i < iEnd) dst[index++] = std::move(src[i++]);
+    while (j < jEnd) dst[index++] = std::move(src[j++]);
+  }
+
+  // merges the sorted ranges src[start, mid) and src[mid, end) into dst[start, end)
+  template <typename T, typename Compare>
+  void mergeInto(std::vector<T> &src, std::vector<T> &dst, int start, int mid, int end, const Compare &comp) {
+    mergeRangesInto(src, start, mid, mid, end, dst, start, comp);
+  }
+
+  // Sorts the elements in [start, end) into dst, using src as scratch space.
+  // Both vectors must hold the same elements in [start, end) on entry, so each level
+  // can sort its halves into src and merge them back into dst without copying.
+  template <typename T, typename Compare>
+  void pingPongMergeSort(std::vector<T> &src, std::vector<T> &dst, int start, int end, const Compare &comp, int cutoff) {
+    if (end - start <= cutoff) {
+      Chapter2::rangeInsertionSort(dst, start, end - 1, comp);
+      return;
+    }
+    int mid = start + (end - start) / 2;
+    pingPongMergeSort(dst, src, start, mid, comp, cutoff);
+    pingPongMergeSort(dst, src, mid, end, comp, cutoff);
+    mergeInto(src, dst, start, mid, end, comp);
+  }
+
+  template <typename T, typename Compare>
+  void bufferedMergeSort(std::vector<T> &arr, Compare comp, int cutoff) {
+    std::vector<T> buffer;
+    mergeSortWithBuffer(arr, buffer, comp, cutoff);
+  }
+
+  template <typename T, typename Compare>
+  void mergeSortWithBuffer(std::vector<T> &arr, std::vector<T> &buffer, Compare comp, int cutoff) {
+    if (arr.size() <= 1) return;
+    buffer.assign(arr.begin(), arr.end());
+    pingPongMergeSort(buffer, arr, 0, arr.size(), comp, std::max(cutoff, 1));
+  }
+
+  // Splits the merge of src[i, iEnd) and src[j, jEnd) around the middle element of the longer range.
+  // Ties are placed exactly where the sequential merge would put them, so the output is the same.
+  template <typename T, typename Compare>
+  void parallelMergeRangesInto(std::vector<T> &src, int i, int iEnd, int j, int jEnd, std::vector<T> &dst, int index, const Compare &comp, int threads, int grain) {
+    int n = (iEnd - i) + (jEnd - j);
+    if (threads <= 1 || n <= grain) {
+      mergeRangesInto(src, i, iEnd, j, jEnd, dst, index, comp);
+      return;
+    }
+    int iMid, jMid;
+    if (iEnd - i >= jEnd - j) {
+      iMid = i + (iEnd - i) / 2;
+      // right elements equal to the pivot come after it
+      jMid = std::lower_bound(src.begin() + j, src.begin() + jEnd, src[iMid], comp) - src.begin();
+    } else {
+      jMid = j + (jEnd - j) / 2;
+      // left elements equal to the pivot come before it
+      iMid = std::upper_bound(src.begin() + i, src.begin() + iEnd, src[jMid], comp) - src.begin();
+    }
+    int split = index + (iMid - i) + (jMid - j);
+    auto left = std::async(std::launch::async, [&]() {
+      parallelMergeRangesInto(src, i, iMid, j, jMid, dst, index, comp, threads / 2, grain);
+    });
+    parallelMergeRangesInto(src, iMid, iEnd, jMid, jEnd, dst, split, comp, threads - threads / 2, grain);
+    left.get();
+  }
+
+  // parallel version of pingPongMergeSort, forking the two halves while there are threads to spare
+  template <typename T, typename Compare>
+  void parallelPingPongMergeSort(std::vector<T> &src, std::vector<T> &dst, int start, int end, const Compare &comp, int threads, int grain) {
+    if (threads <= 1 || end - start <= grain) {
+      pingPongMergeSort(src, dst, start, end, comp, MERGE_SORT_CUTOFF);
+      return;
+    }
+    int mid = start + (end - start) / 2;
+    auto left = std::async(std::launch::async, [&]() {
+      parallelPingPongMergeSort(dst, src, start, mid, comp, threads / 2, grain);
+    });
+    parallelPingPongMergeSort(dst, src, mid, end, comp, threads - threads / 2, grain);
+    left.get();
+    parallelMergeRangesInto(src, start, mid, mid, end, dst, start, comp, threads, grain);
+  }
+
+  template <typename T, typename Compare>
+  void parallelMergeSort(std::vector<T> &arr, Compare comp, int threads, int grain) {
+    if (arr.size() <= 1) return;
+    std::vector<T> buffer(arr.begin(), arr.end());
+    parallelPingPongMergeSort(buffer, arr, 0, arr.size(), comp, threads, std::max(grain, MERGE_SORT_CUTOFF));
+  }
+
   template <typename T, typename Compare>
   void selectionSort(std::vector<T> &arr, Compare comp) {
     int n = arr.size();
@@ -82,26 +204,26 @@ namespace Chapter2 {
   void insertionSort(std::vector<T> &arr, Compare comp) {
     int n = arr.size();
     for (int i = 1; i < n; ++i) {
-      T key = arr[i];
+      T key = std::move(arr[i]);
       int j = i - 1;
       while (j >= 0 && comp(key, arr[j])) {
-        arr[j+1] = arr[j];
+        arr[j+1] = std::move(arr[j]);
         --j;
       }
-      arr[j+1] = key;
+      arr[j+1] = std::move(key);
     }
   }
 
   template <typename T, typename Compare>
   void rangeInsertionSort(std::vector<T> &arr, int p, int r, Compare comp) {
     for (int i = p+1; i <= r; ++i) {
-      T key = arr[i];
+      T key = std::move(arr[i]);
       int j = i - 1;
       while (j >= p && comp(key, arr[j])) {
-        arr[j+1] = arr[j];
+        arr[j+1] = std::move(arr[j]);
         --j;
       }
-      arr[j+1] = key;
+      arr[j+1] = std::move(key);
     }
   }
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <bit>
+
+namespace Chapter2 {
+  // largest range sorted by a fixed network
+  inline constexpr int MAX_NETWORK_SIZE = 16;
+
+  // Calls emit(i, j) for each comparator of Batcher's odd-even mergesort on n wires. The network
+  // is built for the next power of two and comparators touching the padding wires are dropped,
+  // which is valid since padding acts as +infinity and never moves.
+  template <typename Emit>
+  constexpr void oddEvenMergeNetwork(int n, Emit emit);
+
+  // number of comparators in the n-wire network
+  constexpr int networkSize(int n);
+
+  // the N-wire network as (i, j) wire pairs with i < j, generated at compile time
+  template <int N>
+  inline constexpr auto SORTING_NETWORK = [] {
+    std::array<std::pair<int, int>, networkSize(N)> network{};
+    int c = 0;
+    oddEvenMergeNetwork(N, [&network, &c](int i, int j) { network[c++] = {i, j}; });
+    return network;
+  }();
+
+  // Orders a and b so that !comp(b, a). Branchless (min/max or conditional moves) for arithmetic types.
+  template <typename T, typename Compare>
+  void compareExchange(T &a, T &b, Compare comp);
+
+  // Sorts first[0..N-1] with the unrolled N-wire network. Not stable.
+  template <int N, typename T, typename Compare = std::less<T>>
+  void networkSort(T *first, Compare comp = Compare());
+
+  // Sorts arr[p..r] with the matching network when it has at most MAX_NETWORK_SIZE elements.
+  // Returns false (leaving arr untouched) for larger ranges. Not stable.
+  template <typename T, typename Compare = std::less<T>>
+  bool smallSort(std::vector<T> &arr, int p, int r, Compare comp = Compare());
+
+  // Median of five with 6 comparisons: order two pairs, drop the smaller of their minimums
+  // (it is below three others), bring in the fifth element and repeat; the median is then
+  // the smaller of the two elements left that weren't compared against each other.
+  template <typename T, typename Compare = std::less<T>>
+  T medianOfFive(T a, T b, T c, T d, T e, Compare comp = Compare());
+
+  // ########  DEFINITIONS ########
+
+  template <typename Emit>
+  constexpr void oddEvenMergeNetwork(int n, Emit emit) {
+    int size = std::bit_ceil(static_cast<unsigned>(n));
+    for (int p = 1; p < size; p <<= 1) {
+      for (int k = p; k >= 1; k >>= 1) {
+        for (int j = k % p; j + k < size; j += 2*k) {
+          for (int i = 0; i < std::min(k, size - j - k); ++i) {
+            // only compare wires inside the same 2p-sized block, and skip the padding
+            if ((i + j) / (2*p) == (i + j + k) / (2*p) && i + j + k < n) emit(i + j, i + j + k);
+          }
+        }
+      }
+    }
+  }
+
+  constexpr int networkSize(int n) {
+    int count = 0;
+    oddEvenMergeNetwork(n, [&count](int, int) { ++count; });
+    return count;
+  }
+
+  template <typename T, typename Compare>
+  void compareExchange(T &a, T &b, Compare comp) {
+    if constexpr (std::is_arithmetic_v<T> && (std::is_same_v<Compare, std::less<T>> || std::is_same_v<Compare, std::less<>>)) {
+      // minss/maxss for floating point, cmov for integers
+      T low = std::min(a, b);
+      T high = std::max(a, b);
+      a = low;
+      b = high;
+    } else if constexpr (std::is_arithmetic_v<T>) {
+      bool swap = comp(b, a);
+      T low = swap ? b : a;
+      T high = swap ? a : b;
+      a = low;
+      b = high;
+    } else {
+      if (comp(b, a)) std::swap(a, b);
+    }
+  }
+
+  template <int N, typename T, typename Compare>
+  void networkSort(T *first, Compare comp) {
+    constexpr auto &network = SORTING_NETWORK<N>;
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      (compareExchange(first[network[I].first], first[network[I].second], comp), ...);
+    }(std::make_index_sequence<networkSize(N)>{});
+  }
+
+  template <typename T, typename Compare>
+  bool smallSort(std::vector<T> &arr, int p, int r, Compare comp) {
+    T *first = arr.data() + p;
+    switch (r - p + 1) {
+      case 2: networkSort<2>(first, comp); return true;
+      case 3: networkSort<3>(first, comp); return true;
+      case 4: networkSort<4>(first, comp); return true;
+      case 5: networkSort<5>(first, comp); return true;
+      case 6: networkSort<6>(first, comp); return true;
+      case 7: networkSort<7>(first, comp); return true;
+      case 8: networkSort<8>(first, comp); return true;
+      case 9: networkSort<9>(first, comp); return true;
+      case 10: networkSort<10>(first, comp); return true;
+      case 11: networkSort<11>(first, comp); return true;
+      case 12: networkSort<12>(first, comp); return true;
+      case 13: networkSort<13>(first, comp); return true;
+      case 14: networkSort<14>(first, comp); return true;
+      case 15: networkSort<15>(first, comp); return true;
+      case 16: networkSort<16>(first, comp); return true;
+      default: return r - p + 1 <= 1;
+    }
+  }
+
+  template <typename T, typename Compare>
+  T medianOfFive(T a, T b, T c, T d, T e, Compare comp) {
+    compareExchange(a, b, comp);
+    compareExchange(c, d, comp);
+    // make (a, b) the pair with the smaller minimum, then a is below b, c and d
+    if (comp(c, a)) {
+      std::swap(a, c);
+      std::swap(b, d);
+    }
+    a = e;
+    compareExchange(a, b, comp);
+    if (comp(c, a)) {
+      std::swap(a, c);
+      std::swap(b, d);
+    }
+    // the two dropped elements are the two smallest, so the median is min(b, c)
+    return comp(c, b) ? c : b;
+  }
+}
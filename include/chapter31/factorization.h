@@ -0,0 +1,40 @@
+#pragma once
+
+#include "bignum/big_int.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace NumberTheory {
+
+// factor trial divides by the numbers coprime to 30 up to this before anything else
+constexpr uint64_t WHEEL_TRIAL_LIMIT = 1 << 12;
+// Pollard-Brent steps per polynomial before findFactor moves on to ECM
+constexpr uint64_t RHO_ITERATIONS = 1 << 18;
+
+// Pollard's rho with Brent's cycle detection on f(x) = x^2 + c, multiplying the differences of a
+// batch of steps together so that one gcd covers the whole batch. Returns a nontrivial factor of
+// n, or nothing if none turned up within maxIterations steps or the cycle closed modulo n itself.
+std::optional<uint64_t> pollardBrent(uint64_t n, uint64_t c, uint64_t maxIterations = RHO_ITERATIONS);
+std::optional<BigNum::BigInt> pollardBrent(const BigNum::BigInt& n, uint64_t c, uint64_t maxIterations = RHO_ITERATIONS);
+
+// Lenstra's elliptic curve method on the Montgomery curve given by Suyama's parametrization with
+// sigma >= 6: stage 1 multiplies by every prime power up to B1, and a baby-step giant-step stage 2
+// covers one more prime up to 100 B1. Returns a nontrivial factor of n if the curve's order
+// modulo some prime factor is smooth enough, else nothing.
+std::optional<uint64_t> ecm(uint64_t n, uint64_t sigma, uint64_t B1);
+std::optional<BigNum::BigInt> ecm(const BigNum::BigInt& n, uint64_t sigma, uint64_t B1);
+
+// A nontrivial factor of a composite n: Pollard-Brent first, then ECM curves with growing bounds.
+// With several threads each runs its own polynomials and curves, and all of them stop as soon as
+// one finds a factor. Returns nothing once the whole ECM schedule has failed.
+std::optional<BigNum::BigInt> findFactor(const BigNum::BigInt& n, int threads = 1);
+
+// The prime factors of n with multiplicity, in increasing order; 1 has none and the sign of a
+// BigInt is ignored. Throws std::invalid_argument for 0, and std::runtime_error if some composite
+// cofactor resists findFactor.
+std::vector<uint64_t> factor(uint64_t n);
+std::vector<BigNum::BigInt> factor(const BigNum::BigInt& n, int threads = 1);
+
+}
@@ -1,27 +1,91 @@
 #pragma once
 
+#include "bignum/big_int.h"
+#include "bignum/operations.h"
+
+#include <bit>
+#include <concepts>
 #include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace NumberTheory {
 
+// Stein's binary gcd: only parity tests, halving and subtraction, iteratively, so no division is
+// ever needed. Works for the built-in integers and for any type with the IntType special-case
+// members, such as BigInt and FixedInt. The result is nonnegative, and gcd(0, 0) = 0.
+template <typename T>
+T binaryGcd(T a, T b) {
+  if (IntType::negative(a)) a = -a;
+  if (IntType::negative(b)) b = -b;
+  if (IntType::zero(a)) return b;
+  if (IntType::zero(b)) return a;
+
+  // gcd(2a, 2b) = 2 gcd(a, b), and once one side is odd the other side's factors of two drop out
+  int shift = 0;
+  while (IntType::even(a) && IntType::even(b)) {
+    a = IntType::half(a);
+    b = IntType::half(b);
+    ++shift;
+  }
+  while (IntType::even(a)) a = IntType::half(a);
+  while (!IntType::zero(b)) {
+    while (IntType::even(b)) b = IntType::half(b);
+    // both odd, so the difference is even and the loop above halves it at least once
+    if (b < a) std::swap(a, b);
+    b -= a;
+  }
+  return IntType::binary_scale_up(a, shift);
+}
+
+// The built-in integers strip whole runs of zero bits at once
+template <std::integral Int>
+Int binaryGcd(Int a, Int b) {
+  using Unsigned = std::make_unsigned_t<Int>;
+  Unsigned x = (a < 0)? Unsigned(0) - static_cast<Unsigned>(a): static_cast<Unsigned>(a);
+  Unsigned y = (b < 0)? Unsigned(0) - static_cast<Unsigned>(b): static_cast<Unsigned>(b);
+  if (x == 0) return static_cast<Int>(y);
+  if (y == 0) return static_cast<Int>(x);
+  int shift = std::countr_zero(static_cast<Unsigned>(x | y));
+  x >>= std::countr_zero(x);
+  while (y != 0) {
+    y >>= std::countr_zero(y);
+    if (y < x) std::swap(x, y);
+    y -= x;
+  }
+  return static_cast<Int>(x << shift);
+}
+
 template <typename T>
 T gcd(const T& a, const T& b) {
-  if (zero(b)) return T(0);
-  return gcd(b, a % b);
+  return binaryGcd(a, b);
 }
 
+// Lehmer's gcd (HAC Algorithm 14.57). While the operands span several limbs, it runs Euclid on
+// their leading 63 bits alone, batching the single-word quotients into a 2x2 cofactor matrix that
+// is then applied to the full operands with one pass of multiplications. A full division happens
+// only when the leading bits cannot determine a quotient.
+BigNum::BigInt gcd(const BigNum::BigInt& a, const BigNum::BigInt& b);
+
+// Returns (d, x, y) with d = gcd(a, b) = ax + by, for a, b >= 0. Iterative, keeping only the two
+// most recent remainders and cofactors instead of a tuple per level of recursion.
 template <typename T>
 std::tuple<T, T, T> extendedEuclid(const T& a, const T& b) {
-  using triple = std::tuple<T, T, T>;
-  if (zero(b)) return triple(a, 1, 0);
-  triple prev = extendedEuclid(b, a % b); // prev = (d, x, y)
-  return triple(std::get<0>(prev),                                  // d
-                std::get<2>(prev),                                  // y
-                std::get<1>(prev) - ((a / b) * std::get<2>(prev))); // x - [a/b]*y
+  T previousR = a, r = b;
+  T previousX = 1, x = 0;
+  T previousY = 0, y = 1;
+  while (!IntType::zero(r)) {
+    T q = previousR / r;
+    previousR = std::exchange(r, previousR - q * r);
+    previousX = std::exchange(x, previousX - q * x);
+    previousY = std::exchange(y, previousY - q * y);
+  }
+  return {previousR, previousX, previousY};
 }
 
 
-// Solves the equation ax ~ b (mod n) 
+// Solves the equation ax ~ b (mod n)
 template <typename T>
 std::vector<T> linearEquation(const T& a, const T& b, const T& n) {
 
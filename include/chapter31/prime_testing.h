@@ -0,0 +1,40 @@
+#pragma once
+
+#include "bignum/big_int.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace NumberTheory {
+
+// Primes below this are kept in a table, sieved once, for trial division and sieving
+constexpr uint32_t SMALL_PRIME_LIMIT = 1 << 16;
+// BigInt candidates are trial divided by the primes below this before any exponentiation
+constexpr uint32_t TRIAL_DIVISION_LIMIT = 1 << 11;
+
+// The primes below SMALL_PRIME_LIMIT in increasing order
+const std::vector<uint32_t>& smallPrimes();
+
+// Deterministic for every 64-bit value: Miller-Rabin with a base set known to have no strong
+// pseudoprimes below 2^64, in single-limb Montgomery arithmetic
+bool isPrime(uint64_t n);
+
+// Baillie-PSW: trial division, a strong base-2 Miller-Rabin test and a strong Lucas test with
+// Selfridge's parameters. No composite is known to pass, and values below 2^64 are decided by
+// the deterministic test above. Negative values are never prime.
+bool isPrime(const BigNum::BigInt& n);
+
+// Tests every candidate, spreading the work over the given number of threads
+std::vector<bool> isPrime(const std::vector<BigNum::BigInt>& candidates, int threads = 1);
+
+// The two halves of Baillie-PSW, for odd n > 2
+bool isStrongProbablePrime(const BigNum::BigInt& n, const BigNum::BigInt& base);
+bool isStrongLucasProbablePrime(const BigNum::BigInt& n);
+
+// The smallest prime greater than n. Windows of candidates above n are sieved by the small primes,
+// and only the survivors are tested, in order. The 64-bit version throws std::overflow_error if
+// that prime does not fit.
+uint64_t nextPrime(uint64_t n);
+BigNum::BigInt nextPrime(const BigNum::BigInt& n);
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "bignum/big_int.h"
+#include "bignum/montgomery.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace NumberTheory {
+
+// The usual public exponent, 2^16 + 1: a prime, so only primes p = 1 (mod e) are rejected, and
+// encryption with it takes 16 squarings and one multiplication
+constexpr uint64_t RSA_PUBLIC_EXPONENT = 65537;
+
+// Textbook RSA (CLRS 31.7) on BigInt, without padding: messages and ciphertexts are integers in
+// [0, n). Each key keeps the Montgomery contexts for its moduli, so it is cheap to use many times,
+// and both key types are immutable and may be shared between threads.
+class RsaPublicKey {
+ public:
+  // Throws std::invalid_argument unless modulus is odd and greater than 1 and exponent > 1
+  RsaPublicKey(const BigNum::BigInt& modulus, const BigNum::BigInt& exponent);
+
+  const BigNum::BigInt& modulus() const { return context.modulus(); }
+  const BigNum::BigInt& exponent() const { return e; }
+
+  // message^e mod n. An exponent that fits in a limb, such as 65537, is applied by left-to-right
+  // square-and-multiply on its bits without powmod's window table. Throws std::invalid_argument
+  // unless 0 <= message < n.
+  BigNum::BigInt encrypt(const BigNum::BigInt& message) const;
+  // Whether signature^e mod n is message
+  bool verify(const BigNum::BigInt& message, const BigNum::BigInt& signature) const;
+
+ private:
+  BigNum::BigInt e;
+  BigNum::MontgomeryContext context;
+};
+
+class RsaPrivateKey {
+ public:
+  // The key for n = pq. p and q must be distinct odd primes, which is not checked; throws
+  // std::invalid_argument if they are equal or publicExponent has no inverse modulo lcm(p-1, q-1).
+  RsaPrivateKey(const BigNum::BigInt& p, const BigNum::BigInt& q, const BigNum::BigInt& publicExponent);
+
+  // A key whose modulus has exactly the given number of bits, from two primes of about half as
+  // many found by nextPrime from random starting points with their top two bits set. std::mt19937_64
+  // is not a cryptographic generator, so these keys are for study and benchmarks only. Throws
+  // std::invalid_argument for fewer than 16 bits.
+  static RsaPrivateKey generate(int bits, std::mt19937_64& gen, uint64_t publicExponent = RSA_PUBLIC_EXPONENT);
+
+  const BigNum::BigInt& modulus() const { return contextN.modulus(); }
+  const BigNum::BigInt& privateExponent() const { return d; }
+  RsaPublicKey publicKey() const { return RsaPublicKey(modulus(), e); }
+
+  // ciphertext^d mod n by the Chinese remainder theorem: one exponentiation modulo each of p and q
+  // with exponents reduced modulo p - 1 and q - 1, each half the length of n and of d, which is
+  // about four times less work than the exponentiation modulo n, recombined by Garner's formula.
+  // Throws std::invalid_argument unless 0 <= ciphertext < n.
+  BigNum::BigInt decrypt(const BigNum::BigInt& ciphertext) const;
+  // The same by a single exponentiation modulo n, for comparison
+  BigNum::BigInt decryptWithoutCrt(const BigNum::BigInt& ciphertext) const;
+  BigNum::BigInt sign(const BigNum::BigInt& message) const { return decrypt(message); }
+
+  // decrypt or sign every input, spreading the work over the given number of threads
+  std::vector<BigNum::BigInt> decrypt(const std::vector<BigNum::BigInt>& ciphertexts, int threads) const;
+  std::vector<BigNum::BigInt> sign(const std::vector<BigNum::BigInt>& messages, int threads) const {
+    return decrypt(messages, threads);
+  }
+
+ private:
+  BigNum::BigInt e, d;
+  BigNum::BigInt dP, dQ; // d mod (p - 1) and d mod (q - 1)
+  BigNum::BigInt qInverse; // q^-1 mod p
+  BigNum::MontgomeryContext contextN, contextP, contextQ;
+};
+
+}
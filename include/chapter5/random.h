@@ -1,24 +1,57 @@
 #pragma once
 
 #include <random>
+#include <vector>
+#include <cstdint>
+#include <limits>
 
 namespace Chapter5 {
-  class Random {
+  // xoshiro256** by Blackman and Vigna: a 32-byte engine that is much cheaper to
+  // seed and step than std::mt19937. Satisfies UniformRandomBitGenerator.
+  class Xoshiro256 {
    public:
-    Random();
-    int operator()(int low, int high);
+    using result_type = uint64_t;
+    explicit Xoshiro256(uint64_t initialSeed = 0);
+    void seed(uint64_t newSeed);
+    result_type operator()();
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+   private:
+    uint64_t state[4];
+  };
+
+  template <typename Engine>
+  class BasicRandom {
+   public:
+    BasicRandom(); // seeded from std::random_device
+    explicit BasicRandom(unsigned seed);
+    int operator()(int low, int high); // returns random int in range [low, high]
     void resetSeed();
+    void seed(unsigned newSeed);
    private:
-    std::random_device rd;
     unsigned initialSeed;
-    std::mt19937 generator;
+    Engine generator;
   };
 
-  template <typename T>
-  void shuffle(std::vector<T> &vec) {
+  using Random = BasicRandom<std::mt19937>;
+  using FastRandom = BasicRandom<Xoshiro256>;
+
+  // Generator owned by the calling thread. The randomized partitions in Chapter7 and Chapter9
+  // draw from it, so a recursive sort reads std::random_device once per thread instead of per call
+  FastRandom &threadRandom();
+
+  // Reseeds the calling thread's generator so the randomized algorithms run after it are reproducible
+  void seedThreadRandom(unsigned seed);
+
+  template <typename T, typename Rand>
+  void shuffle(std::vector<T> &vec, Rand &rand) {
     int n = vec.size();
-    Random rand;
     for (int i = 0; i < n; ++i)
       std::swap(vec[i], vec[rand(i, n-1)]);
   }
-}
\ No newline at end of file
+
+  template <typename T>
+  void shuffle(std::vector<T> &vec) {
+    shuffle(vec, threadRandom());
+  }
+}
@@ -66,6 +66,40 @@ namespace Chapter6 {
     }
   }
 
+  // heapify for a heap stored in vec[offset, offset + heapSize), with index relative to offset
+  template <typename T, typename Compare = std::less<T>>
+  void rangeHeapify(std::vector<T> &vec, int offset, int heapSize, int index, const Compare &comp = Compare()) {
+    while (true) {
+      int l = left(index);
+      int r = right(index);
+      int maxIndex = index;
+
+      if (l < heapSize && comp(vec[offset + maxIndex], vec[offset + l])) {
+        maxIndex = l;
+      }
+      if (r < heapSize && comp(vec[offset + maxIndex], vec[offset + r])) {
+        maxIndex = r;
+      }
+      if (maxIndex == index) return;
+
+      std::swap(vec[offset + index], vec[offset + maxIndex]);
+      index = maxIndex;
+    }
+  }
+
+  // sorts vec[p, r] in place by building a heap rooted at vec[p]
+  template <typename T, typename Compare = std::less<T>>
+  void rangeHeapSort(std::vector<T> &vec, int p, int r, const Compare &comp = Compare()) {
+    int n = r - p + 1;
+    for (int i = n/2; i >= 0; --i) {
+      rangeHeapify(vec, p, n, i, comp);
+    }
+    for (int i = n-1; i > 0; --i) {
+      std::swap(vec[p], vec[p + i]);
+      rangeHeapify(vec, p, i, 0, comp);
+    }
+  }
+
   template <typename T, typename Compare = std::less<T>>
   class Heap {
     // Heap Property: In a valid heap, for every 0 < i < heapSize we have
@@ -2,24 +2,52 @@
 
 #include <vector>
 #include <functional>
+#include <algorithm>
 
 #include "chapter5/random.h"
 
 
 
 namespace Chapter7 {
+  // Lomuto partitions with one branch and swap per element, Block buffers comparison
+  // results for a block of elements at a time and swaps misplaced elements in bulk
+  enum class PartitionScheme { Lomuto, Block };
+
+  // number of elements classified at a time on each side by blockPartitionByValue
+  inline constexpr int PARTITION_BLOCK_SIZE = 128;
+
   template <typename T, typename U = T, typename Compare = std::less<T>>
   int partitionByValue(std::vector<T> &vec, const U &pivot, int p, int r, Compare comp = Compare());
 
   template <typename T, typename Compare = std::less<T>>
   int partition(std::vector<T> &vec, int p, int r, Compare comp = Compare());
 
+  // Same contract as partitionByValue, but pivot must not refer to an element of vec[p, r]
+  template <typename T, typename U = T, typename Compare = std::less<T>>
+  int blockPartitionByValue(std::vector<T> &vec, const U &pivot, int p, int r, Compare comp = Compare());
+
   template <typename T, typename Compare = std::less<T>>
+  int blockPartition(std::vector<T> &vec, int p, int r, Compare comp = Compare());
+
+  // partitions around vec[r] using the given scheme
+  template <PartitionScheme scheme, typename T, typename Compare>
+  int schemePartition(std::vector<T> &vec, int p, int r, const Compare &comp);
+
+  template <typename T, typename Compare = std::less<T>, PartitionScheme scheme = PartitionScheme::Lomuto>
   int randomPartition(std::vector<T> &vec, int p, int r, Compare comp = Compare());
 
   template <typename T, typename Compare = std::less<T>>
   int medianOfThreePartition(std::vector<T> &vec, int p, int r, Compare comp = Compare());
 
+  // Deterministic pivot: median of the first, middle and last elements, or Tukey's
+  // ninther (median of three medians of three) for larger subarrays
+  template <typename T, typename Compare = std::less<T>>
+  int nintherPartition(std::vector<T> &vec, int p, int r, Compare comp = Compare());
+
+  // moves the pivot nintherPartition would choose to vec[r], so any scheme can partition around it
+  template <typename T, typename Compare = std::less<T>>
+  void nintherToEnd(std::vector<T> &vec, int p, int r, Compare comp = Compare());
+
   template <typename T, typename Compare = std::less<T>>
   std::pair<int, int> threeWayPartitionByValue(std::vector<T> &vec, const T &pivot, int p, int r, Compare comp = Compare());
 
@@ -54,11 +82,66 @@ namespace Chapter7 {
     return partitionByValue(vec, vec[r], p, r, comp);
   }
 
+  template <typename T, typename U, typename Compare>
+  int blockPartitionByValue(std::vector<T> &vec, const U &pivot, int p, int r, Compare comp) {
+    const int B = PARTITION_BLOCK_SIZE;
+    // offsets of elements in the current left block that belong on the right, and vice versa
+    unsigned char offsetsLeft[B];
+    unsigned char offsetsRight[B];
+    int startLeft = 0, startRight = 0, numLeft = 0, numRight = 0;
+    int left = p; int right = r;
+
+    // Invariant: vec[p...left) <= pivot, vec(right...r] > pivot
+    while (right - left + 1 >= 2*B) {
+      // comparison results are added to the counts instead of branched on
+      if (numLeft == 0) {
+        startLeft = 0;
+        for (int i = 0; i < B; ++i) {
+          offsetsLeft[numLeft] = i;
+          numLeft += comp(pivot, vec[left + i]); // vec[left + i] > pivot
+        }
+      }
+      if (numRight == 0) {
+        startRight = 0;
+        for (int i = 0; i < B; ++i) {
+          offsetsRight[numRight] = i;
+          numRight += !comp(pivot, vec[right - i]); // vec[right - i] <= pivot
+        }
+      }
+      int num = std::min(numLeft, numRight);
+      for (int i = 0; i < num; ++i) {
+        std::swap(vec[left + offsetsLeft[startLeft + i]], vec[right - offsetsRight[startRight + i]]);
+      }
+      numLeft -= num; numRight -= num;
+      startLeft += num; startRight += num;
+      if (numLeft == 0) left += B;
+      if (numRight == 0) right -= B;
+    }
+    // fewer than two blocks (plus any half-finished block) are left
+    return partitionByValue(vec, pivot, left, right, comp);
+  }
+
   template <typename T, typename Compare>
+  int blockPartition(std::vector<T> &vec, int p, int r, Compare comp) {
+    int q = blockPartitionByValue(vec, vec[r], p, r - 1, comp) + 1;
+    std::swap(vec[q], vec[r]);
+    return q;
+  }
+
+  template <PartitionScheme scheme, typename T, typename Compare>
+  int schemePartition(std::vector<T> &vec, int p, int r, const Compare &comp) {
+    if constexpr (scheme == PartitionScheme::Block) {
+      return blockPartition(vec, p, r, comp);
+    } else {
+      return partition(vec, p, r, comp);
+    }
+  }
+
+  template <typename T, typename Compare, PartitionScheme scheme>
   int randomPartition(std::vector<T> &vec, int p, int r, Compare comp) {
-    Chapter5::Random rand;
+    Chapter5::FastRandom &rand = Chapter5::threadRandom();
     std::swap(vec[r], vec[rand(p, r)]);
-    return partition(vec, p, r, comp);
+    return schemePartition<scheme>(vec, p, r, comp);
   }
 
   template <typename T, typename Compare>
@@ -78,12 +161,33 @@ namespace Chapter7 {
 
   template <typename T, typename Compare>
   int medianOfThreePartition(std::vector<T> &vec, int p, int r, Compare comp) {
-    Chapter5::Random rand;
+    Chapter5::FastRandom &rand = Chapter5::threadRandom();
     T &pivot = median(vec[rand(p, r)], vec[rand(p, r)], vec[rand(p, r)], comp);
     std::swap(vec[r], pivot);
     return partition(vec, p, r, comp);
   }
 
+  template <typename T, typename Compare>
+  int nintherPartition(std::vector<T> &vec, int p, int r, Compare comp) {
+    nintherToEnd(vec, p, r, comp);
+    return partition(vec, p, r, comp);
+  }
+
+  template <typename T, typename Compare>
+  void nintherToEnd(std::vector<T> &vec, int p, int r, Compare comp) {
+    int n = r - p + 1;
+    int mid = p + n / 2;
+    if (n < 128) {
+      std::swap(vec[r], median(vec[p], vec[mid], vec[r], comp));
+    } else {
+      int step = n / 8;
+      T &first = median(vec[p], vec[p + step], vec[p + 2*step], comp);
+      T &second = median(vec[mid - step], vec[mid], vec[mid + step], comp);
+      T &third = median(vec[r - 2*step], vec[r - step], vec[r], comp);
+      std::swap(vec[r], median(first, second, third, comp));
+    }
+  }
+
   template <typename T, typename Compare>
   std::pair<int, int> threeWayPartitionByValue(std::vector<T> &vec, const T &pivot, int p, int r, Compare comp) {
     int less = p-1;
@@ -110,7 +214,7 @@ namespace Chapter7 {
 
   template <typename T, typename Compare>
   std::pair<int, int> randomThreeWayPartition(std::vector<T> &vec, int p, int r, Compare comp) {
-    Chapter5::Random rand;
+    Chapter5::FastRandom &rand = Chapter5::threadRandom();
     std::swap(vec[r], vec[rand(p, r)]);
     return threeWayPartition(vec, p, r, comp);
   }
@@ -1,28 +1,69 @@
 #pragma once
 
 #include "chapter7/partitions.h"
+#include "chapter2/sorting.h"
+#include "chapter2/sorting_networks.h"
+#include "chapter6/heaps.h"
 
 #include <vector>
 #include <functional>
 #include <utility>
 #include <iostream>
+#include <future>
+#include <thread>
+#include <bit>
 
 namespace Chapter7 {
-  template <typename T, typename Compare = std::less<T>>
+  // Deterministic quickSort on ninther pivots that recurses on the smaller side only and switches to
+  // heapSort past introDepthLimit, so sorted input is O(n log n) and the stack depth stays O(log n).
+  // scheme selects the partition kernel, e.g. quickSort<int, std::less<int>, PartitionScheme::Block>
+  template <typename T, typename Compare = std::less<T>, PartitionScheme scheme = PartitionScheme::Lomuto>
   void quickSort(std::vector<T> &vec, Compare comp = Compare());
 
-  template <typename T, typename Compare = std::less<T>>
+  template <typename T, typename Compare = std::less<T>, PartitionScheme scheme = PartitionScheme::Lomuto>
   void randomQuickSort(std::vector<T> &vec, Compare comp = Compare());
 
+  // subarrays smaller than this are not split across threads by parallelQuickSort
+  inline constexpr int PARALLEL_GRAIN_SIZE = 1 << 14;
+
+  // quickSort that sorts the two sides of large partitions on separate threads.
+  // Partitions are the same as quickSort's, so the result is identical.
+  template <typename T, typename Compare = std::less<T>>
+  void parallelQuickSort(std::vector<T> &vec, Compare comp = Compare(), int threads = std::thread::hardware_concurrency(), int grain = PARALLEL_GRAIN_SIZE);
+
+  // subarrays of at most this many elements are finished by introSort with a sorting network
+  inline constexpr int INTRO_SORT_CUTOFF = Chapter2::MAX_NETWORK_SIZE;
+
+  // partitioning depth after which quickSort and introSort give up on a subarray of n elements
+  // and heap sort it: 2 * floor(log2(n))
+  inline int introDepthLimit(int n) {
+    return n <= 1 ? 0 : 2 * (std::bit_width(static_cast<unsigned>(n)) - 1);
+  }
+
+  // Introspective quickSort: quickSort's pivots and depth limit, plus sorting networks for small subarrays, and recursion on the smaller side only
+  // so the stack depth stays O(log n)
+  template <typename T, typename Compare = std::less<T>>
+  void introSort(std::vector<T> &vec, Compare comp = Compare());
+
+  // introSort of the subarray vec[p...r], leaving the rest of vec untouched
+  template <typename T, typename Compare = std::less<T>>
+  void introSort(std::vector<T> &vec, int p, int r, Compare comp = Compare());
+
   template <typename T, typename Compare = std::less<T>>
   void fuzzySort(std::vector<std::pair<T, T>> &vec, Compare comp = Compare());
 
   // Helpers
+  template <typename T, typename Compare, PartitionScheme scheme = PartitionScheme::Lomuto>
+  void quickSortHelper(std::vector<T> &vec, int p, int r, const Compare &comp, int depthLimit);
+
+  template <typename T, typename Compare, PartitionScheme scheme = PartitionScheme::Lomuto>
+  void randomQuickSortHelper(std::vector<T> &vec, int p, int r, const Compare &comp);
+
   template <typename T, typename Compare>
-  void quickSortHelper(std::vector<T> &vec, int p, int r, const Compare &comp);
+  void parallelQuickSortHelper(std::vector<T> &vec, int p, int r, const Compare &comp, int threads, int grain, int depthLimit);
 
   template <typename T, typename Compare>
-  void randomQuickSortHelper(std::vector<T> &vec, int p, int r, const Compare &comp);
+  void introSortHelper(std::vector<T> &vec, int p, int r, const Compare &comp, int depthLimit);
 
   template <typename T, typename Compare, typename CompareValue>
   void fuzzySortHelper(std::vector<std::pair<T, T>> &vec, int p, int r, const Compare &comp, const CompareValue &compareLeft, const CompareValue &compareRight);
@@ -33,32 +74,97 @@ namespace Chapter7 {
 
   //// DEFINITIONS ////
 
-  template <typename T, typename Compare>
+  template <typename T, typename Compare, PartitionScheme scheme>
   void quickSort(std::vector<T> &vec, Compare comp) {
-    quickSortHelper(vec, 0, vec.size() - 1, comp);
+    quickSortHelper<T, Compare, scheme>(vec, 0, vec.size() - 1, comp, introDepthLimit(vec.size()));
   }
 
-  template <typename T, typename Compare>
-  void quickSortHelper(std::vector<T> &vec, int p, int r, const Compare &comp) {
-    if (p < r) {
-      int q = partition(vec, p, r, comp);
-      quickSortHelper(vec, p, q - 1, comp);
-      quickSortHelper(vec, q + 1, r, comp); 
+  template <typename T, typename Compare, PartitionScheme scheme>
+  void quickSortHelper(std::vector<T> &vec, int p, int r, const Compare &comp, int depthLimit) {
+    while (p < r) {
+      if (depthLimit == 0) {
+        Chapter6::rangeHeapSort(vec, p, r, comp);
+        return;
+      }
+      --depthLimit;
+      nintherToEnd(vec, p, r, comp);
+      int q = schemePartition<scheme>(vec, p, r, comp);
+      // recurse into the smaller side and loop on the larger one
+      if (q - p < r - q) {
+        quickSortHelper<T, Compare, scheme>(vec, p, q - 1, comp, depthLimit);
+        p = q + 1;
+      } else {
+        quickSortHelper<T, Compare, scheme>(vec, q + 1, r, comp, depthLimit);
+        r = q - 1;
+      }
     }
   }
 
   template <typename T, typename Compare>
-  void randomQuickSort(std::vector<T> &vec, Compare comp) {
-    randomQuickSortHelper(vec, 0, vec.size() - 1, comp);
+  void parallelQuickSort(std::vector<T> &vec, Compare comp, int threads, int grain) {
+    parallelQuickSortHelper(vec, 0, vec.size() - 1, comp, threads, grain, introDepthLimit(vec.size()));
   }
 
   template <typename T, typename Compare>
+  void parallelQuickSortHelper(std::vector<T> &vec, int p, int r, const Compare &comp, int threads, int grain, int depthLimit) {
+    if (threads <= 1 || r - p + 1 <= grain || depthLimit == 0) {
+      quickSortHelper(vec, p, r, comp, depthLimit);
+      return;
+    }
+    nintherToEnd(vec, p, r, comp);
+    int q = partition(vec, p, r, comp);
+    // the two sides are disjoint, so they can be sorted concurrently
+    auto left = std::async(std::launch::async, [&]() {
+      parallelQuickSortHelper(vec, p, q - 1, comp, threads / 2, grain, depthLimit - 1);
+    });
+    parallelQuickSortHelper(vec, q + 1, r, comp, threads - threads / 2, grain, depthLimit - 1);
+    left.get();
+  }
+
+  template <typename T, typename Compare, PartitionScheme scheme>
+  void randomQuickSort(std::vector<T> &vec, Compare comp) {
+    randomQuickSortHelper<T, Compare, scheme>(vec, 0, vec.size() - 1, comp);
+  }
+
+  template <typename T, typename Compare, PartitionScheme scheme>
   void randomQuickSortHelper (std::vector<T> &vec, int p, int r, const Compare &comp) {
     if (p < r) {
-      int q = randomPartition(vec, p, r, comp);
-      randomQuickSortHelper(vec, p, q - 1, comp);
-      randomQuickSortHelper(vec, q + 1, r, comp); 
+      int q = randomPartition<T, Compare, scheme>(vec, p, r, comp);
+      randomQuickSortHelper<T, Compare, scheme>(vec, p, q - 1, comp);
+      randomQuickSortHelper<T, Compare, scheme>(vec, q + 1, r, comp); 
+    }
+  }
+
+  template <typename T, typename Compare>
+  void introSort(std::vector<T> &vec, Compare comp) {
+    introSort(vec, 0, static_cast<int>(vec.size()) - 1, comp);
+  }
+
+  template <typename T, typename Compare>
+  void introSort(std::vector<T> &vec, int p, int r, Compare comp) {
+    if (r <= p) return;
+    introSortHelper(vec, p, r, comp, introDepthLimit(r - p + 1));
+  }
+
+  template <typename T, typename Compare>
+  void introSortHelper(std::vector<T> &vec, int p, int r, const Compare &comp, int depthLimit) {
+    while (r - p + 1 > INTRO_SORT_CUTOFF) {
+      if (depthLimit == 0) {
+        Chapter6::rangeHeapSort(vec, p, r, comp);
+        return;
+      }
+      --depthLimit;
+      int q = nintherPartition(vec, p, r, comp);
+      // recurse into the smaller side and loop on the larger one
+      if (q - p < r - q) {
+        introSortHelper(vec, p, q - 1, comp, depthLimit);
+        p = q + 1;
+      } else {
+        introSortHelper(vec, q + 1, r, comp, depthLimit);
+        r = q - 1;
+      }
     }
+    Chapter2::smallSort(vec, p, r, comp);
   }
 
   template <typename T, typename Compare>
@@ -2,16 +2,34 @@
 
 #include "chapter8/linear_sorting.h"
 #include "chapter2/sorting.h"
+#include "chapter7/quick_sort.h"
 
 #include <vector>
+#include <algorithm>
 #include <functional>
 #include <type_traits>
 #include <cmath>
 #include <numeric>
 #include <iostream>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <utility>
+#include <atomic>
+#include <future>
+#include <thread>
 
 namespace Chapter8 {
-  void countingSort(std::vector<int> &vec, int k, std::function<int(int)> transform = [](int x) { return x; });
+  // Stable counting sort of any record type by key(x), which must lie in [0, k].
+  // key is a template parameter so it is inlined instead of called through std::function
+  template <typename T, typename KeyFunction = std::identity>
+  void countingSort(std::vector<T> &vec, int k, KeyFunction key = KeyFunction());
+
+  // Same as above, but reuses count and buffer so repeated calls (e.g. one per radixSort digit)
+  // don't reallocate. Both are scratch: on return buffer holds the moved-from input elements and
+  // count the start index of each key, and neither should be relied on.
+  template <typename T, typename KeyFunction>
+  void countingSort(std::vector<T> &vec, int k, KeyFunction key, std::vector<int> &count, std::vector<T> &buffer);
 
   class RangeQuery {
     int range; // vec contains int in range [0, range]
@@ -23,43 +41,281 @@ namespace Chapter8 {
 
   void radixSort(std::vector<int> &vec);
 
+  // Maps an arithmetic key to an unsigned integer of the same width whose unsigned order
+  // matches the key's order: signed ints get their sign bit flipped, negative floats get
+  // all bits flipped and non-negative floats get their sign bit set
+  template <typename K>
+  auto radixKey(K key);
+
+  // Byte-wise (radix 256) LSD radix sort for integral and floating point types
   template <typename T>
-  void bucketSort(std::vector<T> &vec, std::function<double(T)> cdf = [](T x) { return x; });
+  void lsdRadixSort(std::vector<T> &vec);
 
-  // Helper
+  // Stable LSD radix sort of records by an arithmetic key, e.g. key-value pairs by key
+  template <typename T, typename KeyFunction>
+  void lsdRadixSortByKey(std::vector<T> &vec, KeyFunction key);
+
+  // buckets of at most this many elements are finished with insertion sort by the MSD radix sorts
+  inline constexpr int MSD_INSERTION_CUTOFF = 32;
+
+  // Multi-threaded MSD radix sort for integral and floating point types. Threads histogram and
+  // scatter their share of the input on the top byte, then the 256 buckets are handed out to
+  // the threads from a shared counter and radix sorted on the remaining bytes independently.
   template <typename T>
-  void printBucketStats(const std::vector<std::vector<T>> &buckets);
+  void parallelRadixSort(std::vector<T> &vec, int threads = std::thread::hardware_concurrency());
+
+  // the bucket sort aims for this many elements per bucket
+  inline constexpr int BUCKET_TARGET_LOAD = 2;
+
+  // Bucket occupancy of one bucketSort call, for tuning the cdf and bucket load
+  struct BucketStats {
+    int bucketCount = 0;
+    int largestBucket = 0;
+    int bucketsOfAtLeastTwo = 0;
+    int bucketsOfAtLeastThree = 0;
+    long long squaredSizeSum = 0; // proportional to the insertion sort work
+  };
+
+  // Bucket sort for arithmetic types. By default it expects input drawn uniformly from [0, 1].
+  // For other inputs, provide the CDF of the distribution the elements are drawn from as cdf, any
+  // callable mapping T to an arithmetic value, e.g. [](double x) { return x * x; } for input in
+  // [0, 1] that gets denser near 1. Its values are rescaled to the range actually observed, so only
+  // the shape of the cdf matters. Buckets are sized with a counting pass and scattered into one
+  // contiguous buffer, then sorted in place: small buckets by insertion sort, large ones by introsort.
+  template <typename T, typename Cdf = std::identity>
+  BucketStats bucketSort(std::vector<T> &vec, Cdf cdf = Cdf());
+
+  // Helper
+  void printBucketStats(const BucketStats &stats);
 
 
   // Definitions
 
-  // Bucket sort by default accepts input in [0, 1]
-  // For custom usage, provide a CDF function that maps T -> [0, 1] which is meant to be used
-  // as if the input to the vec array were drawn from a distribution given by the cdf
+  template <typename T, typename KeyFunction>
+  void countingSort(std::vector<T> &vec, int k, KeyFunction key) {
+    std::vector<int> count;
+    std::vector<T> buffer;
+    countingSort(vec, k, key, count, buffer);
+  }
+
+  template <typename T, typename KeyFunction>
+  void countingSort(std::vector<T> &vec, int k, KeyFunction key, std::vector<int> &count, std::vector<T> &buffer) {
+    int n = vec.size();
+    count.assign(k+1, 0);
+    buffer.resize(n);
+
+    // count[i] holds # of elements with key == i
+    for (const auto &x : vec) ++count[key(x)];
+    // count[i] holds # of elements with key <= i
+    for (int i = 1; i <= k; ++i) count[i] += count[i-1];
+    // Iterate backwards through vector and place all equal keys in their place
+    // in reverse order to keep stability
+    for (int i = n-1; i >= 0; --i) {
+      buffer[--count[key(vec[i])]] = std::move(vec[i]);
+    }
+    vec.swap(buffer);
+  }
+
+  template <typename K>
+  auto radixKey(K key) {
+    static_assert(std::is_arithmetic<K>::value, "radix sort keys must be of numeric type");
+    if constexpr (std::is_floating_point<K>::value) {
+      using U = std::conditional_t<sizeof(K) == 4, uint32_t, uint64_t>;
+      U bits = std::bit_cast<U>(key);
+      U signBit = U(1) << (8*sizeof(U) - 1);
+      return (bits & signBit) ? static_cast<U>(~bits) : static_cast<U>(bits | signBit);
+    } else {
+      using U = std::make_unsigned_t<K>;
+      U bits = static_cast<U>(key);
+      if constexpr (std::is_signed<K>::value) bits ^= U(1) << (8*sizeof(U) - 1);
+      return bits;
+    }
+  }
+
   template <typename T>
-  void bucketSort(std::vector<T> &vec, std::function<double(T)> cdf) {
-    static_assert(std::is_arithmetic<T>::value, "bucketSort template type must be of numeric type");
+  void lsdRadixSort(std::vector<T> &vec) {
+    lsdRadixSortByKey(vec, [](const T &x) { return x; });
+  }
+
+  template <typename T, typename KeyFunction>
+  void lsdRadixSortByKey(std::vector<T> &vec, KeyFunction key) {
+    using Key = std::decay_t<decltype(radixKey(key(vec[0])))>;
+    constexpr int passes = sizeof(Key);
     int n = vec.size();
-    std::vector<std::vector<T>> buckets(n + 1, std::vector<T>{});
-    for (auto x : vec) buckets[static_cast<int>(floor(n*cdf(x)))].push_back(x);
-    for (auto &bucket : buckets) Chapter2::insertionSort(bucket);
-    // printBucketStats(buckets);
-    int progress = 0;
-    for (auto bucket : buckets) {
-      int bucketSize = bucket.size();
-      std::copy_n(bucket.begin(), bucketSize, vec.begin()+progress);
-      progress += bucketSize;
+    if (n <= 1) return;
+
+    // histograms for every byte are computed in a single pass over the input
+    std::array<std::array<int, 256>, passes> counts{};
+    for (const auto &x : vec) {
+      Key k = radixKey(key(x));
+      for (int pass = 0; pass < passes; ++pass) ++counts[pass][(k >> (8*pass)) & 0xFF];
+    }
+
+    std::vector<T> buffer(n);
+    std::vector<T> *source = &vec;
+    std::vector<T> *destination = &buffer;
+    for (int pass = 0; pass < passes; ++pass) {
+      std::array<int, 256> &count = counts[pass];
+      // every key has the same byte here, so this pass would not move anything
+      if (count[(radixKey(key((*source)[0])) >> (8*pass)) & 0xFF] == n) continue;
+
+      // count[i] becomes the first output index of byte i
+      int total = 0;
+      for (auto &c : count) {
+        int bucketSize = c;
+        c = total;
+        total += bucketSize;
+      }
+      for (auto &x : *source) {
+        int byte = (radixKey(key(x)) >> (8*pass)) & 0xFF;
+        (*destination)[count[byte]++] = std::move(x);
+      }
+      std::swap(source, destination);
+    }
+    if (source != &vec) vec.swap(buffer);
+  }
+
+  // sorts vec[start, end) on bytes byte, byte-1, ..., 0 of radixKey, using buffer[start, end) as scratch
+  template <typename T>
+  void msdRadixSortHelper(std::vector<T> &vec, std::vector<T> &buffer, int start, int end, int byte) {
+    int n = end - start;
+    if (n <= MSD_INSERTION_CUTOFF) {
+      Chapter2::rangeInsertionSort(vec, start, end - 1);
+      return;
+    }
+    for (; byte >= 0; --byte) {
+      std::array<int, 257> count{}; // count[i+1] holds # of elements with byte i
+      for (int i = start; i < end; ++i) ++count[((radixKey(vec[i]) >> (8*byte)) & 0xFF) + 1];
+      if (std::find(count.begin(), count.end(), n) != count.end()) continue; // only one bucket
+
+      // count[i] becomes the first index of bucket i
+      for (int i = 1; i <= 256; ++i) count[i] += count[i-1];
+      std::array<int, 257> next = count;
+      for (int i = start; i < end; ++i) {
+        int digit = (radixKey(vec[i]) >> (8*byte)) & 0xFF;
+        buffer[start + next[digit]++] = std::move(vec[i]);
+      }
+      std::move(buffer.begin() + start, buffer.begin() + end, vec.begin() + start);
+      for (int i = 0; i < 256; ++i) {
+        msdRadixSortHelper(vec, buffer, start + count[i], start + count[i+1], byte - 1);
+      }
+      return;
     }
   }
 
   template <typename T>
-  void printBucketStats(const std::vector<std::vector<T>> &buckets) {
-    std::cout << "Number of buckets: " << buckets.size() << std::endl;
-    auto maxBucket = std::max_element(buckets.begin(), buckets.end(), [](const std::vector<T> &bucket1, const std::vector<T> &bucket2) { return bucket1.size() < bucket2.size(); });
-    std::cout << "Largest bucket: " << (*maxBucket).size() << std::endl;
-    std::cout << "Number of buckets with size >= 2: " << std::count_if(buckets.begin(), buckets.end(), [](const std::vector<T> &bucket) { return bucket.size() >= 2; }) << std::endl;
-    std::cout << "Number of buckets with size >= 3: " << std::count_if(buckets.begin(), buckets.end(), [](const std::vector<T> &bucket) { return bucket.size() >= 3; }) << std::endl;
-    int squaredSum = std::accumulate(buckets.begin(), buckets.end(), 0, [](int a, const std::vector<T> &b) { return a + std::pow(b.size(), 2);});
-    std::cout << "Sum of N^2 for each bucket: " << squaredSum << " --- " << static_cast<double>(squaredSum) / buckets.size()  << std::endl;
+  void parallelRadixSort(std::vector<T> &vec, int threads) {
+    using Key = decltype(radixKey(std::declval<T>()));
+    int topByte = sizeof(Key) - 1;
+    int n = vec.size();
+    std::vector<T> buffer(n);
+    threads = std::max(1, std::min(threads, n / MSD_INSERTION_CUTOFF));
+    if (threads == 1) {
+      msdRadixSortHelper(vec, buffer, 0, n, topByte);
+      return;
+    }
+
+    auto topDigit = [topByte](const T &x) { return static_cast<int>((radixKey(x) >> (8*topByte)) & 0xFF); };
+    auto runOnThreads = [threads](auto task) {
+      std::vector<std::future<void>> workers;
+      for (int t = 0; t < threads; ++t) workers.push_back(std::async(std::launch::async, task, t));
+      for (auto &worker : workers) worker.get();
+    };
+
+    // each thread histograms its own contiguous chunk of the input
+    std::vector<std::array<int, 256>> histograms(threads);
+    auto chunkStart = [n, threads](int t) { return static_cast<int>(static_cast<long long>(n) * t / threads); };
+    runOnThreads([&](int t) {
+      histograms[t].fill(0);
+      for (int i = chunkStart(t); i < chunkStart(t+1); ++i) ++histograms[t][topDigit(vec[i])];
+    });
+
+    // within bucket b, thread t writes after the elements of bucket b from threads 0..t-1
+    std::vector<std::array<int, 256>> offsets(threads);
+    std::array<int, 257> bucketStart{};
+    int total = 0;
+    for (int b = 0; b < 256; ++b) {
+      bucketStart[b] = total;
+      for (int t = 0; t < threads; ++t) {
+        offsets[t][b] = total;
+        total += histograms[t][b];
+      }
+    }
+    bucketStart[256] = total;
+
+    runOnThreads([&](int t) {
+      for (int i = chunkStart(t); i < chunkStart(t+1); ++i) {
+        buffer[offsets[t][topDigit(vec[i])]++] = std::move(vec[i]);
+      }
+    });
+    vec.swap(buffer);
+
+    // largest buckets first, so a late large bucket doesn't leave the other threads idle
+    std::vector<int> order(256);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&bucketStart](int a, int b) {
+      return bucketStart[a+1] - bucketStart[a] > bucketStart[b+1] - bucketStart[b];
+    });
+    std::atomic<int> nextBucket{0};
+    runOnThreads([&](int) {
+      for (int i = nextBucket++; i < 256; i = nextBucket++) {
+        int b = order[i];
+        msdRadixSortHelper(vec, buffer, bucketStart[b], bucketStart[b+1], topByte - 1);
+      }
+    });
+  }
+
+  template <typename T, typename Cdf>
+  BucketStats bucketSort(std::vector<T> &vec, Cdf cdf) {
+    static_assert(std::is_arithmetic<T>::value, "bucketSort template type must be of numeric type");
+    BucketStats stats;
+    int n = vec.size();
+    if (n <= MSD_INSERTION_CUTOFF) {
+      Chapter2::rangeInsertionSort(vec, 0, n - 1);
+      stats.bucketCount = 1;
+      stats.largestBucket = n;
+      stats.bucketsOfAtLeastTwo = n >= 2;
+      stats.bucketsOfAtLeastThree = n >= 3;
+      stats.squaredSizeSum = static_cast<long long>(n) * n;
+      return stats;
+    }
+
+    // evaluate the cdf once per element and keep its values for the counting and scatter passes
+    std::vector<double> position(n);
+    for (int i = 0; i < n; ++i) position[i] = static_cast<double>(cdf(vec[i]));
+    auto [low, high] = std::minmax_element(position.begin(), position.end());
+    double offset = *low, spread = *high - *low;
+
+    int bucketCount = std::max(1, n / BUCKET_TARGET_LOAD);
+    double scale = spread > 0 ? bucketCount / spread : 0;
+    std::vector<int> bucketOf(n);
+    std::vector<int> count(bucketCount + 1, 0);
+    for (int i = 0; i < n; ++i) {
+      bucketOf[i] = std::min(static_cast<int>((position[i] - offset) * scale), bucketCount - 1);
+      ++count[bucketOf[i] + 1];
+    }
+    // count[b] becomes the first index of bucket b
+    for (int b = 0; b < bucketCount; ++b) count[b+1] += count[b];
+
+    std::vector<T> buffer(n);
+    std::vector<int> next(count.begin(), count.end() - 1);
+    for (int i = 0; i < n; ++i) buffer[next[bucketOf[i]]++] = vec[i];
+    vec.swap(buffer);
+
+    stats.bucketCount = bucketCount;
+    for (int b = 0; b < bucketCount; ++b) {
+      int start = count[b], size = count[b+1] - start;
+      if (size > MSD_INSERTION_CUTOFF) {
+        // a poorly fitting cdf piles elements into a few buckets; keep those O(size lg size)
+        Chapter7::introSort(vec, start, start + size - 1, std::less<T>());
+      } else if (size > 1) {
+        Chapter2::rangeInsertionSort(vec, start, start + size - 1);
+      }
+      stats.largestBucket = std::max(stats.largestBucket, size);
+      stats.bucketsOfAtLeastTwo += size >= 2;
+      stats.bucketsOfAtLeastThree += size >= 3;
+      stats.squaredSizeSum += static_cast<long long>(size) * size;
+    }
+    return stats;
   }
-}
\ No newline at end of file
+}
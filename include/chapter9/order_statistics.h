@@ -1,6 +1,7 @@
 #pragma once
 
 #include "chapter2/sorting.h"
+#include "chapter2/sorting_networks.h"
 #include "chapter7/partitions.h"
 
 #include <vector>
@@ -16,7 +17,8 @@ namespace Chapter9 {
   template <typename T, typename Compare = std::less<T>>
   std::pair<T&, T&> minMax(std::vector<T> &vec, Compare comp = Compare());
 
-  template <typename T, typename Compare = std::less<T>>
+  // scheme selects the partition kernel used by randomPartition
+  template <typename T, typename Compare = std::less<T>, Chapter7::PartitionScheme scheme = Chapter7::PartitionScheme::Lomuto>
   T &select(std::vector<T> &vec, int index, Compare comp = Compare());
 
   template <typename T, typename Compare = std::less<T>>
@@ -25,7 +27,7 @@ namespace Chapter9 {
   int medianOfTwoSortedLists(const std::vector<int> &vec1, const std::vector<int> &vec2);
 
   // Helpers
-  template <typename T, typename Compare = std::less<T>>
+  template <typename T, typename Compare = std::less<T>, Chapter7::PartitionScheme scheme = Chapter7::PartitionScheme::Lomuto>
   T &selectHelper(std::vector<T> &vec, int index, int p, int r, Compare comp = Compare());
 
   template <typename T, typename Compare = std::less<T>>
@@ -73,21 +75,21 @@ namespace Chapter9 {
     return std::pair<T&, T&>(vec[minIndex], vec[maxIndex]);
   }
 
-  template <typename T, typename Compare>
+  template <typename T, typename Compare, Chapter7::PartitionScheme scheme>
   T &select(std::vector<T> &vec, int index, Compare comp) {
-    return selectHelper(vec, index, 0, vec.size() - 1, comp);
+    return selectHelper<T, Compare, scheme>(vec, index, 0, vec.size() - 1, comp);
   }
 
-  template <typename T, typename Compare>
+  template <typename T, typename Compare, Chapter7::PartitionScheme scheme>
   T &selectHelper(std::vector<T> &vec, int index, int p, int r, Compare comp) {
     if (p == r) return vec[p];
-    int q = Chapter7::randomPartition(vec, p, r, comp);
+    int q = Chapter7::randomPartition<T, Compare, scheme>(vec, p, r, comp);
     int k = q - p;
     if (index == k) return vec[q];
     else if (index < k) {
-      return selectHelper(vec, index, p, q-1, comp);
+      return selectHelper<T, Compare, scheme>(vec, index, p, q-1, comp);
     } else {
-      return selectHelper(vec, index-k-1, q+1, r, comp);
+      return selectHelper<T, Compare, scheme>(vec, index-k-1, q+1, r, comp);
     }
   }
 
@@ -102,17 +104,16 @@ namespace Chapter9 {
     int n = r - p + 1;
     int sections = n / 5;
 
-    std::vector<int> medians(sections);
+    std::vector<T> medians(sections);
     for (int i = 0; i < sections; ++i) {
       int start = p + 5*i;
-      Chapter2::rangeInsertionSort(vec, start, start + 4);
-      medians[i] = vec[start + 2];
+      medians[i] = Chapter2::medianOfFive(vec[start], vec[start+1], vec[start+2], vec[start+3], vec[start+4], comp);
     }
     if (n % 5) {
       medians.push_back(vec[r]);
     }
 
-    int medianOfMedians = worstCaseLinearSelect(medians, sections / 2, comp);
+    T medianOfMedians = worstCaseLinearSelect(medians, sections / 2, comp);
 
     int q = Chapter7::partitionByValue(vec, medianOfMedians, p, r, comp);
 
@@ -1,26 +1,98 @@
 #include "bignum/big_int.h"
 #include "bignum/operations.h"
+#include "bignum/ntt.h"
 
 #include "helpers/speed_profiler.h"
 
 #include <cctype>
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <bitset>
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 
 namespace BigNum {
 
-int BigInt::BASE = 2;
-uint64_t BigInt::BIT_SIZE = static_cast<uint64_t>(1) << BigInt::BASE;
+// largest power of ten that fits in a limb, used to convert 19 decimal digits at a time
+constexpr int DECIMAL_CHUNK_DIGITS = 19;
+constexpr uint64_t DECIMAL_CHUNK = 10000000000000000000ull;
+
+namespace {
+
+constexpr char DIGIT_CHARACTERS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+// value of c as a digit, or 36 when it is not a digit in any base up to 36
+int digitValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+  return 36;
+}
+
+// log2(base) for the power-of-two bases up to 32, 0 for any other base
+int powerOfTwoBits(int base) {
+  if (base < 2 || base > 32 || !std::has_single_bit(static_cast<unsigned>(base))) return 0;
+  return std::countr_zero(static_cast<unsigned>(base));
+}
+
+// per-thread buffer reused by the in-place multiplications
+std::vector<uint64_t>& scratchLimbs() {
+  thread_local std::vector<uint64_t> scratch;
+  return scratch;
+}
+
+} // end anonymous namespace
+
+// powers[k] = 10^(19 * 2^k), each the square of the one before, built on first use together
+// with the reciprocals used to divide by them. Each thread keeps one cache, so repeated
+// conversions pay for the powers only once.
+struct BigInt::DecimalPowers {
+  std::vector<BigInt> powers;
+  std::vector<BigInt> reciprocals; // zero until first needed
+
+  static DecimalPowers& cached() {
+    thread_local DecimalPowers instance;
+    return instance;
+  }
+
+  const BigInt& operator[](int k) {
+    if (powers.empty()) powers.push_back(BigInt(DECIMAL_CHUNK));
+    while (static_cast<int>(powers.size()) <= k) powers.push_back(powers.back().square());
+    return powers[k];
+  }
+
+  // (value / powers[k], value % powers[k]) for value < powers[k]^2
+  std::pair<BigInt, BigInt> divide(const BigInt& value, int k) {
+    const BigInt& power = (*this)[k];
+    if (static_cast<int>(power.bits.size()) < BARRETT_THRESHOLD) return value.divmod(power);
+    int bits = power.bitLength();
+    if (static_cast<int>(reciprocals.size()) <= k) reciprocals.resize(k + 1, BigInt(0));
+    if (reciprocals[k].zero()) reciprocals[k] = reciprocal(power, bits);
+    // Barrett reduction on the top half of value (HAC 14.42): since value < 2^(2 * bits), the
+    // estimate is at most 2 below the quotient
+    BigInt quotient = (value.binaryScaleDown(bits - 1) * reciprocals[k]).binaryScaleDown(bits + 1);
+    BigInt remainder = value - quotient * power;
+    while (remainder >= power) {
+      ++quotient;
+      remainder -= power;
+    }
+    return std::pair<BigInt, BigInt>(std::move(quotient), std::move(remainder));
+  }
+};
+
+int BigInt::KARATSUBA_THRESHOLD = 48;
+int BigInt::TOOM3_THRESHOLD = 384;
+int BigInt::NTT_THRESHOLD = 4096;
+int BigInt::RADIX_SPLIT_THRESHOLD = 24;
+int BigInt::BARRETT_THRESHOLD = 64;
 
 BigInt::BigInt(const std::string& str) {
   for (auto c : str) {
     if (!isdigit(c)) { throw std::out_of_range("String must be valid base ten number"); }
-    int digit = c - '0';
-    *this *= 10;
-    *this += digit;
   }
+  *this = parseDecimal(str.data(), str.data() + str.size(), DecimalPowers::cached());
 }
 
 BigInt::BigInt(const BigInt& other) : bits{other.bits}, isPositive{other.isPositive} {}
@@ -63,11 +135,12 @@ BigInt BigInt::operator+(const BigInt& other) const {
   }
 }
 BigInt &BigInt::operator+=(const BigInt& other) {
-  *this = *this + other;
+  addSigned(other.bits.data(), other.bits.size(), other.negative());
   return *this;
 }
 BigInt &BigInt::operator++() {
-  *this += BigInt(1);
+  const bit_type one = 1;
+  addSigned(&one, 1, false);
   return *this;
 }
 BigInt BigInt::operator++(int) {
@@ -100,11 +173,12 @@ BigInt BigInt::operator-(const BigInt& other) const {
   }
 }
 BigInt &BigInt::operator-=(const BigInt& other) {
-  *this = *this - other;
+  addSigned(other.bits.data(), other.bits.size(), !other.negative());
   return *this;
 }
 BigInt &BigInt::operator--() {
-  *this -= BigInt(1);
+  const bit_type one = 1;
+  addSigned(&one, 1, true);
   return *this;
 }
 BigInt BigInt::operator--(int) {
@@ -114,18 +188,47 @@ BigInt BigInt::operator--(int) {
 }
 
 BigInt BigInt::operator*(const BigInt& other) const {
+  if (this == &other || bits == other.bits) {
+    BigInt result = square();
+    return (negative() == other.negative())? result: -result;
+  }
   BigInt result = unsignedMultiplication(bits, other.bits);
   return (negative() == other.negative())? result: -result;
 }
 BigInt &BigInt::operator*=(const BigInt& other) {
-  *this = *this * other;
+  bool resultNegative = negative() != other.negative();
+  int n = bits.size(), m = other.bits.size();
+  // the product lands in the scratch buffer and the old limbs become the next scratch buffer;
+  // moving it out first keeps a nested *= from clobbering it
+  bit_vector product = std::move(scratchLimbs());
+  product.assign(n + m, 0);
+  multiplyLimbs(bits.data(), n, other.bits.data(), m, product.data());
+  std::swap(bits, product);
+  scratchLimbs() = std::move(product);
+  isPositive = !resultNegative;
+  repairBits();
   return *this;
 }
+BigInt BigInt::square() const {
+  return unsignedMultiplication(bits, bits);
+}
+BigInt &BigInt::addmul(const BigInt& b, const BigInt& c) {
+  return multiplyAccumulate(b, c, false);
+}
+BigInt &BigInt::submul(const BigInt& b, const BigInt& c) {
+  return multiplyAccumulate(b, c, true);
+}
 
-BigInt BigInt::operator/(const BigInt& other) const {
+std::pair<BigInt, BigInt> BigInt::divmod(const BigInt& other) const {
   if (other.zero()) throw std::runtime_error("Division By 0 in BigInt");
-  BigInt result = unsignedDivision(bits, other.bits).first;
-  return (negative() == other.negative())? result: -result;
+  auto [quotient, remainder] = unsignedDivision(bits, other.bits);
+  if (negative() != other.negative()) quotient = -quotient;
+  if (negative()) remainder = -remainder;
+  return std::pair<BigInt, BigInt>(std::move(quotient), std::move(remainder));
+}
+
+BigInt BigInt::operator/(const BigInt& other) const {
+  return divmod(other).first;
 }
 BigInt &BigInt::operator/=(const BigInt& other) {
   *this = *this / other;
@@ -134,8 +237,7 @@ BigInt &BigInt::operator/=(const BigInt& other) {
 
 BigInt BigInt::operator%(const BigInt& other) const {
   if (other.zero()) throw std::runtime_error("Modulo By 0 in BigInt");
-  BigInt result = unsignedDivision(bits, other.bits).second;
-  return negative()? -result: result;
+  return divmod(other).second;
 }
 BigInt &BigInt::operator%=(const BigInt& other) {
  *this = *this % other;
@@ -148,99 +250,404 @@ BigInt &BigInt::operator%=(const BigInt& other) {
 
 BigInt BigInt::unsignedAddition(const bit_vector& a, const bit_vector& b) const {
   PROFILE_START("Add");
-  bit_vector result;
-  int n = a.size(); int m = b.size();
+  const bit_vector& longer = (a.size() >= b.size())? a: b;
+  const bit_vector& shorter = (a.size() >= b.size())? b: a;
+  int n = longer.size(); int m = shorter.size();
+  bit_vector result(n + 1);
   bit_type carry = 0;
-  for (int i = 0; i < std::max(n, m) || carry; ++i) {
-    bit_type first = (i < n)? a[i]: 0;
-    bit_type second = (i < m)? b[i]: 0;
-    bit_type sum = first + second + carry;
-    result.push_back(sum % BIT_SIZE);
-    carry = sum / BIT_SIZE;
+  for (int i = 0; i < m; ++i) {
+    double_bit_type sum = static_cast<double_bit_type>(longer[i]) + shorter[i] + carry;
+    result[i] = static_cast<bit_type>(sum);
+    carry = static_cast<bit_type>(sum >> BASE);
   }
+  for (int i = m; i < n; ++i) {
+    result[i] = longer[i] + carry;
+    carry = (result[i] < carry);
+  }
+  result[n] = carry;
   PROFILE_END("Add");
   return result;
 }
 
+// requires |a| >= |b|
 BigInt BigInt::unsignedSubtraction(const bit_vector& a, const bit_vector& b) const {
   PROFILE_START("Subtract");
-  bit_vector result;
   int n = a.size(); int m = b.size();
-  signed_bit_type carry = 0;
+  bit_vector result(n);
+  bit_type borrow = 0;
   for (int i = 0; i < n; ++i) {
-    signed_bit_type first = a[i];
-    signed_bit_type second = (i < m)? b[i]: 0;
-    signed_bit_type diff = first - second - carry;
-
-    if (diff < 0) {
-      diff += BIT_SIZE;
-      carry = 1;
-    } else {
-      carry = 0;
-    }
-    result.push_back(diff);
+    bit_type second = (i < m)? b[i]: 0;
+    bit_type diff = a[i] - second - borrow;
+    borrow = (a[i] < second) || (a[i] - second < borrow);
+    result[i] = diff;
   }
   PROFILE_END("Subtract");
   return result;
 }
 
-// BigInt BigInt::unsignedMultiplication(const bit_vector& a, const bit_vector& b) const {
-//   BigInt result = 0;
-//   BigInt first = a;
-//   for (int i = 0; i < b.size(); ++i) {
-//     bit_type bit = b[i];
-//     bit_type power = 1 << (BASE-1);
-//     signed_bit_type exp = BASE-1;
-//     while (exp >= 0) {
-//       if (bit >= power) {
-//         bit -= power;
-//         result += first.binaryScaleUp(BASE*i + exp);
-//       }
-//       --exp;
-//       power /= 2;
-//     }
-//   }
-//   return result;
-// }
-
 BigInt BigInt::unsignedMultiplication(const bit_vector& a, const bit_vector& b) const {
   PROFILE_START("Multiply");
-  // Algorithm from Knuth's TAOCP Volume 2, pg. 268
   int m = a.size(); int n = b.size();
   bit_vector result(m+n, 0);
+  multiplyLimbs(a.data(), m, b.data(), n, result.data());
+  PROFILE_END("Multiply");
+  return result;
+}
+
+void BigInt::multiplyLimbs(const bit_type* a, int n, const bit_type* b, int m, bit_type* out) {
+  if (n < m) {
+    std::swap(a, b);
+    std::swap(n, m);
+  }
+  if (m == 0) return;
+  bool square = (a == b && n == m);
+  if (m < KARATSUBA_THRESHOLD) {
+    if (square) schoolbookSquare(a, n, out);
+    else schoolbookMultiply(a, n, b, m, out);
+  } else if (m >= NTT_THRESHOLD && nttSupports(n, m)) {
+    nttMultiply(a, n, b, m, out);
+  } else if (n >= 2*m) {
+    // unbalanced: multiply b by m-limb chunks of a so every product is balanced
+    bit_vector chunk(2*m);
+    for (int i = 0; i < n; i += m) {
+      int length = std::min(m, n - i);
+      std::fill(chunk.begin(), chunk.end(), 0);
+      multiplyLimbs(a + i, length, b, m, chunk.data());
+      addLimbs(out, n + m, i, chunk.data(), length + m);
+    }
+  } else if (m < TOOM3_THRESHOLD) {
+    karatsubaMultiply(a, n, b, m, out);
+  } else {
+    toomCook3Multiply(a, n, b, m, out);
+  }
+}
 
+void BigInt::schoolbookMultiply(const bit_type* a, int m, const bit_type* b, int n, bit_type* out) {
+  // Algorithm from Knuth's TAOCP Volume 2, pg. 268
   for (int j = 0; j < n; ++j) {
     bit_type carry = 0;
     for (int i = 0; i < m; ++i) {
-      signed_bit_type t = (a[i] * b[j]) + result[i+j] + carry;
-      result[i+j] = t % BIT_SIZE;
-      carry = t / BIT_SIZE;
+      // fits in 128 bits: (2^64 - 1)^2 + 2 * (2^64 - 1) == 2^128 - 1
+      double_bit_type t = static_cast<double_bit_type>(a[i]) * b[j] + out[i+j] + carry;
+      out[i+j] = static_cast<bit_type>(t);
+      carry = static_cast<bit_type>(t >> BASE);
     }
-    result[j+m] = carry;
+    out[j+m] = carry;
+  }
+}
+
+void BigInt::schoolbookSquare(const bit_type* a, int n, bit_type* out) {
+  // each cross product a[i]*a[j], i < j, is computed once and doubled with a shift
+  for (int i = 0; i < n; ++i) {
+    bit_type carry = 0;
+    for (int j = i + 1; j < n; ++j) {
+      double_bit_type t = static_cast<double_bit_type>(a[i]) * a[j] + out[i+j] + carry;
+      out[i+j] = static_cast<bit_type>(t);
+      carry = static_cast<bit_type>(t >> BASE);
+    }
+    out[i+n] = carry;
+  }
+  bit_type shifted = 0;
+  for (int i = 0; i < 2*n; ++i) {
+    bit_type next = out[i] >> (BASE - 1);
+    out[i] = (out[i] << 1) | shifted;
+    shifted = next;
+  }
+  // then add the squares a[i]^2 on the diagonal
+  bit_type carry = 0;
+  for (int i = 0; i < n; ++i) {
+    double_bit_type sq = static_cast<double_bit_type>(a[i]) * a[i];
+    double_bit_type low = static_cast<double_bit_type>(out[2*i]) + static_cast<bit_type>(sq) + carry;
+    out[2*i] = static_cast<bit_type>(low);
+    double_bit_type high = static_cast<double_bit_type>(out[2*i+1]) + static_cast<bit_type>(sq >> BASE) + static_cast<bit_type>(low >> BASE);
+    out[2*i+1] = static_cast<bit_type>(high);
+    carry = static_cast<bit_type>(high >> BASE);
+  }
+}
+
+void BigInt::karatsubaMultiply(const bit_type* a, int n, const bit_type* b, int m, bit_type* out) {
+  // a = a1 * B^h + a0, b = b1 * B^h + b0 with n >= m > n/2, so b1 may be shorter than a1
+  int h = (n + 1) / 2;
+  int bLow = std::min(h, m);
+  bool square = (a == b && n == m);
+
+  // z0 = a0 * b0 in out[0, 2h) and z2 = a1 * b1 in out[2h, n + m)
+  multiplyLimbs(a, h, square? a: b, bLow, out);
+  if (m > h) multiplyLimbs(a + h, n - h, square? a + h: b + h, m - h, out + 2*h);
+
+  auto sum = [h](const bit_type* x, int size) {
+    bit_vector s(x, x + std::min(h, size));
+    s.resize(h + 1, 0);
+    if (size > h) addLimbs(s.data(), h + 1, 0, x + h, size - h);
+    while (s.size() > 1 && s.back() == 0) s.pop_back();
+    return s;
+  };
+  bit_vector sa = sum(a, n);
+  bit_vector sb = square? sa: sum(b, m);
+
+  // z1 = (a0 + a1)(b0 + b1) - z0 - z2
+  bit_vector z1(sa.size() + sb.size(), 0);
+  multiplyLimbs(sa.data(), sa.size(), square? sa.data(): sb.data(), sb.size(), z1.data());
+  auto subtract = [&z1](const bit_type* x, int size) {
+    bit_type borrow = 0;
+    for (int i = 0; i < static_cast<int>(z1.size()); ++i) {
+      bit_type second = (i < size)? x[i]: 0;
+      if (i >= size && borrow == 0) break;
+      bit_type diff = z1[i] - second - borrow;
+      borrow = (z1[i] < second) || (z1[i] - second < borrow);
+      z1[i] = diff;
+    }
+  };
+  subtract(out, h + bLow);
+  if (m > h) subtract(out + 2*h, n + m - 2*h);
+  int z1Size = z1.size();
+  while (z1Size > 0 && z1[z1Size-1] == 0) --z1Size;
+  addLimbs(out, n + m, h, z1.data(), z1Size);
+}
+
+void BigInt::toomCook3Multiply(const bit_type* a, int n, const bit_type* b, int m, bit_type* out) {
+  // Toom-3 with evaluation points 0, 1, -1, -2, infinity and Bodrato's interpolation sequence.
+  // Evaluations can be negative, so this tier works on signed BigInts.
+  int k = (n + 2) / 3;
+  bool square = (a == b && n == m);
+  auto part = [k](const bit_type* x, int size, int i) {
+    int start = std::min(i*k, size), end = std::min((i+1)*k, size);
+    return BigInt(bit_vector(x + start, x + end));
+  };
+  auto evaluate = [](const BigInt& x0, const BigInt& x1, const BigInt& x2) {
+    BigInt p = x0 + x2;
+    BigInt at1 = p + x1;
+    BigInt atMinus1 = p - x1;
+    BigInt atMinus2 = (atMinus1 + x2).twice() - x0;
+    return std::array<BigInt, 3>{at1, atMinus1, atMinus2};
+  };
+  auto multiply = [square](const BigInt& x, const BigInt& y) { return square? x.square(): x * y; };
+
+  BigInt a0 = part(a, n, 0), a1 = part(a, n, 1), a2 = part(a, n, 2);
+  BigInt b0 = square? a0: part(b, m, 0), b1 = square? a1: part(b, m, 1), b2 = square? a2: part(b, m, 2);
+  auto [pa1, paMinus1, paMinus2] = evaluate(a0, a1, a2);
+  auto [pb1, pbMinus1, pbMinus2] = square? std::array<BigInt, 3>{pa1, paMinus1, paMinus2}: evaluate(b0, b1, b2);
+
+  BigInt r0 = multiply(a0, b0);
+  BigInt r1 = multiply(pa1, pb1);
+  BigInt rMinus1 = multiply(paMinus1, pbMinus1);
+  BigInt rMinus2 = multiply(paMinus2, pbMinus2);
+  BigInt rInf = multiply(a2, b2);
+
+  // the divisions by 3 and 2 are exact
+  BigInt r3 = (rMinus2 - r1) / BigInt(3);
+  r1 = (r1 - rMinus1).half();
+  BigInt r2 = rMinus1 - r0;
+  r3 = (r2 - r3).half() + rInf.twice();
+  r2 = r2 + r1 - rInf;
+  r1 = r1 - r3;
+
+  // the coefficients of the product are non-negative, so they add straight into out
+  const BigInt* coefficients[] = {&r0, &r1, &r2, &r3, &rInf};
+  for (int i = 0; i < 5; ++i) {
+    const BigInt& c = *coefficients[i];
+    if (!c.zero()) addLimbs(out, n + m, i*k, c.bits.data(), c.bits.size());
+  }
+}
+
+void BigInt::addLimbs(bit_type* out, int outSize, int offset, const bit_type* src, int srcSize) {
+  bit_type carry = 0;
+  int i = 0;
+  for (; i < srcSize && offset + i < outSize; ++i) {
+    double_bit_type t = static_cast<double_bit_type>(out[offset+i]) + src[i] + carry;
+    out[offset+i] = static_cast<bit_type>(t);
+    carry = static_cast<bit_type>(t >> BASE);
+  }
+  for (; carry != 0 && offset + i < outSize; ++i) {
+    out[offset+i] += carry;
+    carry = (out[offset+i] == 0);
+  }
+}
+
+// In-place Operations
+
+BigInt &BigInt::multiplyAccumulate(const BigInt& b, const BigInt& c, bool subtract) {
+  bool productNegative = (b.negative() != c.negative()) != subtract;
+  const BigInt& longer = (b.bits.size() >= c.bits.size())? b: c;
+  const BigInt& shorter = (b.bits.size() >= c.bits.size())? c: b;
+  if (shorter.bits.size() == 1 && &longer != this && (productNegative == negative() || zero())) {
+    // the magnitudes add: multiply-accumulate the single limb straight into bits
+    bool wasZero = zero();
+    bit_type multiplier = shorter.bits[0];
+    int m = longer.bits.size();
+    if (static_cast<int>(bits.size()) < m) bits.resize(m, 0);
+    bit_type carry = 0;
+    for (int i = 0; i < m; ++i) {
+      double_bit_type t = static_cast<double_bit_type>(longer.bits[i]) * multiplier + bits[i] + carry;
+      bits[i] = static_cast<bit_type>(t);
+      carry = static_cast<bit_type>(t >> BASE);
+    }
+    for (int i = m; carry != 0 && i < static_cast<int>(bits.size()); ++i) {
+      bits[i] += carry;
+      carry = (bits[i] < carry);
+    }
+    if (carry != 0) bits.push_back(carry);
+    if (wasZero) isPositive = !productNegative;
+    repairBits();
+    return *this;
+  }
+
+  int n = b.bits.size(), m = c.bits.size();
+  bit_vector product = std::move(scratchLimbs());
+  product.assign(n + m, 0);
+  multiplyLimbs(b.bits.data(), n, c.bits.data(), m, product.data());
+  int size = n + m;
+  while (size > 1 && product[size-1] == 0) --size;
+  addSigned(product.data(), size, productNegative);
+  scratchLimbs() = std::move(product);
+  return *this;
+}
+
+void BigInt::addSigned(const bit_type* b, int m, bool bNegative) {
+  if (negative() == bNegative) {
+    addMagnitude(b, m);
+  } else if (!compareBitMagnitude(bits.data(), bits.size(), b, m)) {
+    subtractMagnitude(b, m); // |this| >= |b| keeps the sign of this
+  } else {
+    subtractFromMagnitude(b, m);
+    isPositive = !bNegative;
+  }
+  repairBits();
+}
+
+void BigInt::addMagnitude(const bit_type* b, int m) {
+  // when b aliases bits the sizes match, so bits is not reallocated until the final push_back
+  if (static_cast<int>(bits.size()) < m) bits.resize(m, 0);
+  int n = bits.size();
+  bit_type carry = 0;
+  int i = 0;
+  for (; i < m; ++i) {
+    bit_type sum = bits[i] + b[i];
+    bit_type overflow = (sum < b[i]);
+    bits[i] = sum + carry;
+    carry = overflow | (bits[i] < carry);
+  }
+  for (; carry != 0 && i < n; ++i) carry = (++bits[i] == 0);
+  if (carry != 0) bits.push_back(1);
+}
+
+void BigInt::subtractMagnitude(const bit_type* b, int m) {
+  int n = bits.size();
+  bit_type borrow = 0;
+  int i = 0;
+  for (; i < m; ++i) {
+    bit_type second = b[i];
+    bit_type diff = bits[i] - second - borrow;
+    borrow = (bits[i] < second) || (bits[i] - second < borrow);
+    bits[i] = diff;
+  }
+  for (; borrow != 0 && i < n; ++i) borrow = (bits[i]-- == 0);
+}
+
+void BigInt::subtractFromMagnitude(const bit_type* b, int m) {
+  bits.resize(m, 0);
+  bit_type borrow = 0;
+  for (int i = 0; i < m; ++i) {
+    bit_type first = b[i];
+    bit_type diff = first - bits[i] - borrow;
+    borrow = (first < bits[i]) || (first - bits[i] < borrow);
+    bits[i] = diff;
   }
-  PROFILE_END("Multiply");
-  return result;
 }
 
 std::pair<BigInt, BigInt> BigInt::unsignedDivision(const bit_vector& a, const bit_vector& b) const {
   PROFILE_START("Divide");
-  BigInt quotient = 0;
-  BigInt remainder = 0;
-  BigInt bitsize = BIT_SIZE;
-  int m = a.size();
-  for (int i = m-1; i >= 0; --i) {
-    // quotient *= bitsize;
-    quotient = quotient.binaryScaleUp(BASE);
-    // remainder *= bitsize;
-    remainder = remainder.binaryScaleUp(BASE);
-    remainder += BigInt(a[i]);
-    while (remainder >= b) {
-      remainder -= b;
-      ++quotient;
+  if (compareBitMagnitude(a, b)) {
+    PROFILE_END("Divide");
+    return std::pair<BigInt, BigInt>(BigInt(0), BigInt(a));
+  }
+  if (b.size() == 1) {
+    bit_vector quotient = a;
+    bit_type remainder = divideBySmall(quotient, b[0]);
+    PROFILE_END("Divide");
+    return std::pair<BigInt, BigInt>(BigInt(std::move(quotient)), BigInt(remainder));
+  }
+
+  // Knuth's TAOCP Volume 2, Algorithm 4.3.1D. Normalize so the divisor's top limb has its high
+  // bit set, which keeps every estimated quotient limb at most 2 too large.
+  int n = b.size(), m = a.size() - b.size();
+  int shift = std::countl_zero(b.back());
+  bit_vector v(n), u(a.size() + 1);
+  for (int i = n - 1; i > 0; --i) v[i] = (b[i] << shift) | (shift ? b[i-1] >> (BASE - shift) : 0);
+  v[0] = b[0] << shift;
+  u[a.size()] = shift ? a.back() >> (BASE - shift) : 0;
+  for (int i = a.size() - 1; i > 0; --i) u[i] = (a[i] << shift) | (shift ? a[i-1] >> (BASE - shift) : 0);
+  u[0] = a[0] << shift;
+
+  bit_vector quotient(m + 1, 0);
+  for (int j = m; j >= 0; --j) {
+    // estimate the quotient limb from the top two limbs of the remainder, then refine it
+    // with the divisor's second limb
+    double_bit_type numerator = (static_cast<double_bit_type>(u[j+n]) << BASE) | u[j+n-1];
+    double_bit_type qhat = numerator / v[n-1];
+    double_bit_type rhat = numerator % v[n-1];
+    while ((qhat >> BASE) != 0 || qhat * v[n-2] > ((rhat << BASE) | u[j+n-2])) {
+      --qhat;
+      rhat += v[n-1];
+      if ((rhat >> BASE) != 0) break;
+    }
+
+    // u[j, j + n] -= qhat * v
+    bit_type carry = 0, borrow = 0;
+    for (int i = 0; i < n; ++i) {
+      double_bit_type product = static_cast<double_bit_type>(static_cast<bit_type>(qhat)) * v[i] + carry;
+      carry = static_cast<bit_type>(product >> BASE);
+      bit_type low = static_cast<bit_type>(product);
+      bit_type diff = u[i+j] - low;
+      bit_type nextBorrow = (u[i+j] < low);
+      nextBorrow += (diff < borrow);
+      u[i+j] = diff - borrow;
+      borrow = nextBorrow;
     }
+    double_bit_type owed = static_cast<double_bit_type>(carry) + borrow;
+    bool negative = u[j+n] < owed;
+    u[j+n] -= static_cast<bit_type>(owed);
+
+    // qhat was one too large (probability about 2 / 2^64): add the divisor back
+    if (negative) {
+      --qhat;
+      bit_type addCarry = 0;
+      for (int i = 0; i < n; ++i) {
+        double_bit_type sum = static_cast<double_bit_type>(u[i+j]) + v[i] + addCarry;
+        u[i+j] = static_cast<bit_type>(sum);
+        addCarry = static_cast<bit_type>(sum >> BASE);
+      }
+      u[j+n] += addCarry;
+    }
+    quotient[j] = static_cast<bit_type>(qhat);
   }
+
+  // unnormalize the remainder held in u[0, n)
+  bit_vector remainder(n);
+  for (int i = 0; i < n; ++i) remainder[i] = (u[i] >> shift) | (shift ? u[i+1] << (BASE - shift) : 0);
   PROFILE_END("Divide");
-  return std::pair<BigInt, BigInt>(quotient, remainder);
+  return std::pair<BigInt, BigInt>(BigInt(std::move(quotient)), BigInt(std::move(remainder)));
+}
+
+void BigInt::multiplyAddSmall(bit_vector& a, bit_type multiplier, bit_type addend) {
+  bit_type carry = addend;
+  for (auto& limb : a) {
+    double_bit_type t = static_cast<double_bit_type>(limb) * multiplier + carry;
+    limb = static_cast<bit_type>(t);
+    carry = static_cast<bit_type>(t >> BASE);
+  }
+  if (carry != 0) a.push_back(carry);
+}
+
+BigInt::bit_type BigInt::divideBySmall(bit_vector& a, bit_type divisor) {
+  double_bit_type remainder = 0;
+  for (auto it = a.rbegin(); it != a.rend(); ++it) {
+    double_bit_type current = (remainder << BASE) | *it;
+    *it = static_cast<bit_type>(current / divisor);
+    remainder = current % divisor;
+  }
+  while (a.size() > 1 && a.back() == 0) a.pop_back();
+  return static_cast<bit_type>(remainder);
 }
 
 
@@ -256,20 +663,13 @@ BigInt BigInt::binaryScaleDown(int k) const {
   PROFILE_START("ScaleDown");
   int shiftedBits = k % BASE;
   int removeBits = k / BASE;
-  bit_vector newBits = bits;
-  for (int i = 0; i < removeBits && !newBits.empty(); ++i) {
-    newBits.pop_front();
-  }
-  if (shiftedBits != 0) {
-    bit_type lastShifted = 0;
-    for (auto it = newBits.rbegin(); it != newBits.rend(); ++it) {
-      bit_type shifted = leastBits(*it, shiftedBits);
-      *it >>= shiftedBits;
-      *it |= (lastShifted << (BASE-shiftedBits));
-      lastShifted = shifted;
-    }
+  int n = bits.size();
+  bit_vector newBits(std::max(n - removeBits, 0));
+  for (int i = 0; i < static_cast<int>(newBits.size()); ++i) {
+    bit_type high = (i + removeBits + 1 < n && shiftedBits != 0)? bits[i + removeBits + 1] << (BASE - shiftedBits): 0;
+    newBits[i] = (bits[i + removeBits] >> shiftedBits) | high;
   }
-  BigInt result = newBits;
+  BigInt result = std::move(newBits);
   PROFILE_END("ScaleDown");
   return negative()? -result: result;
 }
@@ -277,29 +677,56 @@ BigInt BigInt::binaryScaleUp(int k) const {
   PROFILE_START("ScaleUp");
   int shiftedBits = k % BASE;
   int addBits = k / BASE;
-  bit_vector newBits = bits;
-
-  if (shiftedBits != 0) {
-    newBits.push_back(0);
-    bit_type lastShifted = 0;
-    for (auto it = newBits.begin(); it != newBits.end(); ++it) {
-      bit_type shifted = leastBits(*it >> (BASE - shiftedBits), shiftedBits);
-      *it <<= shiftedBits;
-      *it &= (BIT_SIZE - 1); // takes the first BASE bits
-      *it |= lastShifted;
-      lastShifted = shifted;
-    }
-  }
-  for (int i = 0; i < addBits; ++i) {
-    newBits.push_front(0);
+  int n = bits.size();
+  bit_vector newBits(n + addBits + 1, 0);
+  for (int i = 0; i < n; ++i) {
+    newBits[i + addBits] |= bits[i] << shiftedBits;
+    if (shiftedBits != 0) newBits[i + addBits + 1] = bits[i] >> (BASE - shiftedBits);
   }
-  BigInt result = newBits;
-  result.repairBits();
+  BigInt result = std::move(newBits);
   PROFILE_END("ScaleUp");
   return negative()? -result: result;
 }
+BigInt &BigInt::operator<<=(int k) {
+  if (zero()) return *this;
+  int shiftedBits = k % BASE;
+  int addBits = k / BASE;
+  int n = bits.size();
+  bits.resize(n + addBits + 1, 0);
+  // fill from the top so every source limb is read before it is overwritten
+  for (int i = n + addBits; i >= addBits; --i) {
+    int j = i - addBits;
+    bit_type high = (j < n)? bits[j] << shiftedBits: 0;
+    bit_type low = (shiftedBits != 0 && j > 0)? bits[j-1] >> (BASE - shiftedBits): 0;
+    bits[i] = high | low;
+  }
+  std::fill(bits.begin(), bits.begin() + addBits, 0);
+  repairBits();
+  return *this;
+}
+BigInt &BigInt::operator>>=(int k) {
+  int shiftedBits = k % BASE;
+  int removeBits = k / BASE;
+  int n = bits.size();
+  if (removeBits >= n) {
+    bits.assign(1, 0);
+    repairBits();
+    return *this;
+  }
+  for (int i = 0; i < n - removeBits; ++i) {
+    int j = i + removeBits;
+    bit_type high = (shiftedBits != 0 && j + 1 < n)? bits[j+1] << (BASE - shiftedBits): 0;
+    bits[i] = (bits[j] >> shiftedBits) | high;
+  }
+  bits.resize(n - removeBits);
+  repairBits();
+  return *this;
+}
 BigInt::bit_type BigInt::leastBits(bit_type num, int k) {
-  return num & ((1 << k) - 1); // watch
+  return (k >= BASE)? num: num & ((bit_type{1} << k) - 1);
+}
+int BigInt::bitLength() const {
+  return (bits.size() - 1) * BASE + (BASE - std::countl_zero(bits.back()));
 }
 bool BigInt::positive() const { return (isPositive && !zero()); }
 bool BigInt::negative() const { return !isPositive; }
@@ -340,51 +767,191 @@ std::strong_ordering BigInt::operator<=>(const BigInt& other) const {
 // 2) bits has no trialing 0s
 // The expected representation for 0 is a single 0 bit
 void BigInt::repairBits() {
-  if (bits.empty()) {
-    bits.push_back(0);
-    isPositive = true;
-  }
-  else {
-    while (!zero() && bits.back() == 0) bits.pop_back();
-  }
+  while (bits.size() > 1 && bits.back() == 0) bits.pop_back();
+  if (bits.empty()) bits.push_back(0);
+  if (bits.size() == 1 && bits.front() == 0) isPositive = true;
 }
 bool BigInt::compareBitMagnitude(const bit_vector& a, const bit_vector& b) {
-  return (a.size() < b.size()) || (a.size() == b.size() && std::lexicographical_compare(a.rbegin(), a.rend(), b.rbegin(), b.rend()));
+  return compareBitMagnitude(a.data(), a.size(), b.data(), b.size());
+}
+bool BigInt::compareBitMagnitude(const bit_type* a, int n, const bit_type* b, int m) {
+  if (n != m) return n < m;
+  for (int i = n - 1; i >= 0; --i) {
+    if (a[i] != b[i]) return a[i] < b[i];
+  }
+  return false;
 }
 
 // Output methods
 
 long long BigInt::toNum() const {
   PROFILE_START("ToNum");
-  long long result = 0;
-  for (auto it = bits.rbegin(); it != bits.rend(); ++it) {
-    // Shift the current result to the left by one position
-    result *= BIT_SIZE; // this might cause problems when BASE = 32 and outputting to an int
-    // If the current bit is set, OR it with the result 
-    result += *it;
-  }
-  if (negative()) result *= -1;
+  bit_type low = bits.front();
+  if (negative()) low = bit_type(0) - low;
   PROFILE_END("ToNum");
-  return result;
+  return static_cast<long long>(low);
 }
 
-std::string BigInt::toString() const {
+std::string BigInt::toString(int base) const {
+  // checked before profiling starts, so that throwing leaves no start without an end
+  if (base != 10 && powerOfTwoBits(base) == 0) throw std::invalid_argument("Unsupported base " + std::to_string(base));
   PROFILE_START("ToString");
-  std::string result = "";
-  BigInt tmp = *this;
-  BigInt radix = 10;
-  while (!tmp.zero()) {
-    int remainder = (tmp % radix).toNum();
-    tmp /= radix;
-    result.push_back('0'+remainder);
-  }
-  if (negative()) result.push_back('-');
-  std::reverse(result.begin(), result.end());
+  // bitLength * log10(2) + 1 bounds the decimal digits; smaller bases need no more than binary
+  int bound = 2 + (base == 10 ? static_cast<long long>(bitLength()) * 30103 / 100000 + 1 : std::max(bitLength(), 1));
+  std::string result(bound, '\0');
+  auto end = toChars(result.data(), result.data() + result.size(), base).ptr;
+  result.resize(end - result.data());
   PROFILE_END("ToString");
-  // profiler.results();
   return result;
 }
 
+std::to_chars_result BigInt::toChars(char* first, char* last, int base) const {
+  int shift = powerOfTwoBits(base);
+  if (base != 10 && shift == 0) return {first, std::errc::invalid_argument};
+  if (negative()) {
+    if (first == last) return {last, std::errc::value_too_large};
+    *first++ = '-';
+  }
+  if (zero()) {
+    if (first == last) return {last, std::errc::value_too_large};
+    *first = '0';
+    return {first + 1, std::errc()};
+  }
+
+  if (shift != 0) {
+    // each digit is a run of shift bits, possibly straddling two limbs
+    int digits = (bitLength() + shift - 1) / shift;
+    if (last - first < digits) return {last, std::errc::value_too_large};
+    for (int i = 0; i < digits; ++i) {
+      long long position = static_cast<long long>(digits - 1 - i) * shift;
+      int limb = position / BASE, offset = position % BASE;
+      bit_type digit = bits[limb] >> offset;
+      if (offset + shift > BASE && limb + 1 < static_cast<int>(bits.size())) digit |= bits[limb+1] << (BASE - offset);
+      first[i] = DIGIT_CHARACTERS[digit & (base - 1)];
+    }
+    return {first + digits, std::errc()};
+  }
+
+  // Decimal digits come out right to left, so write them right-aligned in a span of the upper
+  // bound bitLength * log10(2) + 1 and slide them down. The span only falls back to a scratch
+  // string when the caller's buffer is shorter than the bound.
+  int bound = static_cast<long long>(bitLength()) * 30103 / 100000 + 1;
+  // 10^(19 * 2^(level + 1)) > 2^(63 * 2^(level + 1)) > *this
+  int level = 0;
+  while ((static_cast<long long>(63) << (level + 1)) < bitLength()) ++level;
+  std::string scratch;
+  char* end = first + bound;
+  if (last - first < bound) {
+    scratch.resize(bound);
+    end = scratch.data() + bound;
+  }
+  char* start = writeDecimal(*this, end, 0, level, DecimalPowers::cached());
+  int digits = end - start;
+  if (last - first < digits) return {last, std::errc::value_too_large};
+  std::memmove(first, start, digits);
+  return {first + digits, std::errc()};
+}
+
+std::from_chars_result BigInt::fromChars(const char* first, const char* last, BigInt& value, int base) {
+  int shift = powerOfTwoBits(base);
+  if (base != 10 && shift == 0) return {first, std::errc::invalid_argument};
+  const char* digits = first;
+  bool negative = digits != last && *digits == '-';
+  if (negative) ++digits;
+  const char* end = digits;
+  while (end != last && digitValue(*end) < base) ++end;
+  if (end == digits) return {first, std::errc::invalid_argument};
+
+  BigInt result = 0;
+  if (shift == 0) {
+    result = parseDecimal(digits, end, DecimalPowers::cached());
+  } else {
+    // pack shift bits per digit, least significant digit first
+    int count = end - digits;
+    bit_vector packed((static_cast<long long>(count) * shift + BASE - 1) / BASE, 0);
+    for (int i = 0; i < count; ++i) {
+      bit_type digit = digitValue(end[-1 - i]);
+      long long position = static_cast<long long>(i) * shift;
+      int limb = position / BASE, offset = position % BASE;
+      packed[limb] |= digit << offset;
+      if (offset + shift > BASE) packed[limb+1] |= digit >> (BASE - offset);
+    }
+    result = BigInt(std::move(packed));
+  }
+  value = negative ? -result : std::move(result);
+  return {end, std::errc()};
+}
+
+// Radix conversion
+
+BigInt BigInt::parseDecimal(const char* first, const char* last, DecimalPowers& powers) {
+  int n = last - first;
+  if (n <= std::max<long long>(RADIX_SPLIT_THRESHOLD, 1) * DECIMAL_CHUNK_DIGITS) {
+    // the first chunk takes the leftover digits so every later chunk is exactly 19 digits
+    bit_vector result;
+    const char* chunkEnd = first + (n % DECIMAL_CHUNK_DIGITS ? n % DECIMAL_CHUNK_DIGITS : DECIMAL_CHUNK_DIGITS);
+    for (const char* start = first; start < last; start = chunkEnd, chunkEnd += DECIMAL_CHUNK_DIGITS) {
+      bit_type chunk = 0, scale = 1;
+      for (const char* c = start; c < chunkEnd; ++c) {
+        chunk = chunk * 10 + (*c - '0');
+        scale *= 10;
+      }
+      multiplyAddSmall(result, scale, chunk);
+    }
+    return BigInt(std::move(result));
+  }
+  // high * 10^(19 * 2^k) + low, splitting off the largest such block of low digits
+  int k = 0;
+  while ((DECIMAL_CHUNK_DIGITS << (k + 1)) < n) ++k;
+  const char* middle = last - (DECIMAL_CHUNK_DIGITS << k);
+  BigInt high = parseDecimal(first, middle, powers);
+  BigInt low = parseDecimal(middle, last, powers);
+  return high * powers[k] + low;
+}
+
+char* BigInt::writeDecimal(const BigInt& value, char* end, int width, int level, DecimalPowers& powers) {
+  // split by the largest power not above value, so the quotient is nonzero
+  while (level >= 0 && value < powers[level]) --level;
+  char* start = end;
+  if (level < 0 || static_cast<int>(value.bits.size()) <= RADIX_SPLIT_THRESHOLD) {
+    // peel off 19 decimal digits per single-limb division, leaving the top chunk unpadded
+    bit_vector rest = value.bits;
+    while (rest.size() > 1 || rest.front() != 0) {
+      bit_type chunk = divideBySmall(rest, DECIMAL_CHUNK);
+      bool top = (rest.size() == 1 && rest.front() == 0);
+      for (int i = 0; i < DECIMAL_CHUNK_DIGITS && (!top || chunk != 0); ++i, chunk /= 10) *--start = '0' + chunk % 10;
+    }
+  } else {
+    auto [quotient, remainder] = powers.divide(value, level);
+    start = writeDecimal(remainder, end, DECIMAL_CHUNK_DIGITS << level, level - 1, powers);
+    start = writeDecimal(quotient, start, 0, level - 1, powers);
+  }
+  while (end - start < width) *--start = '0';
+  return start;
+}
+
+BigInt BigInt::reciprocal(const BigInt& p, int bits) {
+  BigInt scale = BigInt(1).binaryScaleUp(2 * bits);
+  if (bits <= BARRETT_THRESHOLD * BASE) return scale / p;
+  // start from the reciprocal of p's top half, which is correct to about half the bits
+  int half = bits / 2 + 1;
+  int drop = bits - half;
+  BigInt x = reciprocal(p.binaryScaleDown(drop), half).binaryScaleUp(drop);
+  // one Newton step, x += x * (2^(2 * bits) - p * x) / 2^(2 * bits), doubles the correct bits
+  x += (x * (scale - p * x)).binaryScaleDown(2 * bits);
+  // then walk the last few units to the exact floor
+  BigInt error = scale - p * x;
+  while (error.negative()) {
+    --x;
+    error += p;
+  }
+  while (error >= p) {
+    ++x;
+    error -= p;
+  }
+  return x;
+}
+
 std::ostream &operator<<(std::ostream &out, const BigInt& num) {
   out << "Base 10: " << num.toNum();
   out << " - Bits: ";
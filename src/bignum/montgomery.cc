@@ -0,0 +1,276 @@
+#include "bignum/montgomery.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace BigNum {
+
+namespace {
+
+using limb = MontgomeryContext::limb;
+using wide = unsigned __int128;
+
+// per-thread scratch limbs, grown on demand and never shrunk
+limb* workspace(int size) {
+  thread_local std::vector<limb> scratch;
+  if (static_cast<int>(scratch.size()) < size) scratch.resize(size);
+  return scratch.data();
+}
+
+} // end anonymous namespace
+
+MontgomeryContext::MontgomeryContext(const BigInt& modulus) : modulusValue{modulus} {
+  if (modulus.negative() || modulus.even() || modulus.one()) {
+    throw std::invalid_argument("Montgomery modulus must be odd and greater than 1");
+  }
+  n = modulus.bits.size();
+  modulusLimbs = modulus.bits;
+
+  // Newton's iteration for modulus^-1 mod 2^64. An odd m is its own inverse mod 8, and each
+  // step doubles the number of correct low bits: 3, 6, 12, 24, 48, 96.
+  limb x = modulusLimbs[0];
+  for (int i = 0; i < 5; ++i) x *= 2 - modulusLimbs[0] * x;
+  inverse = limb(0) - x;
+
+  rModN = (BigInt(1).binaryScaleUp(64 * n) % modulus).bits;
+  rModN.resize(n, 0);
+  r2ModN = (BigInt(1).binaryScaleUp(128 * n) % modulus).bits;
+  r2ModN.resize(n, 0);
+}
+
+MontgomeryContext::Residue MontgomeryContext::toMontgomery(const BigInt& a) const {
+  BigInt reduced = a % modulusValue;
+  if (reduced.negative()) reduced += modulusValue;
+  Residue result = reduced.bits;
+  result.resize(n, 0);
+  mulmod(result.data(), r2ModN.data(), result.data());
+  return result;
+}
+
+BigInt MontgomeryContext::fromMontgomery(const limb* a) const {
+  // multiplying by a plain 1 divides out the R
+  Residue unit(n, 0);
+  unit[0] = 1;
+  mulmod(a, unit.data(), unit.data());
+  return BigInt(std::move(unit));
+}
+
+void MontgomeryContext::mulmod(const limb* a, const limb* b, limb* out) const {
+  limb* t = workspace(n + 2);
+  std::fill(t, t + n + 2, 0);
+  const limb* m = modulusLimbs.data();
+  for (int i = 0; i < n; ++i) {
+    // t += a * b[i]
+    limb carry = 0;
+    for (int j = 0; j < n; ++j) {
+      wide product = static_cast<wide>(a[j]) * b[i] + t[j] + carry;
+      t[j] = static_cast<limb>(product);
+      carry = static_cast<limb>(product >> 64);
+    }
+    wide sum = static_cast<wide>(t[n]) + carry;
+    t[n] = static_cast<limb>(sum);
+    t[n+1] = static_cast<limb>(sum >> 64);
+
+    // t = (t + q * m) / 2^64, with q chosen so the low limb cancels
+    limb q = t[0] * inverse;
+    wide reduced = static_cast<wide>(q) * m[0] + t[0];
+    carry = static_cast<limb>(reduced >> 64);
+    for (int j = 1; j < n; ++j) {
+      reduced = static_cast<wide>(q) * m[j] + t[j] + carry;
+      t[j-1] = static_cast<limb>(reduced);
+      carry = static_cast<limb>(reduced >> 64);
+    }
+    sum = static_cast<wide>(t[n]) + carry;
+    t[n-1] = static_cast<limb>(sum);
+    t[n] = t[n+1] + static_cast<limb>(sum >> 64);
+  }
+  finalSubtract(t, t[n], out);
+}
+
+void MontgomeryContext::sqrmod(const limb* a, limb* out) const {
+  limb* t = workspace(2 * n + 1);
+  std::fill(t, t + 2 * n + 1, 0);
+
+  // the cross products a[i] * a[j] for i < j, once each
+  for (int i = 0; i < n; ++i) {
+    limb carry = 0;
+    for (int j = i + 1; j < n; ++j) {
+      wide product = static_cast<wide>(a[i]) * a[j] + t[i+j] + carry;
+      t[i+j] = static_cast<limb>(product);
+      carry = static_cast<limb>(product >> 64);
+    }
+    t[i+n] = carry;
+  }
+  // double them, then add the squares on the diagonal
+  limb top = 0;
+  for (int k = 0; k < 2 * n; ++k) {
+    limb next = t[k] >> 63;
+    t[k] = (t[k] << 1) | top;
+    top = next;
+  }
+  limb carry = 0;
+  for (int i = 0; i < n; ++i) {
+    wide square = static_cast<wide>(a[i]) * a[i];
+    wide low = static_cast<wide>(t[2*i]) + static_cast<limb>(square) + carry;
+    t[2*i] = static_cast<limb>(low);
+    wide high = static_cast<wide>(t[2*i+1]) + static_cast<limb>(square >> 64) + static_cast<limb>(low >> 64);
+    t[2*i+1] = static_cast<limb>(high);
+    carry = static_cast<limb>(high >> 64);
+  }
+  reduce(t, out);
+}
+
+void MontgomeryContext::reduce(limb* t, limb* out) const {
+  // separated operand scanning: clear one low limb of t per pass by adding a multiple of m
+  const limb* m = modulusLimbs.data();
+  for (int i = 0; i < n; ++i) {
+    limb q = t[i] * inverse;
+    limb carry = 0;
+    for (int j = 0; j < n; ++j) {
+      wide product = static_cast<wide>(q) * m[j] + t[i+j] + carry;
+      t[i+j] = static_cast<limb>(product);
+      carry = static_cast<limb>(product >> 64);
+    }
+    for (int k = i + n; carry != 0 && k <= 2 * n; ++k) {
+      t[k] += carry;
+      carry = (t[k] < carry);
+    }
+  }
+  finalSubtract(t + n, t[2*n], out);
+}
+
+void MontgomeryContext::finalSubtract(const limb* t, limb carry, limb* out) const {
+  const limb* m = modulusLimbs.data();
+  bool atLeastModulus = (carry != 0);
+  if (!atLeastModulus) {
+    int i = n - 1;
+    while (i > 0 && t[i] == m[i]) --i;
+    atLeastModulus = (t[i] >= m[i]);
+  }
+  if (!atLeastModulus) {
+    std::copy(t, t + n, out);
+    return;
+  }
+  limb borrow = 0;
+  for (int i = 0; i < n; ++i) {
+    limb diff = t[i] - m[i] - borrow;
+    borrow = (t[i] < m[i]) || (t[i] - m[i] < borrow);
+    out[i] = diff;
+  }
+}
+
+void MontgomeryContext::addmod(const limb* a, const limb* b, limb* out) const {
+  limb* t = workspace(n);
+  limb carry = 0;
+  for (int i = 0; i < n; ++i) {
+    wide sum = static_cast<wide>(a[i]) + b[i] + carry;
+    t[i] = static_cast<limb>(sum);
+    carry = static_cast<limb>(sum >> 64);
+  }
+  finalSubtract(t, carry, out);
+}
+
+void MontgomeryContext::submod(const limb* a, const limb* b, limb* out) const {
+  limb borrow = 0;
+  for (int i = 0; i < n; ++i) {
+    limb diff = a[i] - b[i] - borrow;
+    borrow = (a[i] < b[i]) || (a[i] - b[i] < borrow);
+    out[i] = diff;
+  }
+  if (borrow == 0) return;
+  // wrapped below zero, so add n back
+  limb carry = 0;
+  for (int i = 0; i < n; ++i) {
+    wide sum = static_cast<wide>(out[i]) + modulusLimbs[i] + carry;
+    out[i] = static_cast<limb>(sum);
+    carry = static_cast<limb>(sum >> 64);
+  }
+}
+
+void MontgomeryContext::halve(const limb* a, limb* out) const {
+  // an odd a becomes the even a + n, whose half is below n
+  limb carry = 0;
+  if (a[0] & 1) {
+    for (int i = 0; i < n; ++i) {
+      wide sum = static_cast<wide>(a[i]) + modulusLimbs[i] + carry;
+      out[i] = static_cast<limb>(sum);
+      carry = static_cast<limb>(sum >> 64);
+    }
+  } else {
+    std::copy(a, a + n, out);
+  }
+  for (int i = 0; i < n - 1; ++i) out[i] = (out[i] >> 1) | (out[i+1] << 63);
+  out[n-1] = (out[n-1] >> 1) | (carry << 63);
+}
+
+int MontgomeryContext::windowBits(int exponentBits) {
+  // the width that balances the 2^(k-1) table entries against the multiplications they save
+  if (exponentBits <= 8) return 1;
+  if (exponentBits <= 24) return 2;
+  if (exponentBits <= 80) return 3;
+  if (exponentBits <= 240) return 4;
+  if (exponentBits <= 672) return 5;
+  if (exponentBits <= 1792) return 6;
+  return 7;
+}
+
+void MontgomeryContext::powmod(const limb* base, const BigInt& exponent, limb* out) const {
+  if (exponent.negative()) throw std::invalid_argument("Negative exponent in powmod");
+  if (exponent.zero()) {
+    std::copy(rModN.begin(), rModN.end(), out);
+    return;
+  }
+  int bits = exponent.bitLength();
+  int k = windowBits(bits);
+
+  // table[i] = base^(2i + 1); base is copied first since out may alias it
+  Residue table((std::size_t{1} << (k - 1)) * n);
+  std::copy(base, base + n, table.begin());
+  if (k > 1) {
+    sqrmod(table.data(), out);
+    for (std::size_t i = n; i < table.size(); i += n) mulmod(table.data() + i - n, out, table.data() + i);
+  }
+
+  auto bit = [&exponent](int i) { return static_cast<int>((exponent.bits[i / 64] >> (i % 64)) & 1); };
+  bool started = false;
+  for (int i = bits - 1; i >= 0;) {
+    if (!bit(i)) {
+      sqrmod(out, out);
+      --i;
+      continue;
+    }
+    // the longest window [low, i] of at most k bits that ends in a set bit
+    int low = std::max(i - k + 1, 0);
+    while (!bit(low)) ++low;
+    int value = 0;
+    for (int j = i; j >= low; --j) value = (value << 1) | bit(j);
+    const limb* power = table.data() + static_cast<std::size_t>(value >> 1) * n;
+    if (!started) {
+      std::copy(power, power + n, out);
+      started = true;
+    } else {
+      for (int j = low; j <= i; ++j) sqrmod(out, out);
+      mulmod(out, power, out);
+    }
+    i = low - 1;
+  }
+}
+
+BigInt MontgomeryContext::mulmod(const BigInt& a, const BigInt& b) const {
+  // (a R) * b / R = a b, so only one operand needs converting
+  Residue x = toMontgomery(a);
+  BigInt reduced = b % modulusValue;
+  if (reduced.negative()) reduced += modulusValue;
+  Residue y = reduced.bits;
+  y.resize(n, 0);
+  mulmod(x.data(), y.data(), x.data());
+  return BigInt(std::move(x));
+}
+
+BigInt MontgomeryContext::powmod(const BigInt& base, const BigInt& exponent) const {
+  Residue x = toMontgomery(base);
+  powmod(x.data(), exponent, x.data());
+  return fromMontgomery(x);
+}
+
+} // end namespace BigNum
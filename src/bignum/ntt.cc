@@ -0,0 +1,155 @@
+#include "bignum/ntt.h"
+
+#include <vector>
+#include <bit>
+#include <utility>
+#include <cstddef>
+
+namespace BigNum {
+
+namespace {
+
+constexpr int DIGIT_BITS = 32;
+constexpr int DIGITS_PER_LIMB = 64 / DIGIT_BITS;
+
+// primes below 2^31 of the form c * 2^k + 1, with a primitive root each; all three support
+// transforms up to 2^25, and their product (~2^92.6) bounds every coefficient of a 32-bit digit
+// convolution of that length (< 2^25 * 2^64)
+constexpr uint32_t PRIME1 = 2013265921;  // 15 * 2^27 + 1, root 31
+constexpr uint32_t PRIME2 = 1811939329;  // 27 * 2^26 + 1, root 13
+constexpr uint32_t PRIME3 = 2113929217;  // 63 * 2^25 + 1, root 5
+
+template <uint32_t MOD>
+constexpr uint32_t primitiveRoot() {
+  if constexpr (MOD == PRIME1) return 31;
+  else if constexpr (MOD == PRIME2) return 13;
+  else return 5;
+}
+
+template <uint32_t MOD>
+constexpr uint32_t power(uint64_t base, uint64_t exponent) {
+  uint64_t result = 1;
+  base %= MOD;
+  for (; exponent != 0; exponent >>= 1) {
+    if (exponent & 1) result = result * base % MOD;
+    base = base * base % MOD;
+  }
+  return result;
+}
+
+template <uint32_t MOD>
+constexpr uint32_t inverse(uint64_t x) {
+  return power<MOD>(x, MOD - 2);
+}
+
+// Shoup's precomputed-quotient multiplication: with wShoup = floor(w * 2^32 / MOD), x * w mod MOD
+// needs two multiplications and no division. The result is in [0, 2 * MOD).
+template <uint32_t MOD>
+uint32_t mulShoup(uint32_t x, uint32_t w, uint32_t wShoup) {
+  uint32_t quotient = (static_cast<uint64_t>(x) * wShoup) >> 32;
+  return x * w - quotient * MOD;
+}
+
+// In-place iterative radix-2 transform over [0, MOD); 2 * MOD < 2^32 so sums never overflow
+template <uint32_t MOD>
+void transform(std::vector<uint32_t>& a, bool invert) {
+  int n = a.size();
+  for (int i = 1, j = 0; i < n; ++i) {
+    int bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) std::swap(a[i], a[j]);
+  }
+
+  std::vector<uint32_t> twiddles(n / 2), shoup(n / 2);
+  for (int length = 2; length <= n; length <<= 1) {
+    uint32_t root = power<MOD>(primitiveRoot<MOD>(), (MOD - 1) / length);
+    if (invert) root = inverse<MOD>(root);
+    int half = length / 2;
+    twiddles[0] = 1;
+    for (int k = 1; k < half; ++k) twiddles[k] = static_cast<uint64_t>(twiddles[k-1]) * root % MOD;
+    for (int k = 0; k < half; ++k) shoup[k] = (static_cast<uint64_t>(twiddles[k]) << 32) / MOD;
+
+    for (int start = 0; start < n; start += length) {
+      uint32_t* low = a.data() + start;
+      uint32_t* high = low + half;
+      for (int k = 0; k < half; ++k) {
+        uint32_t u = low[k];
+        uint32_t v = mulShoup<MOD>(high[k], twiddles[k], shoup[k]);
+        if (v >= MOD) v -= MOD;
+        low[k] = (u + v >= MOD)? u + v - MOD: u + v;
+        high[k] = (u >= v)? u - v: u + MOD - v;
+      }
+    }
+  }
+
+  if (invert) {
+    uint32_t nInverse = inverse<MOD>(n);
+    for (auto& x : a) x = static_cast<uint64_t>(x) * nInverse % MOD;
+  }
+}
+
+// splits limbs into digits and reduces them into [0, MOD)
+template <uint32_t MOD>
+std::vector<uint32_t> toDigits(const uint64_t* limbs, int n, int size) {
+  std::vector<uint32_t> digits(size, 0);
+  for (int i = 0; i < n; ++i) {
+    for (int d = 0; d < DIGITS_PER_LIMB; ++d) digits[i * DIGITS_PER_LIMB + d] = static_cast<uint32_t>(limbs[i] >> (d * DIGIT_BITS)) % MOD;
+  }
+  return digits;
+}
+
+// cyclic convolution of a and b modulo MOD; b is ignored when squaring
+template <uint32_t MOD>
+std::vector<uint32_t> convolve(const uint64_t* a, int n, const uint64_t* b, int m, int size, bool square) {
+  std::vector<uint32_t> x = toDigits<MOD>(a, n, size);
+  transform<MOD>(x, false);
+  if (square) {
+    for (auto& digit : x) digit = static_cast<uint64_t>(digit) * digit % MOD;
+  } else {
+    std::vector<uint32_t> y = toDigits<MOD>(b, m, size);
+    transform<MOD>(y, false);
+    for (std::size_t i = 0; i < x.size(); ++i) x[i] = static_cast<uint64_t>(x[i]) * y[i] % MOD;
+  }
+  transform<MOD>(x, true);
+  return x;
+}
+
+} // end anonymous namespace
+
+bool nttSupports(int n, int m) {
+  return static_cast<long long>(n + m) * DIGITS_PER_LIMB <= NTT_MAX_LENGTH;
+}
+
+void nttMultiply(const uint64_t* a, int n, const uint64_t* b, int m, uint64_t* out) {
+  bool square = (a == b && n == m);
+  int size = std::bit_ceil(static_cast<unsigned>((n + m) * DIGITS_PER_LIMB));
+  std::vector<uint32_t> r1 = convolve<PRIME1>(a, n, b, m, size, square);
+  std::vector<uint32_t> r2 = convolve<PRIME2>(a, n, b, m, size, square);
+  std::vector<uint32_t> r3 = convolve<PRIME3>(a, n, b, m, size, square);
+
+  // Garner: c = x1 + PRIME1 * x2 + PRIME1 * PRIME2 * x3, exact since every coefficient is
+  // below the product of the primes
+  constexpr uint64_t inverse1Mod2 = inverse<PRIME2>(PRIME1);
+  constexpr uint64_t inverse1Mod3 = inverse<PRIME3>(PRIME1);
+  constexpr uint64_t inverse2Mod3 = inverse<PRIME3>(PRIME2);
+  constexpr unsigned __int128 prime12 = static_cast<unsigned __int128>(PRIME1) * PRIME2;
+
+  unsigned __int128 carry = 0;
+  for (int i = 0; i < n + m; ++i) {
+    uint64_t limb = 0;
+    for (int d = 0; d < DIGITS_PER_LIMB; ++d) {
+      int k = i * DIGITS_PER_LIMB + d;
+      uint64_t x1 = r1[k];
+      uint64_t x2 = (r2[k] + PRIME2 - x1 % PRIME2) % PRIME2 * inverse1Mod2 % PRIME2;
+      uint64_t x3 = (r3[k] + PRIME3 - x1 % PRIME3) % PRIME3 * inverse1Mod3 % PRIME3;
+      x3 = (x3 + PRIME3 - x2 % PRIME3) % PRIME3 * inverse2Mod3 % PRIME3;
+      carry += x1 + static_cast<unsigned __int128>(PRIME1) * x2 + prime12 * x3;
+      limb |= static_cast<uint64_t>(static_cast<uint32_t>(carry)) << (d * DIGIT_BITS);
+      carry >>= DIGIT_BITS;
+    }
+    out[i] = limb;
+  }
+}
+
+} // end namespace BigNum
@@ -0,0 +1,10 @@
+#include "chapter11/open_addressing.h"
+
+namespace Chapter11 {
+
+alignas(16) const ControlByte EMPTY_GROUP[16] = {
+  CTRL_SENTINEL, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+  CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+};
+
+} // end namespace Chapter11
@@ -0,0 +1,423 @@
+#include "chapter31/factorization.h"
+
+#include "bignum/montgomery.h"
+#include "chapter31/number_theoretic.h"
+#include "chapter31/prime_testing.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace NumberTheory {
+
+using BigNum::BigInt;
+using BigNum::MontgomeryContext;
+using BigNum::Montgomery64;
+
+namespace {
+
+// Montgomery arithmetic modulo an odd n behind one interface for both integer types, so that each
+// algorithm below is written once. Outputs may alias inputs. Since R is invertible modulo n, the
+// gcd of a residue in Montgomery form with n is that of the value it represents.
+class WordRing {
+ public:
+  using Integer = uint64_t;
+  using Element = uint64_t;
+
+  explicit WordRing(uint64_t n) : context{n} {}
+
+  Integer modulus() const { return context.modulus(); }
+  Element zero() const { return 0; }
+  Element one() const { return context.one(); }
+  Element fromInteger(uint64_t a) const { return context.toMontgomery(a); }
+  void add(const Element& a, const Element& b, Element& out) const { out = context.addmod(a, b); }
+  void sub(const Element& a, const Element& b, Element& out) const { out = context.submod(a, b); }
+  void mul(const Element& a, const Element& b, Element& out) const { out = context.mulmod(a, b); }
+  void sqr(const Element& a, Element& out) const { out = context.mulmod(a, a); }
+  Integer gcdWithModulus(const Element& a) const { return binaryGcd(a, context.modulus()); }
+
+ private:
+  Montgomery64 context;
+};
+
+class BigRing {
+ public:
+  using Integer = BigInt;
+  using Element = MontgomeryContext::Residue;
+
+  explicit BigRing(const BigInt& n) : context{n} {}
+
+  const Integer& modulus() const { return context.modulus(); }
+  Element zero() const { return Element(context.size(), 0); }
+  Element one() const { return context.one(); }
+  Element fromInteger(uint64_t a) const { return context.toMontgomery(BigInt(a)); }
+  void add(const Element& a, const Element& b, Element& out) const { context.addmod(a.data(), b.data(), out.data()); }
+  void sub(const Element& a, const Element& b, Element& out) const { context.submod(a.data(), b.data(), out.data()); }
+  void mul(const Element& a, const Element& b, Element& out) const { context.mulmod(a.data(), b.data(), out.data()); }
+  void sqr(const Element& a, Element& out) const { context.sqrmod(a.data(), out.data()); }
+  Integer gcdWithModulus(const Element& a) const { return gcd(context.fromMontgomery(a), context.modulus()); }
+
+ private:
+  MontgomeryContext context;
+};
+
+// Steps of Pollard-Brent between gcds
+constexpr uint64_t RHO_BATCH = 128;
+
+bool stopped(const std::atomic<bool>* stop) {
+  return stop != nullptr && stop->load(std::memory_order_relaxed);
+}
+
+template <typename Ring>
+std::optional<typename Ring::Integer> pollardBrent(const Ring& ring, uint64_t c, uint64_t maxIterations,
+                                                   const std::atomic<bool>* stop) {
+  using Element = typename Ring::Element;
+  using Integer = typename Ring::Integer;
+  Element constant = ring.fromInteger(c), y = ring.fromInteger(2), x = y, saved = y;
+  Element product = ring.one(), difference = ring.zero();
+  auto step = [&](Element& value) {
+    ring.sqr(value, value);
+    ring.add(value, constant, value);
+  };
+
+  // rounds of r = 1, 2, 4, ... steps: x stays where the round starts while y runs r steps ahead,
+  // then r more comparing against x
+  Integer g = 1;
+  uint64_t iterations = 0;
+  for (uint64_t r = 1; IntType::one(g); r *= 2) {
+    if (iterations >= maxIterations || stopped(stop)) return std::nullopt;
+    x = y;
+    for (uint64_t i = 0; i < r; ++i) step(y);
+    for (uint64_t k = 0; k < r && IntType::one(g); k += RHO_BATCH) {
+      saved = y;
+      for (uint64_t i = 0; i < std::min(RHO_BATCH, r - k); ++i) {
+        step(y);
+        ring.sub(x, y, difference);
+        ring.mul(product, difference, product);
+      }
+      g = ring.gcdWithModulus(product);
+      iterations += std::min(RHO_BATCH, r - k);
+    }
+  }
+
+  if (g == ring.modulus()) {
+    // the batch overshot or closed the cycle modulo n; redo it one step at a time
+    do {
+      step(saved);
+      ring.sub(x, saved, difference);
+      g = ring.gcdWithModulus(difference);
+    } while (IntType::one(g));
+  }
+  if (g == ring.modulus()) return std::nullopt;
+  return g;
+}
+
+// x-only arithmetic on a Montgomery curve B y^2 = x^3 + A x^2 + x with (A + 2) / 4 given as a
+// fraction, so that no modular inverse is ever needed. Points are projective (X : Z).
+template <typename Ring>
+class MontgomeryCurve {
+ public:
+  using Element = typename Ring::Element;
+  struct Point {
+    Element x, z;
+  };
+
+  MontgomeryCurve(const Ring& ring, Element numerator, Element denominator)
+      : ring{ring}, a24Numerator{std::move(numerator)}, a24Denominator{std::move(denominator)},
+        t1{ring.zero()}, t2{ring.zero()}, t3{ring.zero()}, t4{ring.zero()} {}
+
+  // out = 2p; out may alias p
+  void doublePoint(const Point& p, Point& out) {
+    ring.add(p.x, p.z, t1);
+    ring.sqr(t1, t1);
+    ring.sub(p.x, p.z, t2);
+    ring.sqr(t2, t2);
+    ring.sub(t1, t2, t3); // 4 X Z
+    ring.mul(t1, t2, t1);
+    ring.mul(t1, a24Denominator, out.x);
+    ring.mul(t2, a24Denominator, t2);
+    ring.mul(t3, a24Numerator, t4);
+    ring.add(t2, t4, t2);
+    ring.mul(t3, t2, out.z);
+  }
+
+  // out = p + q given difference = p - q; out may alias p or q
+  void addPoints(const Point& p, const Point& q, const Point& difference, Point& out) {
+    ring.sub(p.x, p.z, t1);
+    ring.add(q.x, q.z, t2);
+    ring.mul(t1, t2, t1);
+    ring.add(p.x, p.z, t2);
+    ring.sub(q.x, q.z, t3);
+    ring.mul(t2, t3, t2);
+    ring.add(t1, t2, t3);
+    ring.sqr(t3, t3);
+    ring.sub(t1, t2, t4);
+    ring.sqr(t4, t4);
+    ring.mul(difference.z, t3, t1);
+    ring.mul(difference.x, t4, out.z);
+    std::swap(out.x, t1);
+  }
+
+  // [k] p for k >= 1 by the Montgomery ladder, which keeps R1 - R0 = p throughout
+  Point multiply(const Point& p, uint64_t k) {
+    Point r0 = p, r1 = p;
+    doublePoint(p, r1);
+    for (int i = std::bit_width(k) - 2; i >= 0; --i) {
+      if ((k >> i) & 1) {
+        addPoints(r0, r1, p, r0);
+        doublePoint(r1, r1);
+      } else {
+        addPoints(r1, r0, p, r1);
+        doublePoint(r0, r0);
+      }
+    }
+    return r0;
+  }
+
+ private:
+  const Ring& ring;
+  Element a24Numerator, a24Denominator;
+  Element t1, t2, t3, t4;
+};
+
+std::vector<uint32_t> primesUpTo(uint64_t limit) {
+  const auto& table = smallPrimes();
+  if (limit < SMALL_PRIME_LIMIT) return std::vector<uint32_t>(table.begin(), std::upper_bound(table.begin(), table.end(), limit));
+  std::vector<char> composite(limit + 1, 0);
+  std::vector<uint32_t> result;
+  for (uint64_t i = 2; i <= limit; ++i) {
+    if (composite[i]) continue;
+    result.push_back(static_cast<uint32_t>(i));
+    for (uint64_t j = i * i; j <= limit; j += i) composite[j] = 1;
+  }
+  return result;
+}
+
+// Stage 2 giant steps are multiples of ECM_WHEEL, and baby steps the residues coprime to it
+constexpr uint64_t ECM_WHEEL = 210;
+
+template <typename Ring>
+std::optional<typename Ring::Integer> ecm(const Ring& ring, uint64_t sigma, uint64_t B1, const std::atomic<bool>* stop) {
+  using Element = typename Ring::Element;
+  using Integer = typename Ring::Integer;
+  using Point = typename MontgomeryCurve<Ring>::Point;
+  auto nontrivial = [&](const Integer& g) -> std::optional<Integer> {
+    if (IntType::one(g) || g == ring.modulus()) return std::nullopt;
+    return g;
+  };
+
+  // Suyama: u = sigma^2 - 5, v = 4 sigma, the point (u^3 : v^3) and
+  // (A + 2) / 4 = (v - u)^3 (3u + v) / (16 u^3 v)
+  Element s = ring.fromInteger(sigma), u = ring.zero(), v = ring.zero(), t = ring.zero();
+  ring.sqr(s, u);
+  ring.sub(u, ring.fromInteger(5), u);
+  ring.mul(s, ring.fromInteger(4), v);
+  Point point{ring.zero(), ring.zero()};
+  ring.sqr(u, point.x);
+  ring.mul(point.x, u, point.x);
+  ring.sqr(v, point.z);
+  ring.mul(point.z, v, point.z);
+  Element numerator = ring.zero(), denominator = ring.zero();
+  ring.sub(v, u, t);
+  ring.sqr(t, numerator);
+  ring.mul(numerator, t, numerator);
+  ring.mul(u, ring.fromInteger(3), t);
+  ring.add(t, v, t);
+  ring.mul(numerator, t, numerator);
+  ring.mul(point.x, v, denominator);
+  ring.mul(denominator, ring.fromInteger(16), denominator);
+  Integer g = ring.gcdWithModulus(denominator);
+  if (!IntType::one(g)) return nontrivial(g);
+  MontgomeryCurve<Ring> curve(ring, std::move(numerator), std::move(denominator));
+
+  // stage 1: multiply by the largest power of each prime up to B1, several primes per ladder
+  uint64_t k = 1;
+  for (uint64_t p : primesUpTo(B1)) {
+    uint64_t power = p;
+    while (power <= B1 / p) power *= p;
+    if (k > UINT64_MAX / power) {
+      point = curve.multiply(point, k);
+      k = 1;
+      if (stopped(stop)) return std::nullopt;
+    }
+    k *= power;
+  }
+  point = curve.multiply(point, k);
+  g = ring.gcdWithModulus(point.z);
+  if (!IntType::one(g)) return nontrivial(g);
+
+  // stage 2: a prime q = m W +- j in (B1, 100 B1] shows up as [m W] Q = +-[j] Q modulo p, which
+  // makes the cross product of their coordinates vanish
+  const uint64_t B2 = 100 * B1;
+  std::vector<Point> babies;
+  Point twice = point, previous = point, current = point;
+  curve.doublePoint(point, twice);
+  for (uint64_t j = 1; j < ECM_WHEEL / 2; j += 2) {
+    if (binaryGcd(j, ECM_WHEEL) == 1) babies.push_back(current);
+    // [j + 2] Q = [j] Q + [2] Q, whose difference is [j - 2] Q, or Q itself when j = 1
+    Point next = current;
+    curve.addPoints(current, twice, previous, next);
+    previous = std::exchange(current, std::move(next));
+  }
+  uint64_t m = std::max<uint64_t>(1, B1 / ECM_WHEEL);
+  Point step = curve.multiply(point, ECM_WHEEL);
+  Point giant = curve.multiply(point, m * ECM_WHEEL), nextGiant = curve.multiply(point, (m + 1) * ECM_WHEEL);
+  Element product = ring.one(), cross = ring.zero();
+  for (; m * ECM_WHEEL <= B2 + ECM_WHEEL / 2; ++m) {
+    for (const auto& baby : babies) {
+      ring.mul(giant.x, baby.z, t);
+      ring.mul(baby.x, giant.z, cross);
+      ring.sub(t, cross, t);
+      ring.mul(product, t, product);
+    }
+    // [(m + 2) W] Q = [(m + 1) W] Q + [W] Q, with difference [m W] Q
+    Point following = giant;
+    curve.addPoints(nextGiant, step, giant, following);
+    giant = std::exchange(nextGiant, std::move(following));
+    if (m % 64 == 0 && stopped(stop)) return std::nullopt;
+  }
+  return nontrivial(ring.gcdWithModulus(product));
+}
+
+// GMP-ECM's recommended B1 and curve counts for factors of 15, 20, 25, 30 and 35 digits
+struct EcmLevel {
+  uint64_t B1;
+  int curves;
+};
+constexpr std::array<EcmLevel, 5> ECM_SCHEDULE{{{2000, 25}, {11000, 90}, {50000, 300}, {250000, 700}, {1000000, 1800}}};
+
+// Divides 2, 3, 5 and then the numbers coprime to 30, stepped through by a wheel of eight gaps,
+// out of n up to limit, recording each factor found
+template <typename Int>
+void wheelTrialDivision(Int& n, uint64_t limit, std::vector<Int>& factors) {
+  auto divideOut = [&](uint64_t d) {
+    while (IntType::zero(n % Int(d))) {
+      n = n / Int(d);
+      factors.push_back(Int(d));
+    }
+  };
+  divideOut(2);
+  divideOut(3);
+  divideOut(5);
+  constexpr std::array<uint64_t, 8> GAPS{4, 2, 4, 2, 4, 6, 2, 6};
+  for (uint64_t d = 7, i = 0; d <= limit && !(n < Int(d * d)); d += GAPS[i++ % GAPS.size()]) divideOut(d);
+}
+
+} // end anonymous namespace
+
+std::optional<uint64_t> pollardBrent(uint64_t n, uint64_t c, uint64_t maxIterations) {
+  if (n < 4) return std::nullopt;
+  if (n % 2 == 0) return 2;
+  return pollardBrent(WordRing(n), c, maxIterations, nullptr);
+}
+
+std::optional<BigInt> pollardBrent(const BigInt& n, uint64_t c, uint64_t maxIterations) {
+  if (n.negative() || n < BigInt(4)) return std::nullopt;
+  if (n.even()) return BigInt(2);
+  return pollardBrent(BigRing(n), c, maxIterations, nullptr);
+}
+
+std::optional<uint64_t> ecm(uint64_t n, uint64_t sigma, uint64_t B1) {
+  if (n < 4) return std::nullopt;
+  if (n % 2 == 0) return 2;
+  return ecm(WordRing(n), sigma, B1, nullptr);
+}
+
+std::optional<BigInt> ecm(const BigInt& n, uint64_t sigma, uint64_t B1) {
+  if (n.negative() || n < BigInt(4)) return std::nullopt;
+  if (n.even()) return BigInt(2);
+  return ecm(BigRing(n), sigma, B1, nullptr);
+}
+
+std::optional<BigInt> findFactor(const BigInt& n, int threads) {
+  if (n.negative() || n < BigInt(4)) return std::nullopt;
+  if (n.even()) return BigInt(2);
+  threads = std::max(threads, 1);
+  BigRing ring(n);
+  std::atomic<bool> stop = false;
+  std::mutex mutex;
+  std::optional<BigInt> result;
+  auto publish = [&](std::optional<BigInt> factor) {
+    if (!factor) return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!result) result = std::move(factor);
+    stop = true;
+    return true;
+  };
+
+  // each worker takes its own rho polynomial and every threads-th curve of the schedule
+  auto work = [&](int worker) {
+    if (publish(pollardBrent(ring, worker + 1, RHO_ITERATIONS, &stop)) || stop) return;
+    uint64_t sigma = 6;
+    for (const auto& level : ECM_SCHEDULE) {
+      for (int curve = 0; curve < level.curves; ++curve, ++sigma) {
+        if (curve % threads != worker) continue;
+        if (publish(ecm(ring, sigma, level.B1, &stop)) || stop) return;
+      }
+    }
+  };
+  if (threads == 1) {
+    work(0);
+  } else {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) workers.emplace_back(work, t);
+    for (auto& worker : workers) worker.join();
+  }
+  return result;
+}
+
+std::vector<uint64_t> factor(uint64_t n) {
+  if (n == 0) throw std::invalid_argument("0 has no factorization");
+  std::vector<uint64_t> factors;
+  wheelTrialDivision(n, WHEEL_TRIAL_LIMIT, factors);
+  std::vector<uint64_t> pending{n};
+  while (!pending.empty()) {
+    uint64_t m = pending.back();
+    pending.pop_back();
+    if (m == 1) continue;
+    if (isPrime(m)) {
+      factors.push_back(m);
+      continue;
+    }
+    // rho always splits a composite word eventually; another constant helps when the cycle closes
+    std::optional<uint64_t> d;
+    for (uint64_t c = 1; !d; ++c) d = pollardBrent(m, c);
+    pending.push_back(*d);
+    pending.push_back(m / *d);
+  }
+  std::sort(factors.begin(), factors.end());
+  return factors;
+}
+
+std::vector<BigInt> factor(const BigInt& n, int threads) {
+  if (n.zero()) throw std::invalid_argument("0 has no factorization");
+  BigInt m = n.negative()? -n: n;
+  std::vector<BigInt> factors;
+  wheelTrialDivision(m, WHEEL_TRIAL_LIMIT, factors);
+  std::vector<BigInt> pending{m};
+  while (!pending.empty()) {
+    BigInt current = std::move(pending.back());
+    pending.pop_back();
+    if (current.bitLength() <= 64) {
+      for (uint64_t p : factor(static_cast<uint64_t>(current.toNum()))) factors.push_back(BigInt(p));
+      continue;
+    }
+    if (isPrime(current)) {
+      factors.push_back(std::move(current));
+      continue;
+    }
+    std::optional<BigInt> d = findFactor(current, threads);
+    if (!d) throw std::runtime_error("No factor found for " + current.toString());
+    pending.push_back(current / *d);
+    pending.push_back(std::move(*d));
+  }
+  std::sort(factors.begin(), factors.end());
+  return factors;
+}
+
+}
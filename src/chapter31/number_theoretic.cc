@@ -0,0 +1,63 @@
+#include "chapter31/number_theoretic.h"
+
+#include <cstdint>
+#include <utility>
+
+namespace NumberTheory {
+
+using BigNum::BigInt;
+
+namespace {
+
+// The top 63 bits of a and b, both shifted by the amount that brings a's leading bit to bit 62
+std::pair<int64_t, int64_t> leadingBits(const BigInt& a, const BigInt& b) {
+  int shift = a.bitLength() - 63;
+  return {a.binaryScaleDown(shift).toNum(), b.binaryScaleDown(shift).toNum()};
+}
+
+} // end anonymous namespace
+
+BigInt gcd(const BigInt& a, const BigInt& b) {
+  BigInt x = a.negative()? -a: a, y = b.negative()? -b: b;
+  if (x < y) std::swap(x, y);
+
+  // x >= y throughout; stop once y fits in a single limb
+  while (y.bitLength() > 64) {
+    auto [xHat, yHat] = leadingBits(x, y);
+    // x * A + y * B and x * C + y * D track the remainders of xHat and yHat. A quotient is only
+    // taken when both bounds on the true leading remainders give the same one.
+    int64_t A = 1, B = 0, C = 0, D = 1;
+    while (true) {
+      __int128 lowDivisor = static_cast<__int128>(yHat) + C, highDivisor = static_cast<__int128>(yHat) + D;
+      if (lowDivisor == 0 || highDivisor == 0) break;
+      __int128 q = (static_cast<__int128>(xHat) + A) / lowDivisor;
+      if (q != (static_cast<__int128>(xHat) + B) / highDivisor) break;
+      // the new cofactors and remainder fit in 63 bits, though q times the old ones may not
+      int64_t nextA = static_cast<int64_t>(A - q * C), nextB = static_cast<int64_t>(B - q * D);
+      A = std::exchange(C, nextA);
+      B = std::exchange(D, nextB);
+      xHat = std::exchange(yHat, static_cast<int64_t>(xHat - q * yHat));
+    }
+
+    if (B == 0) {
+      // no quotient could be settled from the leading bits, so take one full division step
+      BigInt r = x % y;
+      x = std::move(y);
+      y = std::move(r);
+    } else {
+      BigInt nextX = x * BigInt(A), nextY = x * BigInt(C);
+      nextX.addmul(y, BigInt(B));
+      nextY.addmul(y, BigInt(D));
+      x = std::move(nextX);
+      y = std::move(nextY);
+    }
+  }
+
+  if (y.zero()) return x;
+  // y fits in a limb, so one division brings x down to a limb too
+  uint64_t small = static_cast<uint64_t>(y.toNum());
+  uint64_t remainder = static_cast<uint64_t>((x % y).toNum());
+  return BigInt(binaryGcd(small, remainder));
+}
+
+}
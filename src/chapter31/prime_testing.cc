@@ -0,0 +1,347 @@
+#include "chapter31/prime_testing.h"
+
+#include "bignum/montgomery.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+namespace NumberTheory {
+
+using BigNum::BigInt;
+using BigNum::MontgomeryContext;
+using BigNum::Montgomery64;
+
+namespace {
+
+using wide = unsigned __int128;
+
+constexpr uint64_t LARGEST_64_BIT_PRIME = 18446744073709551557ull;
+
+// Consecutive odd small primes grouped so that each group's product fits in a limb, letting one
+// pass over a BigInt's limbs find its remainder modulo several primes at once
+struct PrimeBlock {
+  uint64_t product;
+  int first, last; // indices into smallPrimes()
+};
+
+const std::vector<PrimeBlock>& primeBlocks() {
+  static const std::vector<PrimeBlock> blocks = [] {
+    const auto& primes = smallPrimes();
+    std::vector<PrimeBlock> result;
+    for (int i = 1; i < static_cast<int>(primes.size());) {
+      PrimeBlock block{1, i, i};
+      while (block.last < static_cast<int>(primes.size()) && block.product <= UINT64_MAX / primes[block.last]) {
+        block.product *= primes[block.last++];
+      }
+      result.push_back(block);
+      i = block.last;
+    }
+    return result;
+  }();
+  return blocks;
+}
+
+// |n| mod m
+uint64_t remainder(const BigInt& n, uint64_t m) {
+  wide r = 0;
+  for (int i = static_cast<int>(n.bits.size()) - 1; i >= 0; --i) r = ((r << 64) | n.bits[i]) % m;
+  return static_cast<uint64_t>(r);
+}
+
+// n mod each odd small prime below limit, in the order of smallPrimes() from 3
+std::vector<uint32_t> remaindersModPrimes(const BigInt& n, uint32_t limit) {
+  const auto& primes = smallPrimes();
+  std::vector<uint32_t> result;
+  for (const auto& block : primeBlocks()) {
+    if (primes[block.first] >= limit) break;
+    uint64_t r = remainder(n, block.product);
+    for (int i = block.first; i < block.last && primes[i] < limit; ++i) result.push_back(r % primes[i]);
+  }
+  return result;
+}
+
+// Whether some odd small prime below limit divides n
+bool hasSmallFactor(const BigInt& n, uint32_t limit) {
+  const auto& primes = smallPrimes();
+  for (const auto& block : primeBlocks()) {
+    if (primes[block.first] >= limit) break;
+    uint64_t r = remainder(n, block.product);
+    for (int i = block.first; i < block.last && primes[i] < limit; ++i) {
+      if (r % primes[i] == 0) return true;
+    }
+  }
+  return false;
+}
+
+// Jacobi symbol (a / n) for odd n > 0
+int jacobi(uint64_t a, uint64_t n) {
+  int result = 1;
+  a %= n;
+  while (a != 0) {
+    int twos = std::countr_zero(a);
+    a >>= twos;
+    // (2 / n) = -1 exactly when n = 3 or 5 mod 8
+    if ((twos & 1) && (n % 8 == 3 || n % 8 == 5)) result = -result;
+    // quadratic reciprocity flips the sign when both are 3 mod 4
+    if (a % 4 == 3 && n % 4 == 3) result = -result;
+    std::swap(a, n);
+    a %= n;
+  }
+  return n == 1? result: 0;
+}
+
+// (a / n) for a small signed a and odd n > 0, reduced to single-limb arguments by reciprocity
+int jacobi(int64_t a, const BigInt& n) {
+  uint64_t nMod8 = n.bits[0] % 8;
+  int result = 1;
+  // (-1 / n) = -1 exactly when n = 3 mod 4
+  if (a < 0 && nMod8 % 4 == 3) result = -result;
+  uint64_t m = static_cast<uint64_t>(std::abs(a));
+  if (m == 0) return 0;
+  int twos = std::countr_zero(m);
+  m >>= twos;
+  if ((twos & 1) && (nMod8 == 3 || nMod8 == 5)) result = -result;
+  if (m % 4 == 3 && nMod8 % 4 == 3) result = -result;
+  return result * jacobi(remainder(n, m), m);
+}
+
+// floor(sqrt(n)) for n >= 0 by Newton's iteration from above
+BigInt integerSqrt(const BigInt& n) {
+  if (n.zero()) return n;
+  BigInt x = BigInt(1).binaryScaleUp((n.bitLength() + 1) / 2);
+  while (true) {
+    BigInt next = (x + n / x).half();
+    if (next >= x) return x;
+    x = std::move(next);
+  }
+}
+
+bool isPerfectSquare(const BigInt& n) {
+  // squares occupy 12 of the 64 residues mod 64, so most values are rejected without a root
+  constexpr uint64_t SQUARES_MOD_64 = 0x0202021202030213ull;
+  if (((SQUARES_MOD_64 >> (n.bits[0] % 64)) & 1) == 0) return false;
+  BigInt root = integerSqrt(n);
+  return root * root == n;
+}
+
+bool isZero(const MontgomeryContext::Residue& a) {
+  return std::all_of(a.begin(), a.end(), [](uint64_t limb) { return limb == 0; });
+}
+
+// The exponentiations of Baillie-PSW, once trial division has found nothing
+bool bailliePsw(const BigInt& n) {
+  return isStrongProbablePrime(n, BigInt(2)) && isStrongLucasProbablePrime(n);
+}
+
+// Offsets i in [0, slots) for which start + 2i, with start odd, has no factor among the odd
+// small primes whose remainders are given. When start is small enough to be given, a prime
+// within the window is kept rather than crossed off as a multiple of itself.
+std::vector<char> sieveWindow(const std::vector<uint32_t>& remainders, int slots, uint64_t smallStart) {
+  const auto& primes = smallPrimes();
+  std::vector<char> candidate(slots, 1);
+  for (std::size_t k = 0; k < remainders.size(); ++k) {
+    uint64_t p = primes[k + 1];
+    // start + 2i = 0 mod p when i = -start / 2 mod p, and (p + 1) / 2 inverts 2
+    uint64_t i = (p - remainders[k]) % p * ((p + 1) / 2) % p;
+    if (smallStart != 0 && smallStart + 2 * i == p) i += p;
+    for (; i < static_cast<uint64_t>(slots); i += p) candidate[i] = 0;
+  }
+  return candidate;
+}
+
+// Odd slots per sieving window for values of the given bit length, a few dozen prime gaps
+int windowSlots(int bits) {
+  return std::max(256, 32 * bits);
+}
+
+} // end anonymous namespace
+
+const std::vector<uint32_t>& smallPrimes() {
+  static const std::vector<uint32_t> primes = [] {
+    std::vector<char> composite(SMALL_PRIME_LIMIT, 0);
+    std::vector<uint32_t> result;
+    for (uint32_t i = 2; i < SMALL_PRIME_LIMIT; ++i) {
+      if (composite[i]) continue;
+      result.push_back(i);
+      for (uint64_t j = static_cast<uint64_t>(i) * i; j < SMALL_PRIME_LIMIT; j += i) composite[j] = 1;
+    }
+    return result;
+  }();
+  return primes;
+}
+
+bool isPrime(uint64_t n) {
+  constexpr std::array<uint64_t, 15> SMALL{2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47};
+  if (n < 2) return false;
+  for (uint64_t p : SMALL) {
+    if (n % p == 0) return n == p;
+  }
+  if (n < 53 * 53) return true;
+
+  // {2, 7, 61} has no strong pseudoprime below 4759123141 (Jaeschke), and Sinclair's seven bases
+  // have none below 2^64
+  constexpr std::array<uint64_t, 3> BASES_32{2, 7, 61};
+  constexpr std::array<uint64_t, 7> BASES_64{2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+  Montgomery64 context(n);
+  int s = std::countr_zero(n - 1);
+  uint64_t d = (n - 1) >> s;
+  uint64_t one = context.one(), minusOne = context.submod(0, one);
+  auto witness = [&](uint64_t base) {
+    // true when base proves n composite
+    if (base % n == 0) return false;
+    uint64_t x = context.powmod(context.toMontgomery(base), d);
+    if (x == one || x == minusOne) return false;
+    for (int r = 1; r < s; ++r) {
+      x = context.mulmod(x, x);
+      if (x == minusOne) return false;
+    }
+    return true;
+  };
+  if (n < (uint64_t{1} << 32)) return std::none_of(BASES_32.begin(), BASES_32.end(), witness);
+  return std::none_of(BASES_64.begin(), BASES_64.end(), witness);
+}
+
+bool isPrime(const BigInt& n) {
+  if (n.negative()) return false;
+  if (n.bitLength() <= 64) return isPrime(static_cast<uint64_t>(n.toNum()));
+  if (n.even() || hasSmallFactor(n, TRIAL_DIVISION_LIMIT)) return false;
+  return bailliePsw(n);
+}
+
+std::vector<bool> isPrime(const std::vector<BigInt>& candidates, int threads) {
+  // one byte per result, since threads cannot share the words of a vector<bool>
+  std::vector<char> results(candidates.size());
+  auto work = [&](int first) {
+    for (std::size_t i = first; i < candidates.size(); i += std::max(threads, 1)) results[i] = isPrime(candidates[i]);
+  };
+  if (threads <= 1) {
+    work(0);
+  } else {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) workers.emplace_back(work, t);
+    for (auto& worker : workers) worker.join();
+  }
+  return std::vector<bool>(results.begin(), results.end());
+}
+
+bool isStrongProbablePrime(const BigInt& n, const BigInt& base) {
+  MontgomeryContext context(n);
+  BigInt d = n - 1;
+  int s = 0;
+  while (d.even()) {
+    d >>= 1;
+    ++s;
+  }
+  MontgomeryContext::Residue x = context.toMontgomery(base);
+  if (isZero(x)) return true; // a multiple of n says nothing
+  MontgomeryContext::Residue minusOne(context.size(), 0);
+  context.submod(minusOne.data(), context.one().data(), minusOne.data());
+
+  context.powmod(x.data(), d, x.data());
+  if (x == context.one() || x == minusOne) return true;
+  for (int r = 1; r < s; ++r) {
+    context.sqrmod(x.data(), x.data());
+    if (x == minusOne) return true;
+    if (x == context.one()) return false;
+  }
+  return false;
+}
+
+bool isStrongLucasProbablePrime(const BigInt& n) {
+  // Selfridge's method A: the first D in 5, -7, 9, -11, ... with (D / n) = -1, then P = 1 and
+  // Q = (1 - D) / 4. No such D exists for a square, so those are ruled out first.
+  if (isPerfectSquare(n)) return false;
+  int64_t D = 5;
+  while (true) {
+    int symbol = jacobi(D, n);
+    if (symbol == -1) break;
+    // (D / n) = 0 means D shares a factor with n, which is then composite unless it is |D|
+    if (symbol == 0 && n != BigInt(std::abs(D))) return false;
+    D = (D > 0)? -(D + 2): -D + 2;
+  }
+  BigInt Q((1 - D) / 4);
+
+  // n + 1 = d 2^s with d odd
+  BigInt d = n + 1;
+  int s = 0;
+  while (d.even()) {
+    d >>= 1;
+    ++s;
+  }
+
+  MontgomeryContext context(n);
+  int size = context.size();
+  using Residue = MontgomeryContext::Residue;
+  Residue U = context.one(), V = context.one(), Qk = context.toMontgomery(Q);
+  Residue montgomeryQ = Qk, montgomeryD = context.toMontgomery(BigInt(D)), t(size);
+  // V_2k = V_k^2 - 2 Q^k, computed in place along with Q^2k = (Q^k)^2
+  auto doubleV = [&] {
+    context.sqrmod(V.data(), V.data());
+    context.addmod(Qk.data(), Qk.data(), t.data());
+    context.submod(V.data(), t.data(), V.data());
+    context.sqrmod(Qk.data(), Qk.data());
+  };
+
+  // left to right over the bits of d: U_2k = U_k V_k, then U_k+1 = (P U_k + V_k) / 2 and
+  // V_k+1 = (D U_k + P V_k) / 2 when the bit is set
+  for (int i = d.bitLength() - 2; i >= 0; --i) {
+    context.mulmod(U.data(), V.data(), U.data());
+    doubleV();
+    if ((d.bits[i / 64] >> (i % 64)) & 1) {
+      context.mulmod(montgomeryD.data(), U.data(), t.data());
+      context.addmod(U.data(), V.data(), U.data());
+      context.halve(U.data(), U.data());
+      context.addmod(t.data(), V.data(), V.data());
+      context.halve(V.data(), V.data());
+      context.mulmod(Qk.data(), montgomeryQ.data(), Qk.data());
+    }
+  }
+
+  if (isZero(U) || isZero(V)) return true;
+  for (int r = 1; r < s; ++r) {
+    doubleV();
+    if (isZero(V)) return true;
+  }
+  return false;
+}
+
+uint64_t nextPrime(uint64_t n) {
+  if (n < 2) return 2;
+  if (n >= LARGEST_64_BIT_PRIME) throw std::overflow_error("No 64-bit prime above n");
+  uint64_t start = (n + 1) | 1;
+  const auto& primes = smallPrimes();
+  int slots = windowSlots(std::bit_width(n));
+  // small values gain little from a deep sieve, so it grows with the bit length
+  uint64_t limit = std::min<uint64_t>(SMALL_PRIME_LIMIT, std::max<uint64_t>(3, 64 * std::bit_width(n)));
+  while (true) {
+    std::vector<uint32_t> remainders;
+    for (std::size_t k = 1; k < primes.size() && primes[k] < limit; ++k) remainders.push_back(start % primes[k]);
+    std::vector<char> candidate = sieveWindow(remainders, slots, start);
+    for (int i = 0; i < slots; ++i) {
+      if (candidate[i] && isPrime(start + 2 * static_cast<uint64_t>(i))) return start + 2 * static_cast<uint64_t>(i);
+    }
+    start += 2 * static_cast<uint64_t>(slots);
+  }
+}
+
+BigInt nextPrime(const BigInt& n) {
+  if (n < BigInt(LARGEST_64_BIT_PRIME)) return BigInt(nextPrime(n.negative()? uint64_t{0}: static_cast<uint64_t>(n.toNum())));
+  BigInt start = n + 1;
+  if (start.even()) ++start;
+  int slots = windowSlots(start.bitLength());
+  while (true) {
+    std::vector<char> candidate = sieveWindow(remaindersModPrimes(start, SMALL_PRIME_LIMIT), slots, 0);
+    for (int i = 0; i < slots; ++i) {
+      if (!candidate[i]) continue;
+      BigInt value = start + BigInt(2 * i);
+      if (bailliePsw(value)) return value;
+    }
+    start += BigInt(2 * slots);
+  }
+}
+
+}
@@ -0,0 +1,121 @@
+#include "chapter31/rsa.h"
+
+#include "chapter31/number_theoretic.h"
+#include "chapter31/prime_testing.h"
+#include "helpers/random_generators.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <thread>
+
+namespace NumberTheory {
+
+using BigNum::BigInt;
+using BigNum::MontgomeryContext;
+
+namespace {
+
+void checkRange(const BigInt& value, const BigInt& modulus) {
+  if (value.negative() || !(value < modulus)) throw std::invalid_argument("RSA input must be in [0, n)");
+}
+
+// a^-1 mod m for m > 1
+BigInt modularInverse(const BigInt& a, const BigInt& m) {
+  BigInt reduced = a % m;
+  if (reduced.negative()) reduced += m;
+  auto [g, x, y] = extendedEuclid(reduced, m);
+  if (!g.one()) throw std::invalid_argument("RSA exponent or factor is not invertible");
+  return x.negative() ? x + m : x;
+}
+
+// A prime of exactly the given number of bits with its top two bits set, so that the product of
+// two of them has exactly as many bits as the two together, and with gcd(p - 1, e) = 1
+BigInt randomPrime(std::mt19937_64& gen, int bits, const BigInt& e) {
+  for (;;) {
+    BigInt start = randomBigInt(gen, bits - 2) + BigInt(3).binaryScaleUp(bits - 2);
+    BigInt p = nextPrime(start);
+    if (p.bitLength() == bits && gcd(p - 1, e).one()) return p;
+  }
+}
+
+}
+
+RsaPublicKey::RsaPublicKey(const BigInt& modulus, const BigInt& exponent) : e(exponent), context(modulus) {
+  if (!(BigInt(1) < exponent)) throw std::invalid_argument("RSA exponent must be greater than 1");
+}
+
+BigInt RsaPublicKey::encrypt(const BigInt& message) const {
+  checkRange(message, modulus());
+  if (e.bitLength() > 64) return context.powmod(message, e);
+
+  uint64_t exponent = static_cast<uint64_t>(e.toNum());
+  MontgomeryContext::Residue base = context.toMontgomery(message), result = base;
+  for (int i = std::bit_width(exponent) - 2; i >= 0; --i) {
+    context.sqrmod(result.data(), result.data());
+    if (exponent >> i & 1) context.mulmod(result.data(), base.data(), result.data());
+  }
+  return context.fromMontgomery(result);
+}
+
+bool RsaPublicKey::verify(const BigInt& message, const BigInt& signature) const {
+  if (signature.negative() || !(signature < modulus())) return false;
+  return encrypt(signature) == message;
+}
+
+RsaPrivateKey::RsaPrivateKey(const BigInt& p, const BigInt& q, const BigInt& publicExponent)
+    : e(publicExponent), d(0), dP(0), dQ(0), qInverse(0), contextN(p * q), contextP(p), contextQ(q) {
+  if (p == q) throw std::invalid_argument("RSA factors must be distinct");
+  if (!(BigInt(1) < publicExponent)) throw std::invalid_argument("RSA exponent must be greater than 1");
+  BigInt pMinusOne = p - 1, qMinusOne = q - 1;
+  // Carmichael's lambda(n) = lcm(p - 1, q - 1); any d = e^-1 modulo it works, and it is at most
+  // phi(n) / 2, so this d is usually shorter than the one modulo phi(n)
+  BigInt lambda = pMinusOne / gcd(pMinusOne, qMinusOne) * qMinusOne;
+  d = modularInverse(e, lambda);
+  dP = d % pMinusOne;
+  dQ = d % qMinusOne;
+  qInverse = modularInverse(q, p);
+}
+
+RsaPrivateKey RsaPrivateKey::generate(int bits, std::mt19937_64& gen, uint64_t publicExponent) {
+  if (bits < 16) throw std::invalid_argument("RSA modulus must have at least 16 bits");
+  BigInt e(publicExponent);
+  BigInt p = randomPrime(gen, (bits + 1) / 2, e);
+  BigInt q = randomPrime(gen, bits / 2, e);
+  while (p == q) q = randomPrime(gen, bits / 2, e);
+  return RsaPrivateKey(p, q, e);
+}
+
+BigInt RsaPrivateKey::decrypt(const BigInt& ciphertext) const {
+  checkRange(ciphertext, modulus());
+  BigInt mP = contextP.powmod(ciphertext, dP);
+  BigInt mQ = contextQ.powmod(ciphertext, dQ);
+  // Garner: m = mQ + q ((mP - mQ) q^-1 mod p) is the value below n that matches both halves
+  BigInt h = contextP.mulmod(mP - mQ, qInverse);
+  mQ.addmul(h, contextQ.modulus());
+  return mQ;
+}
+
+BigInt RsaPrivateKey::decryptWithoutCrt(const BigInt& ciphertext) const {
+  checkRange(ciphertext, modulus());
+  return contextN.powmod(ciphertext, d);
+}
+
+std::vector<BigInt> RsaPrivateKey::decrypt(const std::vector<BigInt>& ciphertexts, int threads) const {
+  std::vector<BigInt> results(ciphertexts.size(), BigInt(0));
+  auto work = [&](int first) {
+    for (std::size_t i = first; i < ciphertexts.size(); i += std::max(threads, 1)) results[i] = decrypt(ciphertexts[i]);
+  };
+  if (threads <= 1) {
+    work(0);
+  } else {
+    // an exception escaping a thread would terminate, so check every input before starting
+    for (const auto& ciphertext : ciphertexts) checkRange(ciphertext, modulus());
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) workers.emplace_back(work, t);
+    for (auto& worker : workers) worker.join();
+  }
+  return results;
+}
+
+}
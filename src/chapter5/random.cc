@@ -1,16 +1,72 @@
 #include "chapter5/random.h"
 
 namespace Chapter5 {
-  Random::Random(): initialSeed{rd()} {
+  Xoshiro256::Xoshiro256(uint64_t initialSeed) {
+    seed(initialSeed);
+  }
+
+  // expands the seed into the four state words with splitmix64, as recommended by the authors
+  void Xoshiro256::seed(uint64_t newSeed) {
+    for (auto &word : state) {
+      uint64_t z = (newSeed += 0x9e3779b97f4a7c15);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      word = z ^ (z >> 31);
+    }
+  }
+
+  static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  Xoshiro256::result_type Xoshiro256::operator()() {
+    uint64_t result = rotl(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+  }
+
+  template <typename Engine>
+  BasicRandom<Engine>::BasicRandom(): initialSeed{std::random_device{}()} {
     resetSeed();
   }
 
-  int Random::operator()(int low, int high) {
+  template <typename Engine>
+  BasicRandom<Engine>::BasicRandom(unsigned seed): initialSeed{seed} {
+    resetSeed();
+  }
+
+  template <typename Engine>
+  int BasicRandom<Engine>::operator()(int low, int high) {
     std::uniform_int_distribution<int> distribution{low, high};
     return distribution(generator);
   }
 
-  void Random::resetSeed() {
+  template <typename Engine>
+  void BasicRandom<Engine>::resetSeed() {
     generator.seed(initialSeed);
   }
-}
\ No newline at end of file
+
+  template <typename Engine>
+  void BasicRandom<Engine>::seed(unsigned newSeed) {
+    initialSeed = newSeed;
+    resetSeed();
+  }
+
+  template class BasicRandom<std::mt19937>;
+  template class BasicRandom<Xoshiro256>;
+
+  FastRandom &threadRandom() {
+    thread_local FastRandom rand;
+    return rand;
+  }
+
+  void seedThreadRandom(unsigned seed) {
+    threadRandom().seed(seed);
+  }
+}
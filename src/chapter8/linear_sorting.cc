@@ -2,32 +2,17 @@
 
 namespace Chapter8 {
 
-  void countingSort(std::vector<int> &vec, int k, std::function<int(int)> transform) {
-    std::vector<int> copy = vec;
-    std::vector<int> count(k+1, 0);
-    
-    // count[i] holds # of elements == i
-    for (auto x : vec) ++count[transform(x)];
-    // count[i] holds # of elements <= i
-    for (int i = 1; i <= k; ++i) count[i] += count[i-1];
-    // Iterate backwards through vector and insert all equal elements in their place
-    // in reverse order to keep stability
-    for (int i = vec.size()-1; i >= 0; --i) {
-      int transformedValue = transform(copy[i]);
-      vec[count[transformedValue] - 1] = copy[i];
-      --count[transformedValue];
-    }
-  }
-
   void radixSort(std::vector<int> &vec) {
     if (vec.empty()) return;
 
     int maxNumber = *(std::max_element(vec.begin(), vec.end()));
+    std::vector<int> count;
+    std::vector<int> buffer;
     
     // sorts each digit from least -> most significant
     // (x / exp) % 10 captures the nth digit from right if exp = 10^(n-1)
     for (int exp = 1; maxNumber / exp > 0; exp *= 10) 
-      countingSort(vec, 10, [exp](int x) { return (x / exp) % 10; });
+      countingSort(vec, 9, [exp](int x) { return (x / exp) % 10; }, count, buffer);
   }
 
   RangeQuery::RangeQuery(const std::vector<int> &vec, int k) : range{k}, rangeInfo{std::vector<int>(range+1, 0)} {
@@ -42,4 +27,13 @@ namespace Chapter8 {
   int RangeQuery::query(int low, int high) {
     return rangeInfo[high] - ((low == 0) ? 0 : rangeInfo[low-1]);
   }
-}
\ No newline at end of file
+
+  void printBucketStats(const BucketStats &stats) {
+    std::cout << "Number of buckets: " << stats.bucketCount << std::endl;
+    std::cout << "Largest bucket: " << stats.largestBucket << std::endl;
+    std::cout << "Number of buckets with size >= 2: " << stats.bucketsOfAtLeastTwo << std::endl;
+    std::cout << "Number of buckets with size >= 3: " << stats.bucketsOfAtLeastThree << std::endl;
+    std::cout << "Sum of N^2 for each bucket: " << stats.squaredSizeSum << " --- "
+              << static_cast<double>(stats.squaredSizeSum) / stats.bucketCount << std::endl;
+  }
+}
@@ -5,6 +5,10 @@
 #include "helpers/speed_profiler.h"
 #include "helpers/printing_helpers.h"
 
+#include <limits>
+#include <random>
+#include <algorithm>
+
 
 using namespace BigNum;
 
@@ -36,11 +40,332 @@ TEST(BigIntTests, StringInputOutput) {
   EXPECT_EQ(num.toString(), "123456789");
   BigInt pow = 1;
   for (int i = 0; i < 10; ++i) pow *= num;
-  BigInt(1).toString();
-  // BigInt(1).binaryScaleUp(1000);
-  // EXPECT_EQ(pow.toString(), "822526259147102579504761143661535547764137892295514168093701699676416207799736601");
+  EXPECT_EQ(BigInt(0).toString(), "0");
+  EXPECT_EQ(pow.toString(), "822526259147102579504761143661535547764137892295514168093701699676416207799736601");
+  EXPECT_EQ(BigInt(pow.toString()), pow);
+  EXPECT_EQ(BigInt(1).binaryScaleUp(200).toString(), "1606938044258990275541962092341162602522202993782792835301376");
+  EXPECT_EQ(BigInt("10000000000000000000").toString(), "10000000000000000000");
+  EXPECT_EQ(BigInt("000123").toString(), "123");
+  EXPECT_EQ((-pow).toString(), "-822526259147102579504761143661535547764137892295514168093701699676416207799736601");
+}
+
+TEST(BigIntTests, WordBoundaries) {
+  BigInt minimum = std::numeric_limits<long long>::min();
+  EXPECT_EQ(minimum.toNum(), std::numeric_limits<long long>::min());
+  EXPECT_EQ(minimum.toString(), "-9223372036854775808");
+  BigInt maximum = std::numeric_limits<uint64_t>::max();
+  EXPECT_EQ(maximum.toString(), "18446744073709551615");
+  EXPECT_EQ((maximum + 1).toString(), "18446744073709551616");
+  EXPECT_EQ((maximum + 1 - 1), maximum);
+  EXPECT_EQ((maximum * maximum).toString(), "340282366920938463426481119284349108225");
+  EXPECT_EQ((maximum * maximum) / maximum, maximum);
+  EXPECT_TRUE(((maximum * maximum) % maximum).zero());
+
+  // toNum keeps the low 64 bits, like a cast
+  EXPECT_EQ((maximum + 6).toNum(), 5);
+
+  BigInt big("987654321098765432109876543210987654321");
+  BigInt divisor("12345678901234567890123");
+  BigInt quotient = big / divisor;
+  BigInt remainder = big % divisor;
+  EXPECT_EQ(quotient.toString(), "80000000729000006");
+  EXPECT_EQ(quotient * divisor + remainder, big);
+  EXPECT_TRUE(remainder < divisor);
+  for (int k : {1, 63, 64, 65, 130}) {
+    EXPECT_EQ(big.binaryScaleUp(k).binaryScaleDown(k), big) << "k = " << k;
+    EXPECT_EQ((-big).binaryScaleUp(k), -(big.binaryScaleUp(k))) << "k = " << k;
+  }
+}
+
+std::string int128ToString(__int128 value) {
+  if (value == 0) return "0";
+  bool negative = value < 0;
+  unsigned __int128 magnitude = negative? -static_cast<unsigned __int128>(value): value;
+  std::string result;
+  for (; magnitude != 0; magnitude /= 10) result.push_back('0' + magnitude % 10);
+  if (negative) result.push_back('-');
+  std::reverse(result.begin(), result.end());
+  return result;
+}
+
+TEST(BigIntTests, DoubleWordOperations) {
+  std::mt19937_64 gen(17);
+  for (int i = 0; i < 2000; ++i) {
+    long long a = gen(), b = gen() >> (gen() % 63);
+    __int128 product = static_cast<__int128>(a) * b;
+    BigInt bigProduct = BigInt(a) * BigInt(b);
+    EXPECT_EQ(bigProduct.toString(), int128ToString(product));
+    EXPECT_EQ((bigProduct + BigInt(a)).toString(), int128ToString(product + a));
+    EXPECT_EQ((bigProduct - BigInt(b)).toString(), int128ToString(product - b));
+    if (b != 0) {
+      __int128 dividend = product + (a % b);
+      BigInt bigDividend(int128ToString(dividend < 0? -dividend: dividend));
+      if (dividend < 0) bigDividend = -bigDividend;
+      EXPECT_EQ((bigDividend / BigInt(b)).toString(), int128ToString(dividend / b));
+      EXPECT_EQ((bigDividend % BigInt(b)).toString(), int128ToString(dividend % b));
+    }
+  }
+}
+
+BigInt randomBigInt(std::mt19937_64& gen, int digits) {
+  std::string str(digits, '0');
+  for (auto& c : str) c = '0' + gen() % 10;
+  str[0] = '1' + gen() % 9;
+  return BigInt(str);
+}
+
+// Restores the multiplication and conversion thresholds when a test finishes
+struct ThresholdGuard {
+  int karatsuba = BigInt::KARATSUBA_THRESHOLD;
+  int toom3 = BigInt::TOOM3_THRESHOLD;
+  int ntt = BigInt::NTT_THRESHOLD;
+  int radixSplit = BigInt::RADIX_SPLIT_THRESHOLD;
+  int barrett = BigInt::BARRETT_THRESHOLD;
+  ~ThresholdGuard() {
+    BigInt::KARATSUBA_THRESHOLD = karatsuba;
+    BigInt::TOOM3_THRESHOLD = toom3;
+    BigInt::NTT_THRESHOLD = ntt;
+    BigInt::RADIX_SPLIT_THRESHOLD = radixSplit;
+    BigInt::BARRETT_THRESHOLD = barrett;
+  }
+};
+
+TEST(BigIntTests, MultiplicationTiers) {
+  ThresholdGuard guard;
+  std::mt19937_64 gen(23);
+  // sizes in decimal digits: balanced, unbalanced and squares, across limb boundaries
+  std::vector<std::pair<int, int>> sizes{{20, 20}, {100, 100}, {1000, 997}, {3000, 1200}, {5000, 150}, {2400, 2400}, {1, 4000}};
+  for (auto [n, m] : sizes) {
+    BigInt a = randomBigInt(gen, n), b = randomBigInt(gen, m);
+    if (gen() % 2) a = -a;
+
+    BigInt::KARATSUBA_THRESHOLD = BigInt::TOOM3_THRESHOLD = BigInt::NTT_THRESHOLD = 1 << 30;
+    BigInt schoolbook = a * b;
+    BigInt schoolbookSquare = a * a;
+    BigInt aCopy = a;
+    EXPECT_EQ(schoolbookSquare, a * aCopy);
+    EXPECT_TRUE(schoolbookSquare.positive());
+
+    BigInt::KARATSUBA_THRESHOLD = 2;
+    EXPECT_EQ(a * b, schoolbook) << n << " x " << m << " digits, Karatsuba";
+    EXPECT_EQ(a.square(), schoolbookSquare) << n << " digits, Karatsuba square";
+
+    BigInt::TOOM3_THRESHOLD = 6;
+    EXPECT_EQ(a * b, schoolbook) << n << " x " << m << " digits, Toom-3";
+    EXPECT_EQ(a.square(), schoolbookSquare) << n << " digits, Toom-3 square";
+    EXPECT_EQ((a * b) / b, a);
+  }
+}
+
+TEST(BigIntTests, NttMultiplication) {
+  ThresholdGuard guard;
+  std::mt19937_64 gen(29);
+  std::vector<std::pair<int, int>> sizes{{1, 1}, {30, 25}, {400, 399}, {5000, 37}, {6000, 6000}};
+  for (auto [n, m] : sizes) {
+    BigInt a = randomBigInt(gen, n), b = randomBigInt(gen, m);
+    BigInt::KARATSUBA_THRESHOLD = BigInt::TOOM3_THRESHOLD = BigInt::NTT_THRESHOLD = 1 << 30;
+    BigInt schoolbook = a * b;
+    BigInt schoolbookSquare = a.square();
+
+    BigInt::KARATSUBA_THRESHOLD = BigInt::NTT_THRESHOLD = 1;
+    EXPECT_EQ(a * b, schoolbook) << n << " x " << m << " digits";
+    EXPECT_EQ(a.square(), schoolbookSquare) << n << " digits, square";
+  }
+
+  // all-ones limbs give the largest convolution coefficients
+  BigInt allOnes = BigInt(1).binaryScaleUp(64 * 3000) - 1;
+  BigInt::KARATSUBA_THRESHOLD = BigInt::NTT_THRESHOLD = 1;
+  BigInt nttSquare = allOnes * allOnes;
+  EXPECT_EQ(nttSquare, BigInt(1).binaryScaleUp(2 * 64 * 3000) - BigInt(1).binaryScaleUp(64 * 3000 + 1) + 1);
+
+  // 1000! computed with the NTT path at every size
+  BigInt factorial = 1;
+  for (int i = 2; i <= 1000; ++i) factorial *= i;
+  std::string digits = factorial.toString();
+  EXPECT_EQ(digits.size(), 2568);
+  EXPECT_EQ(digits.substr(0, 20), "40238726007709377354");
+}
+
+TEST(BigIntTests, RadixConversion) {
+  ThresholdGuard guard;
+  std::mt19937_64 gen(37);
+  for (int digits : {1, 19, 20, 457, 3000, 20000}) {
+    std::string str(digits, '0');
+    for (auto& c : str) c = '0' + gen() % 10;
+    str[0] = '1' + gen() % 9;
+    if (digits > 100) std::fill(str.begin() + digits / 3, str.begin() + digits / 2, '0'); // zero run across splits
+
+    // reference value, one 19-digit chunk at a time
+    BigInt expected = 0;
+    for (int i = 0; i < digits; i += 19) {
+      std::string chunk = str.substr(i, 19);
+      BigInt scale = 1;
+      for (std::size_t j = 0; j < chunk.size(); ++j) scale *= 10;
+      expected = expected * scale + BigInt(std::stoull(chunk));
+    }
+
+    // defaults, then thresholds low enough to force the split and the Newton reciprocals
+    for (auto [radixSplit, barrett] : {std::pair{BigInt::RADIX_SPLIT_THRESHOLD, BigInt::BARRETT_THRESHOLD}, std::pair{1, 2}}) {
+      BigInt::RADIX_SPLIT_THRESHOLD = radixSplit;
+      BigInt::BARRETT_THRESHOLD = barrett;
+      EXPECT_EQ(BigInt(str), expected) << digits << " digits";
+      EXPECT_EQ(expected.toString(), str) << digits << " digits";
+      EXPECT_EQ((-expected).toString(), "-" + str) << digits << " digits";
+    }
+  }
+
+  // power-of-two bases
+  EXPECT_EQ(BigInt(1).binaryScaleUp(200).toString(16), "1" + std::string(50, '0'));
+  EXPECT_EQ(BigInt(-5).toString(2), "-101");
+  EXPECT_EQ(BigInt(0).toString(16), "0");
+  EXPECT_EQ(BigInt(std::numeric_limits<uint64_t>::max()).toString(32), "f" + std::string(12, 'v'));
+  // an unsupported base throws without leaving the profiler mid-measurement
+  EXPECT_THROW(BigInt(12345).toString(7), std::invalid_argument);
+  EXPECT_NO_THROW(PROFILE_RESULTS("after an unsupported base"));
+  BigInt value = randomBigInt(gen, 700);
+  for (int base : {2, 4, 8, 16, 32}) {
+    std::string digits = value.toString(base);
+    BigInt parsed = 0;
+    auto [end, error] = BigInt::fromChars(digits.data(), digits.data() + digits.size(), parsed, base);
+    EXPECT_EQ(error, std::errc());
+    EXPECT_EQ(end, digits.data() + digits.size());
+    EXPECT_EQ(parsed, value) << "base " << base;
+  }
+  std::string upper = "-DEADBEEF";
+  BigInt parsed = 0;
+  BigInt::fromChars(upper.data(), upper.data() + upper.size(), parsed, 16);
+  EXPECT_EQ(parsed, BigInt(-3735928559ll));
+
+  // caller-provided buffers
+  char buffer[8];
+  auto [end, error] = BigInt(-1234567).toChars(buffer, buffer + 8);
+  EXPECT_EQ(error, std::errc());
+  EXPECT_EQ(std::string(buffer, end), "-1234567");
+  EXPECT_EQ(BigInt(123456789).toChars(buffer, buffer + 8).ec, std::errc::value_too_large);
+  EXPECT_EQ(BigInt(12345678).toChars(buffer, buffer + 8).ec, std::errc());
+  EXPECT_EQ(BigInt(12345678).toChars(buffer, buffer + 8, 7).ec, std::errc::invalid_argument);
+
+  // parsing stops at the first non-digit and leaves value untouched on failure
+  std::string text = "-123abc";
+  auto result = BigInt::fromChars(text.data(), text.data() + text.size(), parsed);
+  EXPECT_EQ(result.ec, std::errc());
+  EXPECT_EQ(result.ptr, text.data() + 4);
+  EXPECT_EQ(parsed, BigInt(-123));
+  text = "xyz";
+  EXPECT_EQ(BigInt::fromChars(text.data(), text.data() + text.size(), parsed).ec, std::errc::invalid_argument);
+  EXPECT_EQ(parsed, BigInt(-123));
+}
+
+TEST(BigIntTests, InPlaceOperations) {
+  std::mt19937_64 gen(41);
+  for (int trial = 0; trial < 500; ++trial) {
+    BigInt a = randomBigInt(gen, 1 + gen() % 80), b = randomBigInt(gen, 1 + gen() % 80);
+    BigInt c = trial % 3 ? BigInt(static_cast<long long>(gen() >> 1)) : randomBigInt(gen, 1 + gen() % 40);
+    if (gen() % 2) a = -a;
+    if (gen() % 2) b = -b;
+    if (gen() % 2) c = -c;
+    int shift = gen() % 200;
+
+    BigInt x = a;
+    EXPECT_EQ(x += b, a + b);
+    x = a;
+    EXPECT_EQ(x -= b, a - b);
+    x = a;
+    EXPECT_EQ(x *= b, a * b);
+    x = a;
+    EXPECT_EQ(x.addmul(b, c), a + b * c);
+    x = a;
+    EXPECT_EQ(x.addmul(c, b), a + b * c);
+    x = a;
+    EXPECT_EQ(x.submul(b, c), a - b * c);
+    x = a;
+    EXPECT_EQ(x <<= shift, a.binaryScaleUp(shift));
+    x = a;
+    EXPECT_EQ(x >>= shift, a.binaryScaleDown(shift));
+  }
+
+  // aliasing operands
+  BigInt x = -BigInt("123456789012345678901234567890");
+  BigInt copy = x;
+  EXPECT_EQ(x += x, copy + copy);
+  x = copy;
+  EXPECT_TRUE((x -= x).zero());
+  x = copy;
+  EXPECT_EQ(x *= x, copy * copy);
+  x = copy;
+  EXPECT_EQ(x.addmul(x, x), copy + copy * copy);
+  x = 7;
+  EXPECT_EQ(x.submul(x, x), BigInt(-42));
+
+  // crossing zero and word boundaries
+  BigInt y = -1;
+  EXPECT_TRUE((++y).zero());
+  EXPECT_FALSE(y.negative());
+  EXPECT_EQ(--y, BigInt(-1));
+  y = std::numeric_limits<uint64_t>::max();
+  EXPECT_EQ((++y).toString(), "18446744073709551616");
+  EXPECT_EQ((--y).toString(), "18446744073709551615");
+  y = 5;
+  EXPECT_EQ(y.submul(BigInt(2), BigInt(3)), BigInt(-1));
+  EXPECT_TRUE(y.addmul(BigInt(1), BigInt(1)).zero());
+  EXPECT_FALSE(y.negative());
+  EXPECT_TRUE((BigInt(-3) >>= 2).zero());
+  EXPECT_FALSE((BigInt(-3) >>= 2).negative());
+
+  // accumulation reuses the limb storage once it has grown
+  BigInt sum = BigInt(1).binaryScaleUp(64 * 20);
+  sum -= 1;
+  const uint64_t* storage = sum.bits.data();
+  BigInt step = randomBigInt(gen, 100);
+  for (int i = 0; i < 1000; ++i) {
+    sum += step;
+    sum -= step;
+    ++sum;
+    sum.addmul(step, BigInt(3));
+    sum.submul(step, BigInt(3));
+  }
+  EXPECT_EQ(sum.bits.data(), storage);
+  EXPECT_EQ(sum, BigInt(1).binaryScaleUp(64 * 20) + 999);
+}
+
+// limbs drawn from extreme patterns, which exercise the quotient-limb corrections in long division
+BigInt patternBigInt(std::mt19937_64 &gen, int limbs) {
+  const uint64_t patterns[] = {0, 1, ~uint64_t{0}, uint64_t{1} << 63, (uint64_t{1} << 63) - 1};
+  BigInt result = 0;
+  for (int i = 0; i < limbs; ++i) {
+    uint64_t limb = gen() % 3 ? patterns[gen() % 5] : gen();
+    result <<= 64;
+    result += BigInt(limb);
+  }
+  return result;
+}
+
+TEST(BigIntTests, LongDivision) {
+  std::mt19937_64 gen(31);
+  for (int trial = 0; trial < 2000; ++trial) {
+    int n = 1 + gen() % 12, m = 1 + gen() % 8;
+    BigInt a = trial % 2 ? patternBigInt(gen, n) : randomBigInt(gen, 1 + gen() % 230);
+    BigInt b = trial % 2 ? patternBigInt(gen, m) : randomBigInt(gen, 1 + gen() % 120);
+    if (b.zero()) continue;
+    if (gen() % 2) a = -a;
+    if (gen() % 2) b = -b;
+    auto [quotient, remainder] = a.divmod(b);
+    EXPECT_EQ(quotient * b + remainder, a) << a.toString() << " / " << b.toString();
+    BigInt absRemainder = remainder.negative() ? -remainder : remainder, absB = b.negative() ? -b : b;
+    EXPECT_LT(absRemainder, absB);
+    EXPECT_TRUE(remainder.zero() || remainder.negative() == a.negative());
+    EXPECT_EQ(a / b, quotient);
+    EXPECT_EQ(a % b, remainder);
+  }
 
-  // EXPECT_EQ(BigInt(1).binaryScaleUp(200).toString(), "1606938044258990275541962092341162602522202993782792835301376");
+  // smaller dividend, equal operands and an exact multi-limb quotient
+  BigInt big("340282366920938463463374607431768211457"); // 2^128 + 1
+  EXPECT_EQ(BigInt(5).divmod(big), std::make_pair(BigInt(0), BigInt(5)));
+  EXPECT_EQ(big.divmod(big), std::make_pair(BigInt(1), BigInt(0)));
+  EXPECT_EQ(big.divmod(-big), std::make_pair(BigInt(-1), BigInt(0)));
+  BigInt factor("18446744073709551629"); // 2^64 + 13
+  EXPECT_EQ((big * factor).divmod(factor), std::make_pair(big, BigInt(0)));
+  EXPECT_THROW(big.divmod(0), std::runtime_error);
 }
 
 TEST(BigIntTests, Operations) {
@@ -94,58 +419,58 @@ TEST(BigIntTests, SpecialOperations) {
 }
 
 TEST(BigIntTests, SpeedProfiling) {
+  // operands of roughly the given number of bits
   std::unordered_map<std::string, std::unordered_map<int, int>> times;
-  std::vector<int> bases{1, 2, 4, 8};
-  for (int base : bases) {
-    BigInt::BASE = base;
-    BigInt::BIT_SIZE = static_cast<uint64_t>(1) << base;
+  std::vector<int> sizes{256, 1024, 4096, 16384};
+  for (int size : sizes) {
+    std::string digits(size * 3 / 10, '7');
 
     auto startTime = std::chrono::high_resolution_clock::now();
-    BigInt num("123456789");
+    BigInt num(digits);
     auto endTime = std::chrono::high_resolution_clock::now();
-    times["Building BigInt from strig took"][base] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    times["Building BigInt from string took"][size] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
   
     startTime = std::chrono::high_resolution_clock::now();
     BigInt scaledNum = 1;
-    scaledNum = scaledNum.binaryScaleUp(100);
+    scaledNum = scaledNum.binaryScaleUp(2 * size) + 12345;
     endTime = std::chrono::high_resolution_clock::now();
-    times["Scaling long string took"][base] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    times["Scaling long string took"][size] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
 
     startTime = std::chrono::high_resolution_clock::now();
     scaledNum.toString();
     endTime = std::chrono::high_resolution_clock::now();
-    times["Printing large num to string took"][base] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    times["Printing large num to string took"][size] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
 
     startTime = std::chrono::high_resolution_clock::now();
-    BigInt result = scaledNum * num;
+    BigInt result = num * num;
     endTime = std::chrono::high_resolution_clock::now();
-    times["Multiplying two large nums took"][base] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    times["Multiplying two large nums took"][size] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
 
     startTime = std::chrono::high_resolution_clock::now();
     result = scaledNum / num;
     endTime = std::chrono::high_resolution_clock::now();
-    times["Dividing two large nums took"][base] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    times["Dividing two large nums took"][size] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
 
     startTime = std::chrono::high_resolution_clock::now();
     result = scaledNum + num;
     endTime = std::chrono::high_resolution_clock::now();
-    times["Adding two large nums took"][base] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    times["Adding two large nums took"][size] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
 
     startTime = std::chrono::high_resolution_clock::now();
     long long val = scaledNum.binaryScaleDown(50).toNum();
     ++val;
     endTime = std::chrono::high_resolution_clock::now();
-    times["Transforming to int value took"][base] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    times["Transforming to int value took"][size] = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
   }
   
   TableDisplay table{40, 12, 12, 12, 12};
-  std::vector<std::string> baseHeaders(bases.size());
-  std::transform(bases.begin(), bases.end(), baseHeaders.begin(), [](int base) {return "Base == " + std::to_string(base); });
-  table.printHeader("Operation", baseHeaders.begin(), baseHeaders.end());
+  std::vector<std::string> sizeHeaders(sizes.size());
+  std::transform(sizes.begin(), sizes.end(), sizeHeaders.begin(), [](int size) {return "Bits ~ " + std::to_string(size); });
+  table.printHeader("Operation", sizeHeaders.begin(), sizeHeaders.end());
 
   for (auto& time : times) {
-    std::vector<std::string> operationTimes(bases.size());
-    std::transform(bases.begin(), bases.end(), operationTimes.begin(), [&time](int base) {return std::to_string(time.second[base]) + " ms"; });
+    std::vector<std::string> operationTimes(sizes.size());
+    std::transform(sizes.begin(), sizes.end(), operationTimes.begin(), [&time](int size) {return std::to_string(time.second[size]) + " us"; });
     table.printRow(time.first, operationTimes.begin(), operationTimes.end());
   }
   std::cout << std::endl;
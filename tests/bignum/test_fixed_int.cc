@@ -0,0 +1,136 @@
+#include "gtest/gtest.h"
+
+#include "bignum/fixed_int.h"
+#include "chapter31/number_theoretic.h"
+#include "helpers/random_generators.h"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+
+using namespace BigNum;
+
+namespace {
+  // a random value of up to bits bits, negative half the time
+  BigInt randomSignedBigInt(std::mt19937_64& gen, int bits) {
+    BigInt result = randomBigInt(gen, gen() % (bits + 1));
+    return gen() % 2 ? -result : result;
+  }
+
+  // value reduced into the signed range of a Bits-bit two's complement integer
+  template <int Bits>
+  BigInt wrap(const BigInt& value) {
+    BigInt modulus = BigInt(1).binaryScaleUp(Bits);
+    BigInt result = value % modulus;
+    if (result.negative()) result += modulus;
+    if (result >= BigInt(1).binaryScaleUp(Bits - 1)) result -= modulus;
+    return result;
+  }
+
+  template <int Bits>
+  void checkAgainstBigInt(std::mt19937_64& gen) {
+    using Fixed = FixedInt<Bits>;
+    std::vector<BigInt> values{BigInt(0), BigInt(1), -BigInt(1), BigInt(-2),
+                               BigInt(1).binaryScaleUp(Bits - 1) - 1, -BigInt(1).binaryScaleUp(Bits - 1)};
+    for (int i = 0; i < 40; ++i) values.push_back(randomSignedBigInt(gen, (i % 4 + 1) * Bits / 4 - 1));
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      const BigInt& a = values[i];
+      const BigInt& b = values[(i * 7 + 3) % values.size()];
+      Fixed x(a), y(b);
+      EXPECT_EQ(x.toBigInt(), a);
+      EXPECT_EQ((x + y).toBigInt(), wrap<Bits>(a + b)) << a.toString() << " + " << b.toString();
+      EXPECT_EQ((x - y).toBigInt(), wrap<Bits>(a - b)) << a.toString() << " - " << b.toString();
+      EXPECT_EQ((x * y).toBigInt(), wrap<Bits>(a * b)) << a.toString() << " * " << b.toString();
+      EXPECT_EQ((-x).toBigInt(), wrap<Bits>(-a));
+      EXPECT_EQ(x < y, wrap<Bits>(a) < wrap<Bits>(b));
+      EXPECT_EQ(x == y, a == b);
+      if (!b.zero() && !(a == -BigInt(1).binaryScaleUp(Bits - 1) && b == -BigInt(1))) {
+        EXPECT_EQ((x / y).toBigInt(), a / b) << a.toString() << " / " << b.toString();
+        EXPECT_EQ((x % y).toBigInt(), a % b) << a.toString() << " % " << b.toString();
+      }
+      EXPECT_EQ(x.half().toBigInt(), a.half());
+      EXPECT_EQ(x.binaryScaleDown(Bits / 3).toBigInt(), a.binaryScaleDown(Bits / 3));
+      EXPECT_EQ(x.binaryScaleUp(Bits / 3 + 1).toBigInt(), wrap<Bits>(a.binaryScaleUp(Bits / 3 + 1)));
+      EXPECT_EQ(x.toString(), a.toString());
+      EXPECT_EQ(Fixed(a.toString()), x);
+    }
+  }
+}
+
+TEST(FixedIntTests, Construction) {
+  EXPECT_EQ(Int128(0).toString(), "0");
+  EXPECT_EQ(Int128(-1).toBigInt(), -BigInt(1));
+  EXPECT_EQ(Int256(std::numeric_limits<long long>::min()).toBigInt(), BigInt(std::numeric_limits<long long>::min()));
+  EXPECT_EQ(Int128(std::numeric_limits<uint64_t>::max()).toBigInt(), BigInt(std::numeric_limits<uint64_t>::max()));
+  // unsigned values narrower than a limb are zero-extended, signed ones sign-extended
+  EXPECT_EQ(Int128(uint8_t{200}).toBigInt(), BigInt(200));
+  EXPECT_EQ(Int128(uint16_t{0xFFFF}).toBigInt(), BigInt(0xFFFF));
+  EXPECT_EQ(Int128(uint32_t{0xFFFFFFFF}).toBigInt(), BigInt(0xFFFFFFFFll));
+  EXPECT_EQ(Int256(static_cast<unsigned char>(200)), Int256(200));
+  EXPECT_EQ(Int128(int8_t{-56}).toBigInt(), -BigInt(56));
+  EXPECT_EQ(Int128(int32_t{-1}), Int128(-1));
+  EXPECT_EQ((Int128(-5) << 80).toBigInt(), -BigInt(5).binaryScaleUp(80));
+  EXPECT_EQ(Int128("-170141183460469231731687303715884105728").toString(), "-170141183460469231731687303715884105728");
+  EXPECT_EQ(Int128("340282366920938463463374607431768211457"), Int128(1)); // wraps modulo 2^128
+  EXPECT_EQ(FixedInt<64>(BigInt(1).binaryScaleUp(64) + 7), FixedInt<64>(7));
+  EXPECT_THROW(Int128("12a"), std::out_of_range);
+  EXPECT_THROW(Int128("-"), std::out_of_range);
+  EXPECT_THROW(Int128(1) / Int128(0), std::runtime_error);
+
+  // the whole value lives in the object, and simple arithmetic folds at compile time
+  static_assert(sizeof(Int256) == 32);
+  static_assert(Int128(3) * Int128(-4) + Int128(20) == Int128(8));
+  static_assert((Int256(1) << 200).binaryScaleDown(199) == Int256(2));
+  static_assert(Int512(-7) / Int512(2) == Int512(-3) && Int512(-7) % Int512(2) == Int512(-1));
+}
+
+TEST(FixedIntTests, MatchesBigInt) {
+  std::mt19937_64 gen(53);
+  checkAgainstBigInt<64>(gen);
+  checkAgainstBigInt<128>(gen);
+  checkAgainstBigInt<192>(gen);
+  checkAgainstBigInt<256>(gen);
+  checkAgainstBigInt<512>(gen);
+  checkAgainstBigInt<2048>(gen);
+}
+
+TEST(FixedIntTests, SpecialCases) {
+  Int256 x("-12345678901234567890123456789");
+  EXPECT_TRUE(x.negative());
+  EXPECT_FALSE(x.positive());
+  EXPECT_TRUE(x.odd());
+  EXPECT_TRUE(x.twice().even());
+  EXPECT_EQ(x.twice().half(), x);
+  EXPECT_EQ(x >> 1, x.half() - Int256(1)); // arithmetic shift rounds down
+  EXPECT_TRUE(Int256(1).one());
+  EXPECT_TRUE(Int256(0).zero());
+  Int256 y = x;
+  EXPECT_EQ(y++, x);
+  EXPECT_EQ(--y, x);
+  EXPECT_EQ(IntType::half(x), x.half());
+  EXPECT_TRUE(IntType::odd(x));
+  EXPECT_EQ(IntType::binary_scale_up(x, 3), x * Int256(8));
+}
+
+TEST(FixedIntTests, NumberTheory) {
+  EXPECT_EQ(NumberTheory::gcd(Int256(0), Int256(0)), Int256(0));
+  EXPECT_EQ(NumberTheory::gcd(Int256(12), Int256(0)), Int256(12));
+
+  std::mt19937_64 gen(59);
+  for (int i = 0; i < 20; ++i) {
+    BigInt common = randomBigInt(gen, 60) + 1;
+    BigInt a = randomBigInt(gen, 90) * common, b = randomBigInt(gen, 90) * common;
+    Int256 x(a), y(b);
+    Int256 d = NumberTheory::gcd(x, y);
+    EXPECT_EQ(d, NumberTheory::gcd(y, x));
+    EXPECT_TRUE((x % d).zero() && (y % d).zero());
+    EXPECT_EQ(d.toBigInt() % common, BigInt(0));
+
+    auto [g, s, t] = NumberTheory::extendedEuclid(x, y);
+    EXPECT_EQ(g, d);
+    EXPECT_EQ(x * s + y * t, g);
+  }
+}
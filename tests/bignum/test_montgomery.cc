@@ -0,0 +1,153 @@
+#include "gtest/gtest.h"
+
+#include "bignum/montgomery.h"
+#include "helpers/random_generators.h"
+
+#include <random>
+#include <stdexcept>
+
+
+using namespace BigNum;
+
+namespace {
+  BigInt randomOddModulus(std::mt19937_64& gen, int limbs) {
+    BigInt result = BigInt(1).binaryScaleUp(64 * limbs) + randomBigInt(gen, 64 * limbs);
+    result = result.binaryScaleDown(gen() % 64);
+    return result.even() ? result + 1 : result;
+  }
+
+  // right-to-left square-and-multiply with a full division per step
+  BigInt naivePowmod(BigInt base, BigInt exponent, const BigInt& modulus) {
+    BigInt result = 1;
+    base = base % modulus;
+    if (base.negative()) base += modulus;
+    while (!exponent.zero()) {
+      if (exponent.odd()) result = result * base % modulus;
+      base = base * base % modulus;
+      exponent = exponent.half();
+    }
+    return result % modulus;
+  }
+}
+
+TEST(MontgomeryTests, RejectsInvalidModuli) {
+  EXPECT_THROW(MontgomeryContext(BigInt(0)), std::invalid_argument);
+  EXPECT_THROW(MontgomeryContext(BigInt(1)), std::invalid_argument);
+  EXPECT_THROW(MontgomeryContext(BigInt(10)), std::invalid_argument);
+  EXPECT_THROW(MontgomeryContext(BigInt(-7)), std::invalid_argument);
+  EXPECT_NO_THROW(MontgomeryContext(BigInt(3)));
+}
+
+TEST(MontgomeryTests, MultiplicationMatchesDivision) {
+  std::mt19937_64 gen(43);
+  std::vector<BigInt> moduli{BigInt(3), BigInt(std::numeric_limits<uint64_t>::max()),
+                             BigInt(1).binaryScaleUp(128) - 1, BigInt(1).binaryScaleUp(192) + 1};
+  for (int limbs : {1, 2, 3, 4, 8, 17, 33}) moduli.push_back(randomOddModulus(gen, limbs));
+
+  for (const auto& modulus : moduli) {
+    MontgomeryContext context(modulus);
+    std::vector<BigInt> values{BigInt(0), BigInt(1), modulus - 1, -BigInt(5), modulus + 2};
+    for (int i = 0; i < 20; ++i) values.push_back(randomBelow(gen, modulus));
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      const BigInt& a = values[i];
+      const BigInt& b = values[(i * 7 + 3) % values.size()];
+      BigInt expected = a * b % modulus;
+      if (expected.negative()) expected += modulus;
+      EXPECT_EQ(context.mulmod(a, b), expected) << a.toString() << " * " << b.toString() << " mod " << modulus.toString();
+
+      // Montgomery-form operations, with aliased outputs
+      auto x = context.toMontgomery(a), y = context.toMontgomery(b);
+      EXPECT_EQ(context.fromMontgomery(x), (a % modulus + modulus) % modulus);
+      auto product = x;
+      context.mulmod(product.data(), y.data(), product.data());
+      EXPECT_EQ(context.fromMontgomery(product), expected);
+      auto square = x, squareByMultiply = x;
+      context.sqrmod(square.data(), square.data());
+      context.mulmod(x.data(), x.data(), squareByMultiply.data());
+      EXPECT_EQ(square, squareByMultiply) << a.toString() << "^2 mod " << modulus.toString();
+    }
+    EXPECT_EQ(context.fromMontgomery(context.one()), BigInt(1));
+  }
+}
+
+TEST(MontgomeryTests, Exponentiation) {
+  std::mt19937_64 gen(47);
+  for (int limbs : {1, 2, 5, 16}) {
+    BigInt modulus = randomOddModulus(gen, limbs);
+    MontgomeryContext context(modulus);
+    for (int exponentBits : {0, 1, 2, 7, 9, 30, 100, 300, 1000}) {
+      BigInt base = randomBelow(gen, modulus);
+      BigInt exponent = exponentBits == 0 ? BigInt(0) : randomBelow(gen, BigInt(1).binaryScaleUp(exponentBits));
+      EXPECT_EQ(context.powmod(base, exponent), naivePowmod(base, exponent, modulus))
+          << base.toString() << "^" << exponent.toString() << " mod " << modulus.toString();
+    }
+  }
+
+  // Fermat's little theorem for the Mersenne primes 2^127 - 1 and 2^521 - 1
+  for (int p : {127, 521}) {
+    BigInt prime = BigInt(1).binaryScaleUp(p) - 1;
+    MontgomeryContext context(prime);
+    for (int i = 0; i < 5; ++i) {
+      BigInt a = randomBelow(gen, prime - 2) + 2;
+      EXPECT_EQ(context.powmod(a, prime - 1), BigInt(1));
+      EXPECT_EQ(context.powmod(a, prime), a);
+    }
+  }
+
+  MontgomeryContext context(BigInt(1000003));
+  EXPECT_EQ(context.powmod(BigInt(0), BigInt(0)), BigInt(1));
+  EXPECT_EQ(context.powmod(BigInt(0), BigInt(5)), BigInt(0));
+  EXPECT_EQ(context.powmod(BigInt(-2), BigInt(3)), BigInt(1000003 - 8));
+  EXPECT_THROW(context.powmod(BigInt(2), BigInt(-1)), std::invalid_argument);
+
+  // windows widen with the exponent
+  int previous = 0;
+  for (int bits = 1; bits < 4000; bits += 37) {
+    int window = MontgomeryContext::windowBits(bits);
+    EXPECT_GE(window, previous);
+    previous = window;
+  }
+}
+
+TEST(MontgomeryTests, AdditionAndHalving) {
+  std::mt19937_64 gen(89);
+  for (int limbs : {1, 2, 7}) {
+    BigInt modulus = randomOddModulus(gen, limbs);
+    MontgomeryContext context(modulus);
+    for (int i = 0; i < 20; ++i) {
+      BigInt a = i == 0 ? modulus - 1 : randomBelow(gen, modulus), b = i == 1 ? BigInt(0) : randomBelow(gen, modulus);
+      auto x = context.toMontgomery(a), y = context.toMontgomery(b), out = x;
+      context.addmod(x.data(), y.data(), out.data());
+      EXPECT_EQ(context.fromMontgomery(out), (a + b) % modulus);
+      context.submod(x.data(), y.data(), out.data());
+      EXPECT_EQ(context.fromMontgomery(out), (a - b + modulus) % modulus);
+      // halving then doubling is the identity
+      context.halve(x.data(), out.data());
+      context.addmod(out.data(), out.data(), out.data());
+      EXPECT_EQ(out, x);
+    }
+  }
+}
+
+TEST(MontgomeryTests, SingleLimb) {
+  EXPECT_THROW(Montgomery64(10), std::invalid_argument);
+  EXPECT_THROW(Montgomery64(1), std::invalid_argument);
+
+  std::mt19937_64 gen(97);
+  for (uint64_t modulus : {uint64_t{3}, uint64_t{1000003}, std::numeric_limits<uint64_t>::max(), gen() | 1, (gen() >> 20) | 1}) {
+    Montgomery64 context(modulus);
+    for (int i = 0; i < 50; ++i) {
+      uint64_t a = gen(), b = gen() % modulus;
+      uint64_t x = context.toMontgomery(a), y = context.toMontgomery(b);
+      EXPECT_EQ(context.fromMontgomery(x), a % modulus);
+      uint64_t expected = static_cast<uint64_t>(static_cast<unsigned __int128>(a % modulus) * b % modulus);
+      EXPECT_EQ(context.fromMontgomery(context.mulmod(x, y)), expected);
+      EXPECT_EQ(context.fromMontgomery(context.addmod(x, y)), static_cast<uint64_t>((static_cast<unsigned __int128>(a % modulus) + b) % modulus));
+      EXPECT_EQ(context.fromMontgomery(context.submod(x, y)), static_cast<uint64_t>((static_cast<unsigned __int128>(a % modulus) + (modulus - b)) % modulus));
+      uint64_t exponent = gen() % 1000;
+      EXPECT_EQ(BigInt(context.fromMontgomery(context.powmod(x, exponent))),
+                naivePowmod(BigInt(a), BigInt(exponent), BigInt(modulus)));
+    }
+    EXPECT_EQ(context.fromMontgomery(context.one()), 1u);
+  }
+}
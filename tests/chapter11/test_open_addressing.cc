@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+
+#include "chapter11/open_addressing.h"
+
+#include "fixtures/hash_map_fixture.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using Chapter11::FlatHashMap;
+
+using MyHashMaps = ::testing::Types<FlatHashMap<int, int>, FlatHashMap<std::string, int>, FlatHashMap<int, std::string>>;
+
+INSTANTIATE_TYPED_TEST_SUITE_P(FlatHashMaps, HashMapTest, MyHashMaps);
+
+namespace {
+  struct ConstantHash {
+    std::size_t operator()(int) const { return 42; }
+  };
+
+  struct StringHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+  };
+
+  // random control bytes, weighted towards the special values
+  std::vector<Chapter11::ControlByte> randomControlBytes(std::mt19937_64 &gen, int count) {
+    std::vector<Chapter11::ControlByte> bytes(count);
+    for (auto &byte : bytes) {
+      switch (gen() % 4) {
+        case 0: byte = Chapter11::CTRL_EMPTY; break;
+        case 1: byte = Chapter11::CTRL_DELETED; break;
+        case 2: byte = Chapter11::CTRL_SENTINEL; break;
+        default: byte = static_cast<Chapter11::ControlByte>(gen() % 4);
+      }
+    }
+    return bytes;
+  }
+
+  template <typename Mask>
+  std::vector<int> positions(Mask mask) {
+    std::vector<int> result;
+    for (; mask; mask.clearLowest()) result.push_back(mask.lowest());
+    return result;
+  }
+}
+
+TEST(FlatHashMapTests, PortableGroup) {
+  using Chapter11::GroupPortable;
+  std::mt19937_64 gen(1);
+  for (int trial = 0; trial < 2000; ++trial) {
+    auto bytes = randomControlBytes(gen, GroupPortable::WIDTH);
+    GroupPortable group(bytes.data());
+    std::vector<int> empty, emptyOrDeleted, full;
+    for (int i = 0; i < GroupPortable::WIDTH; ++i) {
+      if (bytes[i] == Chapter11::CTRL_EMPTY) empty.push_back(i);
+      if (bytes[i] < Chapter11::CTRL_SENTINEL) emptyOrDeleted.push_back(i);
+      if (bytes[i] == 1) full.push_back(i);
+    }
+    EXPECT_EQ(positions(group.matchEmpty()), empty);
+    EXPECT_EQ(positions(group.matchEmptyOrDeleted()), emptyOrDeleted);
+    int leading = 0;
+    while (leading < GroupPortable::WIDTH && bytes[leading] < Chapter11::CTRL_SENTINEL) ++leading;
+    EXPECT_EQ(group.countLeadingEmptyOrDeleted(), leading);
+    // match may add false positives, but only on other full bytes
+    auto matched = positions(group.match(1));
+    for (int i : full) EXPECT_NE(std::find(matched.begin(), matched.end(), i), matched.end());
+    for (int i : matched) EXPECT_GE(bytes[i], 0);
+  }
+}
+
+#ifdef __SSE2__
+TEST(FlatHashMapTests, Sse2GroupMatchesPortable) {
+  using Chapter11::GroupPortable;
+  using Chapter11::GroupSse2;
+  std::mt19937_64 gen(2);
+  for (int trial = 0; trial < 2000; ++trial) {
+    auto bytes = randomControlBytes(gen, GroupSse2::WIDTH);
+    GroupSse2 group(bytes.data());
+    GroupPortable low(bytes.data()), high(bytes.data() + GroupPortable::WIDTH);
+    auto combine = [](std::vector<int> lowPositions, std::vector<int> highPositions) {
+      for (int i : highPositions) lowPositions.push_back(i + GroupPortable::WIDTH);
+      return lowPositions;
+    };
+    EXPECT_EQ(positions(group.matchEmpty()), combine(positions(low.matchEmpty()), positions(high.matchEmpty())));
+    EXPECT_EQ(positions(group.matchEmptyOrDeleted()),
+              combine(positions(low.matchEmptyOrDeleted()), positions(high.matchEmptyOrDeleted())));
+    int leading = low.countLeadingEmptyOrDeleted();
+    if (leading == GroupPortable::WIDTH) leading += high.countLeadingEmptyOrDeleted();
+    EXPECT_EQ(group.countLeadingEmptyOrDeleted(), leading);
+    std::vector<int> full;
+    for (int i = 0; i < GroupSse2::WIDTH; ++i) {
+      if (bytes[i] == 2) full.push_back(i);
+    }
+    EXPECT_EQ(positions(group.match(2)), full);
+  }
+}
+#endif
+
+TEST(FlatHashMapTests, ErasingMostlyLeavesSlotsEmpty) {
+  // at a steady size below the maximum load, churn neither grows the table nor fills it with
+  // deleted slots that would force rebuilds
+  FlatHashMap<int, int> map;
+  map.reserve(1000);
+  for (int i = 0; i < 1000; ++i) map[i] = i;
+  auto buckets = map.bucket_count();
+  std::mt19937_64 gen(3);
+  std::vector<int> keys(1000);
+  std::iota(keys.begin(), keys.end(), 0);
+  for (int next = 1000; next < 100000; ++next) {
+    int &victim = keys[gen() % keys.size()];
+    EXPECT_EQ(map.erase(victim), 1u);
+    map[next] = next;
+    victim = next;
+  }
+  EXPECT_EQ(map.size(), 1000u);
+  EXPECT_EQ(map.bucket_count(), buckets);
+  for (int key : keys) EXPECT_EQ(map.at(key), key);
+}
+
+TEST(FlatHashMapTests, CollidingHashes) {
+  // every key probes the same sequence of groups
+  FlatHashMap<int, int, ConstantHash> map;
+  for (int i = 0; i < 300; ++i) map.emplace(i, -i);
+  for (int i = 0; i < 300; i += 2) EXPECT_EQ(map.erase(i), 1u);
+  EXPECT_EQ(map.size(), 150u);
+  for (int i = 0; i < 300; ++i) EXPECT_EQ(map.contains(i), i % 2 == 1) << i;
+  for (int i = 0; i < 300; i += 2) map[i] = i;
+  for (int i = 0; i < 300; ++i) EXPECT_EQ(map.at(i), i % 2 ? -i : i);
+}
+
+TEST(FlatHashMapTests, HeterogeneousLookup) {
+  FlatHashMap<std::string, int, StringHash, std::equal_to<>> map{{"alpha", 1}, {"beta", 2}};
+  std::string_view beta = "beta";
+  EXPECT_EQ(map.find(beta)->second, 2);
+  EXPECT_TRUE(map.contains(std::string_view("alpha")));
+  EXPECT_EQ(map.count("gamma"), 0u);
+}
+
+TEST(FlatHashMapTests, MoveOnlyValues) {
+  FlatHashMap<int, std::unique_ptr<int>> map;
+  for (int i = 0; i < 200; ++i) map.try_emplace(i, std::make_unique<int>(i));
+  map[500] = std::make_unique<int>(500);
+  map.insert_or_assign(3, std::make_unique<int>(-3));
+  EXPECT_EQ(map.size(), 201u);
+  for (int i = 0; i < 200; ++i) EXPECT_EQ(*map.at(i), i == 3 ? -3 : i);
+  EXPECT_EQ(*map.at(500), 500);
+  FlatHashMap<int, std::unique_ptr<int>> moved = std::move(map);
+  EXPECT_EQ(moved.size(), 201u);
+  moved.rehash(0);
+  EXPECT_EQ(*moved.at(199), 199);
+}
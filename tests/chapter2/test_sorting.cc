@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 #include "chapter2/sorting.h"
 #include "fixtures/sorting_fixture.h"
+#include "helpers/random_generators.h"
 #include <functional>
 #include <utility>
 
@@ -64,14 +65,59 @@ TEST(Chapter2, SortByProductAndSum) {
   EXPECT_EQ(arr, sumArr);
 }
 
+TEST(Chapter2, BufferedMergeSortCutoffs) {
+  std::vector<int> original = {9, 3, 7, 3, 1, 8, 2, 6, 5, 4, 0, 12, 11, 10, 3, 7, 1};
+  std::vector<int> expected = original;
+  std::sort(expected.begin(), expected.end());
+  for (int cutoff : {0, 1, 2, 4, 16, 100}) {
+    std::vector<int> arr = original;
+    Chapter2::bufferedMergeSort(arr, std::less<int>(), cutoff);
+    EXPECT_EQ(arr, expected) << "cutoff = " << cutoff;
+  }
+}
+
+TEST(Chapter2, MergeSortWithReusedBuffer) {
+  std::vector<int> buffer;
+  std::vector<int> arr = {5, 2, 4, 6, 1, 3, 9, 10, 8, 7};
+  Chapter2::mergeSortWithBuffer(arr, buffer);
+  EXPECT_EQ(arr, std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+
+  std::vector<int> other = {3, 1, 2};
+  Chapter2::mergeSortWithBuffer(other, buffer, std::greater<int>());
+  EXPECT_EQ(other, std::vector<int>({3, 2, 1}));
+}
+
+TEST(Chapter2, ParallelMergeSortMatchesSequential) {
+  // sorting by the first element only makes stability visible in the result
+  std::function<bool(std::pair<int, int>, std::pair<int, int>)>
+    byFirst = [](std::pair<int, int> a, std::pair<int, int> b) { return a.first < b.first; };
+  std::vector<int> keys = generateRandomIntVector(50000, 100);
+  std::vector<std::pair<int, int>> arr(keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) arr[i] = std::pair<int, int>(keys[i], i);
+
+  std::vector<std::pair<int, int>> expected = arr;
+  Chapter2::mergeSort(expected, byFirst);
+  for (int threads : {1, 2, 3, 8}) {
+    std::vector<std::pair<int, int>> parallel = arr;
+    Chapter2::parallelMergeSort(parallel, byFirst, threads, 256);
+    EXPECT_EQ(parallel, expected) << "threads = " << threads;
+  }
+}
+
 // Provide sorting functions to be tested
 INSTANTIATE_TEST_SUITE_P(SortFunctions, SortingTest, ::testing::Values(
   Chapter2::insertionSort<int>,
   Chapter2::selectionSort<int>,
-  Chapter2::mergeSort<int>
+  Chapter2::mergeSort<int>,
+  [](std::vector<int> &vec, std::less<int> lessThan) { Chapter2::bufferedMergeSort(vec, lessThan); },
+  [](std::vector<int> &vec, std::less<int> lessThan) { Chapter2::bufferedMergeSort(vec, lessThan, 1); },
+  [](std::vector<int> &vec, std::less<int> lessThan) { Chapter2::parallelMergeSort(vec, lessThan, 4, 64); }
 )); 
 
 INSTANTIATE_TEST_SUITE_P(StableSortFunctions, StableSortingTest, ::testing::Values(
   Chapter2::insertionSort<std::pair<int, int>, PairComparator>,
-  Chapter2::mergeSort<std::pair<int, int>, PairComparator>
+  Chapter2::mergeSort<std::pair<int, int>, PairComparator>,
+  [](std::vector<std::pair<int, int>> &vec, PairComparator comp) { Chapter2::bufferedMergeSort(vec, comp); },
+  [](std::vector<std::pair<int, int>> &vec, PairComparator comp) { Chapter2::bufferedMergeSort(vec, comp, 1); },
+  [](std::vector<std::pair<int, int>> &vec, PairComparator comp) { Chapter2::parallelMergeSort(vec, comp, 4, 64); }
 )); 
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+#include "chapter2/sorting_networks.h"
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+// By the 0-1 principle a comparator network sorts every input iff it sorts every 0-1 input
+template <int N>
+void expectSortsAllBinaryInputs() {
+  for (unsigned mask = 0; mask < (1u << N); ++mask) {
+    std::vector<int> vec(N);
+    for (int i = 0; i < N; ++i) vec[i] = (mask >> i) & 1;
+    Chapter2::networkSort<N>(vec.data());
+    ASSERT_TRUE(std::is_sorted(vec.begin(), vec.end())) << "N = " << N << ", mask = " << mask;
+  }
+}
+
+TEST(Chapter2, SortingNetworksZeroOnePrinciple) {
+  [&]<int... N>(std::integer_sequence<int, N...>) {
+    (expectSortsAllBinaryInputs<N + 2>(), ...);
+  }(std::make_integer_sequence<int, 15>{});
+}
+
+TEST(Chapter2, SortingNetworkSizes) {
+  // Batcher's odd-even mergesort comparator counts for powers of two
+  static_assert(Chapter2::networkSize(2) == 1);
+  static_assert(Chapter2::networkSize(4) == 5);
+  static_assert(Chapter2::networkSize(8) == 19);
+  static_assert(Chapter2::networkSize(16) == 63);
+  for (auto [i, j] : Chapter2::SORTING_NETWORK<13>) {
+    EXPECT_LT(i, j);
+    EXPECT_LT(j, 13);
+  }
+}
+
+TEST(Chapter2, SmallSort) {
+  std::vector<double> reals{3.5, -1.0, 2.25, 8.0, 0.0, -7.5, 2.25, 1.0, 9.0, -3.0, 4.0, 6.5};
+  int n = reals.size();
+  for (int p = 0; p < n; ++p) {
+    for (int r = p; r < n; ++r) {
+      std::vector<double> vec = reals;
+      std::vector<double> expected = reals;
+      std::sort(expected.begin() + p, expected.begin() + r + 1, std::greater<double>());
+      EXPECT_TRUE(Chapter2::smallSort(vec, p, r, std::greater<double>()));
+      EXPECT_EQ(vec, expected);
+    }
+  }
+
+  std::vector<std::string> words{"network", "sort", "batcher", "odd", "even", "merge", "comparator"};
+  std::vector<std::string> sortedWords = words;
+  std::sort(sortedWords.begin(), sortedWords.end());
+  EXPECT_TRUE(Chapter2::smallSort(words, 0, words.size() - 1));
+  EXPECT_EQ(words, sortedWords);
+
+  std::vector<int> tooLarge(17, 0);
+  EXPECT_FALSE(Chapter2::smallSort(tooLarge, 0, 16));
+}
+
+TEST(Chapter2, MedianOfFive) {
+  std::vector<int> perm{1, 2, 3, 4, 5};
+  do {
+    EXPECT_EQ(Chapter2::medianOfFive(perm[0], perm[1], perm[2], perm[3], perm[4]), 3);
+    EXPECT_EQ(Chapter2::medianOfFive(perm[0], perm[1], perm[2], perm[3], perm[4], std::greater<int>()), 3);
+  } while (std::next_permutation(perm.begin(), perm.end()));
+
+  int comparisons = 0;
+  auto counting = [&comparisons](int a, int b) { ++comparisons; return a < b; };
+  EXPECT_EQ(Chapter2::medianOfFive(4, 4, 1, 9, 4, counting), 4);
+  EXPECT_EQ(comparisons, 6);
+}
@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+
+#include "chapter31/factorization.h"
+#include "chapter31/prime_testing.h"
+#include "helpers/random_generators.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+
+using BigNum::BigInt;
+using namespace NumberTheory;
+
+namespace {
+  template <typename Int>
+  Int product(const std::vector<Int>& factors) {
+    Int result = 1;
+    for (const auto& f : factors) result = result * f;
+    return result;
+  }
+}
+
+TEST(FactorizationTests, MachineIntegers) {
+  EXPECT_THROW(factor(uint64_t{0}), std::invalid_argument);
+  EXPECT_TRUE(factor(uint64_t{1}).empty());
+  EXPECT_EQ(factor(uint64_t{2}), std::vector<uint64_t>{2});
+  EXPECT_EQ(factor(uint64_t{360}), (std::vector<uint64_t>{2, 2, 2, 3, 3, 5}));
+  EXPECT_EQ(factor(uint64_t{1} << 63), std::vector<uint64_t>(63, 2));
+  EXPECT_EQ(factor(18446744073709551615ull), (std::vector<uint64_t>{3, 5, 17, 257, 641, 65537, 6700417}));
+  EXPECT_EQ(factor(4294967291ull * 4294967279ull), (std::vector<uint64_t>{4294967279ull, 4294967291ull}));
+  EXPECT_EQ(factor(4294967291ull * 4294967291ull), (std::vector<uint64_t>{4294967291ull, 4294967291ull}));
+  EXPECT_EQ(factor(18446744073709551557ull), std::vector<uint64_t>{18446744073709551557ull});
+
+  std::mt19937_64 gen(101);
+  for (int i = 0; i < 300; ++i) {
+    uint64_t n = gen() >> (gen() % 60);
+    if (n == 0) continue;
+    auto factors = factor(n);
+    EXPECT_EQ(product(factors), n);
+    for (uint64_t f : factors) EXPECT_TRUE(isPrime(f)) << f << " in " << n;
+    EXPECT_TRUE(std::is_sorted(factors.begin(), factors.end()));
+  }
+}
+
+TEST(FactorizationTests, PollardBrent) {
+  EXPECT_FALSE(pollardBrent(uint64_t{3}, 1));
+  EXPECT_EQ(pollardBrent(uint64_t{1000}, 1), 2u);
+  auto d = pollardBrent(uint64_t{1000003} * 999983, 1);
+  ASSERT_TRUE(d);
+  EXPECT_TRUE(*d == 1000003 || *d == 999983);
+
+  std::mt19937_64 gen(103);
+  for (int bits : {20, 28, 34}) {
+    BigInt p = randomPrime(gen, bits), q = randomPrime(gen, 150);
+    std::optional<BigInt> found;
+    for (uint64_t c = 1; !found && c < 5; ++c) found = pollardBrent(p * q, c);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(*found, p);
+  }
+  // a prime has nothing to find
+  EXPECT_FALSE(pollardBrent(randomPrime(gen, 100), 1, 1 << 12));
+}
+
+TEST(FactorizationTests, EllipticCurves) {
+  std::mt19937_64 gen(107);
+  // 40-bit factors of 64-bit and 200-bit numbers turn up within a handful of curves at B1 = 2000
+  for (int cofactorBits : {24, 160}) {
+    BigInt p = randomPrime(gen, 40), q = randomPrime(gen, cofactorBits);
+    std::optional<BigInt> found;
+    for (uint64_t sigma = 6; !found && sigma < 200; ++sigma) found = ecm(p * q, sigma, 2000);
+    ASSERT_TRUE(found);
+    EXPECT_TRUE(*found == p || *found == q);
+
+    if (cofactorBits == 24) {
+      uint64_t n = static_cast<uint64_t>((p * q).toNum());
+      std::optional<uint64_t> word;
+      for (uint64_t sigma = 6; !word && sigma < 200; ++sigma) word = ecm(n, sigma, 2000);
+      ASSERT_TRUE(word);
+      EXPECT_EQ(n % *word, 0u);
+      EXPECT_TRUE(*word != 1 && *word != n);
+    }
+  }
+  EXPECT_FALSE(ecm(BigInt(1).binaryScaleUp(127) - 1, 6, 2000));
+}
+
+TEST(FactorizationTests, BigIntegers) {
+  EXPECT_THROW(factor(BigInt(0)), std::invalid_argument);
+  EXPECT_TRUE(factor(BigInt(1)).empty());
+  EXPECT_EQ(factor(-BigInt(12)), (std::vector<BigInt>{BigInt(2), BigInt(2), BigInt(3)}));
+
+  // 2^128 + 1 = 59649589127497217 * 5704689200685129054721
+  BigInt fermat = BigInt(1).binaryScaleUp(128) + 1;
+  EXPECT_EQ(factor(fermat), (std::vector<BigInt>{BigInt(59649589127497217ull), BigInt("5704689200685129054721")}));
+
+  std::mt19937_64 gen(109);
+  for (int i = 0; i < 3; ++i) {
+    std::vector<BigInt> expected{BigInt(3), BigInt(3), randomPrime(gen, 20), randomPrime(gen, 30), randomPrime(gen, 36),
+                                 randomPrime(gen, 80)};
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(factor(product(expected)), expected);
+  }
+}
+
+TEST(FactorizationTests, Parallel) {
+  std::mt19937_64 gen(113);
+  BigInt p = randomPrime(gen, 32), q = randomPrime(gen, 100);
+  for (int threads : {1, 3}) {
+    std::optional<BigInt> found = findFactor(p * q, threads);
+    ASSERT_TRUE(found);
+    EXPECT_TRUE(*found == p || *found == q);
+    EXPECT_EQ(factor(p * q * BigInt(7), threads), (std::vector<BigInt>{BigInt(7), p, q}));
+  }
+}
@@ -1,3 +1,118 @@
 #include "gtest/gtest.h"
 
-#include "chapter31/number_theoretic.h"
\ No newline at end of file
+#include "chapter31/number_theoretic.h"
+#include "bignum/fixed_int.h"
+#include "helpers/random_generators.h"
+
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <tuple>
+
+
+using BigNum::BigInt;
+
+namespace {
+  // plain Euclid with a full division per step
+  BigInt euclid(BigInt a, BigInt b) {
+    if (a.negative()) a = -a;
+    if (b.negative()) b = -b;
+    while (!b.zero()) {
+      BigInt r = a % b;
+      a = std::move(b);
+      b = std::move(r);
+    }
+    return a;
+  }
+}
+
+TEST(NumberTheoreticTests, IntegralHelpers) {
+  EXPECT_EQ(IntType::half(10), 5);
+  EXPECT_EQ(IntType::twice(10), 20);
+  EXPECT_EQ(IntType::binary_scale_up(3, 4), 48);
+  EXPECT_EQ(IntType::binary_scale_down(48, 4), 3);
+  EXPECT_TRUE(IntType::even(-4));
+  EXPECT_TRUE(IntType::odd(-3));
+}
+
+
+TEST(NumberTheoreticTests, Gcd) {
+  EXPECT_EQ(NumberTheory::gcd(0LL, 0LL), 0);
+  EXPECT_EQ(NumberTheory::gcd(12LL, 0LL), 12);
+  EXPECT_EQ(NumberTheory::gcd(0LL, 12LL), 12);
+  EXPECT_EQ(NumberTheory::gcd(99LL, 78LL), 3);
+  EXPECT_EQ(NumberTheory::gcd(78LL, 99LL), 3);
+  EXPECT_EQ(NumberTheory::gcd(17LL, 5LL), 1);
+  EXPECT_EQ(NumberTheory::gcd(1LL << 40, 6LL << 20), 2LL << 20);
+  EXPECT_EQ(NumberTheory::gcd(-12LL, 18LL), 6);
+  EXPECT_EQ(NumberTheory::gcd(12, -18), 6);
+  EXPECT_EQ(NumberTheory::gcd(std::numeric_limits<uint64_t>::max(), uint64_t{3} << 62), 3u);
+
+  std::mt19937_64 gen(61);
+  for (int i = 0; i < 1000; ++i) {
+    int64_t a = static_cast<int64_t>(gen() >> (gen() % 64)), b = static_cast<int64_t>(gen() >> (gen() % 64));
+    EXPECT_EQ(NumberTheory::gcd(a, b), std::gcd(a, b)) << a << ", " << b;
+    // the generic version on a type with the IntType members
+    EXPECT_EQ(NumberTheory::binaryGcd(BigNum::Int128(a), BigNum::Int128(-b)), BigNum::Int128(std::gcd(a, b)));
+    EXPECT_EQ(NumberTheory::gcd(BigNum::Int256(a), BigNum::Int256(b)), BigNum::Int256(std::gcd(a, b)));
+  }
+}
+
+TEST(NumberTheoreticTests, BigGcd) {
+  std::mt19937_64 gen(67);
+  EXPECT_EQ(NumberTheory::gcd(BigInt(0), BigInt(0)), BigInt(0));
+  EXPECT_EQ(NumberTheory::gcd(BigInt(0), -BigInt(7)), BigInt(7));
+  BigInt big = randomBigInt(gen, 500);
+  EXPECT_EQ(NumberTheory::gcd(big, BigInt(0)), big);
+  EXPECT_EQ(NumberTheory::gcd(big, big), big);
+  EXPECT_EQ(NumberTheory::gcd(-big, big * BigInt(3)), big);
+
+  // consecutive Fibonacci numbers are coprime and take the most Euclid steps for their size
+  BigInt f0 = 0, f1 = 1;
+  for (int i = 0; i < 3000; ++i) f0 = std::exchange(f1, f0 + f1);
+  EXPECT_EQ(NumberTheory::gcd(f1, f0), BigInt(1));
+
+  for (int bits : {64, 65, 128, 200, 1000, 4000}) {
+    for (int i = 0; i < 10; ++i) {
+      BigInt common = randomBigInt(gen, 1 + gen() % bits);
+      BigInt a = randomBigInt(gen, bits) * common, b = randomBigInt(gen, bits - gen() % bits) * common;
+      BigInt expected = euclid(a, b);
+      EXPECT_EQ(NumberTheory::gcd(a, b), expected) << a.toString() << ", " << b.toString();
+      EXPECT_EQ(NumberTheory::gcd(b, -a), expected);
+      EXPECT_EQ(NumberTheory::binaryGcd(a, b), expected);
+    }
+  }
+}
+
+TEST(NumberTheoreticTests, ExtendedEuclid) {
+  // the example from CLRS section 31.2
+  auto [d, x, y] = NumberTheory::extendedEuclid(99LL, 78LL);
+  EXPECT_EQ(d, 3);
+  EXPECT_EQ(x, -11);
+  EXPECT_EQ(y, 14);
+
+  for (long long a = 1; a < 60; a += 7) {
+    for (long long b = 0; b < 60; b += 5) {
+      auto [g, s, t] = NumberTheory::extendedEuclid(a, b);
+      EXPECT_EQ(g, NumberTheory::gcd(a, b));
+      EXPECT_EQ(a * s + b * t, g) << a << ", " << b;
+    }
+  }
+
+  std::mt19937_64 gen(71);
+  for (int i = 0; i < 10; ++i) {
+    BigInt a = randomBigInt(gen, 700), b = randomBigInt(gen, 600);
+    auto [g, s, t] = NumberTheory::extendedEuclid(a, b);
+    EXPECT_EQ(g, NumberTheory::gcd(a, b));
+    EXPECT_EQ(a * s + b * t, g);
+  }
+
+  // FixedInt, wide enough that the cofactors and products of 200-bit operands do not wrap
+  for (int i = 0; i < 10; ++i) {
+    BigInt a = randomBigInt(gen, 200), b = randomBigInt(gen, 150);
+    auto [g, s, t] = NumberTheory::extendedEuclid(BigNum::Int512(a), BigNum::Int512(b));
+    EXPECT_EQ(g.toBigInt(), NumberTheory::gcd(a, b));
+    EXPECT_EQ(BigNum::Int512(a) * s + BigNum::Int512(b) * t, g);
+  }
+}
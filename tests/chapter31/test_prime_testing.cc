@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+
+#include "chapter31/prime_testing.h"
+#include "helpers/random_generators.h"
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+
+using BigNum::BigInt;
+using namespace NumberTheory;
+
+namespace {
+  std::vector<char> sieve(int limit) {
+    std::vector<char> prime(limit, 1);
+    prime[0] = prime[1] = 0;
+    for (int i = 2; i * i < limit; ++i) {
+      if (!prime[i]) continue;
+      for (int j = i * i; j < limit; j += i) prime[j] = 0;
+    }
+    return prime;
+  }
+
+  BigInt mersenne(int p) { return BigInt(1).binaryScaleUp(p) - 1; }
+}
+
+TEST(PrimeTestingTests, SmallPrimeTable) {
+  const auto& primes = smallPrimes();
+  std::vector<char> expected = sieve(SMALL_PRIME_LIMIT);
+  std::vector<uint32_t> sieved;
+  for (uint32_t i = 0; i < SMALL_PRIME_LIMIT; ++i) {
+    if (expected[i]) sieved.push_back(i);
+  }
+  EXPECT_EQ(primes, sieved);
+  EXPECT_EQ(primes.size(), 6542u);
+}
+
+TEST(PrimeTestingTests, MachineIntegers) {
+  std::vector<char> expected = sieve(1 << 20);
+  for (uint64_t n = 0; n < expected.size(); ++n) EXPECT_EQ(isPrime(n), expected[n] != 0) << n;
+
+  // strong pseudoprimes to several bases, Carmichael numbers and large primes
+  for (uint64_t n : {2047ull, 3215031751ull, 4759123141ull, 1122004669633ull, 3825123056546413051ull,
+                     561ull * 1105ull, 4294967297ull,
+                     4294967291ull * 4294967279ull, 18446744073709551615ull}) {
+    EXPECT_FALSE(isPrime(n)) << n;
+  }
+  for (uint64_t n : {4294967291ull, 4294967311ull, 2305843009213693951ull, 18446744073709551557ull,
+                     1000000000000000003ull, 9223372036854775783ull}) {
+    EXPECT_TRUE(isPrime(n)) << n;
+  }
+}
+
+TEST(PrimeTestingTests, BailliePswComponents) {
+  // strong pseudoprimes to base 2 pass Miller-Rabin but not Lucas
+  for (int n : {2047, 3277, 4033, 4681, 8321, 15841, 29341, 42799, 49141, 52633}) {
+    EXPECT_TRUE(isStrongProbablePrime(BigInt(n), BigInt(2))) << n;
+    EXPECT_FALSE(isStrongLucasProbablePrime(BigInt(n))) << n;
+  }
+  // and the strong Lucas pseudoprimes are exactly the odd composites to pass Lucas
+  std::vector<int> lucasPseudoprimes{5459, 5777, 10877, 16109, 18971, 22499, 24569, 25199, 40309, 58519, 75077, 97439};
+  std::vector<char> expected = sieve(100000);
+  std::vector<int> passed;
+  for (int n = 3; n < 100000; n += 2) {
+    bool lucas = isStrongLucasProbablePrime(BigInt(n));
+    if (expected[n]) {
+      EXPECT_TRUE(lucas) << n;
+    } else if (lucas) {
+      passed.push_back(n);
+    }
+  }
+  EXPECT_EQ(passed, lucasPseudoprimes);
+}
+
+TEST(PrimeTestingTests, BigIntegers) {
+  EXPECT_FALSE(isPrime(-BigInt(7)));
+  EXPECT_TRUE(isPrime(BigInt(7)));
+  EXPECT_TRUE(isPrime(BigInt(18446744073709551557ull)));
+
+  for (int p : {61, 89, 107, 127, 521, 607, 1279}) EXPECT_TRUE(isPrime(mersenne(p))) << p;
+  for (int p : {67, 257, 1277}) EXPECT_FALSE(isPrime(mersenne(p))) << p;
+  EXPECT_FALSE(isPrime(BigInt(1).binaryScaleUp(128) + 1)); // Fermat F7
+  EXPECT_FALSE(isPrime(mersenne(127) * mersenne(89)));
+  EXPECT_FALSE(isPrime(mersenne(61) * mersenne(61)));
+
+  // products of two random primes are never prime
+  std::mt19937_64 gen(73);
+  for (int i = 0; i < 5; ++i) {
+    BigInt p = nextPrime(randomBigInt(gen, 100)), q = nextPrime(randomBigInt(gen, 100));
+    EXPECT_TRUE(isPrime(p));
+    EXPECT_FALSE(isPrime(p * q));
+  }
+}
+
+TEST(PrimeTestingTests, Batch) {
+  std::mt19937_64 gen(79);
+  std::vector<BigInt> candidates;
+  for (int i = 0; i < 200; ++i) candidates.push_back(randomBigInt(gen, 80 + i % 3 * 60));
+  for (int p : {127, 521}) candidates.push_back(mersenne(p));
+  std::vector<bool> expected;
+  for (const auto& candidate : candidates) expected.push_back(isPrime(candidate));
+  EXPECT_EQ(isPrime(candidates, 1), expected);
+  EXPECT_EQ(isPrime(candidates, 4), expected);
+  EXPECT_TRUE(isPrime(std::vector<BigInt>{}, 3).empty());
+}
+
+TEST(PrimeTestingTests, NextPrime) {
+  std::vector<char> expected = sieve(200000);
+  uint64_t n = 0;
+  for (uint64_t p = 2; p < expected.size(); ++p) {
+    if (!expected[p]) continue;
+    for (; n < p; n += 7) EXPECT_EQ(nextPrime(n), p) << n;
+  }
+  EXPECT_EQ(nextPrime(uint64_t{1} << 32), 4294967311ull);
+  EXPECT_EQ(nextPrime(18446744073709551556ull), 18446744073709551557ull);
+  EXPECT_THROW(nextPrime(18446744073709551557ull), std::overflow_error);
+
+  EXPECT_EQ(nextPrime(-BigInt(10)), BigInt(2));
+  EXPECT_EQ(nextPrime(BigInt(18446744073709551557ull)), BigInt(1).binaryScaleUp(64) + 13);
+  EXPECT_EQ(nextPrime(mersenne(127) - 1), mersenne(127));
+  EXPECT_EQ(nextPrime(BigInt(1).binaryScaleUp(128)), BigInt(1).binaryScaleUp(128) + 51);
+
+  // nothing prime is skipped between n and nextPrime(n)
+  std::mt19937_64 gen(83);
+  for (int bits : {70, 200, 512}) {
+    BigInt start = randomBigInt(gen, bits);
+    BigInt p = nextPrime(start);
+    EXPECT_TRUE(isPrime(p));
+    for (BigInt k = start + 1; k < p; ++k) EXPECT_FALSE(isPrime(k)) << k.toString();
+  }
+}
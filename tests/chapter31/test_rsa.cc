@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+
+#include "chapter31/rsa.h"
+#include "chapter31/prime_testing.h"
+#include "helpers/random_generators.h"
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+
+using BigNum::BigInt;
+using namespace NumberTheory;
+
+TEST(RsaTests, TextbookExample) {
+  // CLRS 31.7: p = 11, q = 29, e = 3 gives d = 147 modulo phi(n) = 280; lambda(n) = 140 gives 47
+  RsaPrivateKey key(BigInt(11), BigInt(29), BigInt(3));
+  EXPECT_EQ(key.modulus(), BigInt(319));
+  EXPECT_EQ(key.privateExponent(), BigInt(47));
+  RsaPublicKey publicKey = key.publicKey();
+  EXPECT_EQ(publicKey.exponent(), BigInt(3));
+  EXPECT_EQ(publicKey.encrypt(BigInt(100)), BigInt(254));
+  EXPECT_EQ(key.decrypt(BigInt(254)), BigInt(100));
+  for (int m = 0; m < 319; ++m) {
+    BigInt c = publicKey.encrypt(BigInt(m));
+    EXPECT_EQ(key.decrypt(c), BigInt(m)) << m;
+    EXPECT_EQ(key.decryptWithoutCrt(c), BigInt(m)) << m;
+  }
+
+  EXPECT_THROW(publicKey.encrypt(BigInt(319)), std::invalid_argument);
+  EXPECT_THROW(key.decrypt(-BigInt(1)), std::invalid_argument);
+  EXPECT_THROW(RsaPrivateKey(BigInt(11), BigInt(11), BigInt(3)), std::invalid_argument);
+  // 7 divides q - 1 = 28
+  EXPECT_THROW(RsaPrivateKey(BigInt(11), BigInt(29), BigInt(7)), std::invalid_argument);
+  EXPECT_THROW(RsaPublicKey(BigInt(319), BigInt(1)), std::invalid_argument);
+  EXPECT_THROW(RsaPublicKey(BigInt(320), BigInt(3)), std::invalid_argument);
+}
+
+TEST(RsaTests, GeneratedKeys) {
+  std::mt19937_64 gen(131);
+  EXPECT_THROW(RsaPrivateKey::generate(8, gen), std::invalid_argument);
+  for (int bits : {16, 65, 256, 511, 1024}) {
+    RsaPrivateKey key = RsaPrivateKey::generate(bits, gen);
+    RsaPublicKey publicKey = key.publicKey();
+    EXPECT_EQ(key.modulus().bitLength(), bits);
+    EXPECT_EQ(publicKey.exponent(), BigInt(RSA_PUBLIC_EXPONENT));
+    for (int i = 0; i < 5; ++i) {
+      BigInt m = randomBelow(gen, key.modulus());
+      BigInt c = publicKey.encrypt(m);
+      EXPECT_EQ(c, BigNum::MontgomeryContext(key.modulus()).powmod(m, BigInt(RSA_PUBLIC_EXPONENT)));
+      EXPECT_EQ(key.decrypt(c), m);
+      EXPECT_EQ(key.decryptWithoutCrt(c), m);
+      BigInt signature = key.sign(m);
+      EXPECT_TRUE(publicKey.verify(m, signature));
+      EXPECT_FALSE(publicKey.verify(m + 1, signature));
+    }
+  }
+
+  // a public exponent longer than a limb takes the general powmod path
+  BigInt p = randomPrime(gen, 256), q = randomPrime(gen, 256);
+  BigInt e = nextPrime(BigInt(1).binaryScaleUp(100));
+  RsaPrivateKey key(p, q, e);
+  BigInt m = randomBelow(gen, key.modulus());
+  BigInt c = key.publicKey().encrypt(m);
+  EXPECT_EQ(c, BigNum::MontgomeryContext(key.modulus()).powmod(m, e));
+  EXPECT_EQ(key.decrypt(c), m);
+}
+
+TEST(RsaTests, Batch) {
+  std::mt19937_64 gen(137);
+  RsaPrivateKey key = RsaPrivateKey::generate(512, gen);
+  std::vector<BigInt> messages;
+  for (int i = 0; i < 40; ++i) messages.push_back(randomBelow(gen, key.modulus()));
+  std::vector<BigInt> expected;
+  for (const auto& m : messages) expected.push_back(key.sign(m));
+  EXPECT_EQ(key.sign(messages, 1), expected);
+  EXPECT_EQ(key.sign(messages, 4), expected);
+  EXPECT_TRUE(key.decrypt(std::vector<BigInt>{}, 3).empty());
+  messages.push_back(key.modulus());
+  EXPECT_THROW(key.decrypt(messages, 4), std::invalid_argument);
+}
@@ -21,7 +21,7 @@ TEST(Chapter5, RandomInRange) {
 TEST(Chapter5, ResetSeed) {
   Chapter5::Random random;
   int n = 10;
-  std::vector<int> vec1{n}, vec2{n};
+  std::vector<int> vec1(n), vec2(n);
 
   int low = 0; int high = 100;
   for (int i = 0; i < n; ++i) vec1[i] = random(low, high);
@@ -31,6 +31,43 @@ TEST(Chapter5, ResetSeed) {
   ASSERT_EQ(vec1, vec2);
 }
 
+TEST(Chapter5, FastRandomInRange) {
+  Chapter5::FastRandom random;
+  for (int i = 0; i < 1000; ++i) {
+    int result = random(-3, 7);
+    EXPECT_TRUE((-3 <= result && result <= 7));
+  }
+}
+
+TEST(Chapter5, SeededGeneratorsRepeat) {
+  Chapter5::Random random1(42), random2(42);
+  Chapter5::FastRandom fast1(42), fast2(42);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(random1(0, 1000000), random2(0, 1000000));
+    EXPECT_EQ(fast1(0, 1000000), fast2(0, 1000000));
+  }
+}
+
+TEST(Chapter5, XoshiroSeeding) {
+  Chapter5::Xoshiro256 engine1(7), engine2(8);
+  std::vector<uint64_t> first(10), second(10);
+  for (auto &x : first) x = engine1();
+  engine1.seed(7);
+  for (auto &x : second) x = engine1();
+  EXPECT_EQ(first, second);
+  EXPECT_NE(engine1(), engine2());
+}
+
+TEST(Chapter5, SeedThreadRandom) {
+  std::vector<int> original{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  std::vector<int> vec1 = original, vec2 = original;
+  Chapter5::seedThreadRandom(123);
+  Chapter5::shuffle(vec1);
+  Chapter5::seedThreadRandom(123);
+  Chapter5::shuffle(vec2);
+  EXPECT_EQ(vec1, vec2);
+}
+
 TEST(Chapter5, ShuffleEmpty) {
   std::vector<int> vec;
   Chapter5::shuffle(vec);
@@ -88,6 +88,14 @@ TEST(Chapter6, HeapConstructor) {
   EXPECT_EQ(heap.size(), 2);
 }
 
+TEST(Chapter6, RangeHeapSort) {
+  std::vector<int> vec{9, 8, 5, 2, 7, 1, 6, 0, 3};
+  Chapter6::rangeHeapSort(vec, 2, 6);
+  std::vector<int> expected{9, 8, 1, 2, 5, 6, 7, 0, 3};
+  EXPECT_EQ(vec, expected);
+}
+
 INSTANTIATE_TEST_SUITE_P(HeapSort, SortingTest, ::testing::Values(
-  Chapter6::heapSort<int>
+  Chapter6::heapSort<int>,
+  [](std::vector<int> &vec, std::less<int> lessThan) { Chapter6::rangeHeapSort(vec, 0, vec.size() - 1, lessThan); }
 ));
\ No newline at end of file
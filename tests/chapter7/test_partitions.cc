@@ -4,6 +4,7 @@
 #include "helpers/random_generators.h"
 
 #include <utility>
+#include <algorithm>
 
 
 TEST(Chapter7, SimplePartition) {
@@ -40,19 +41,41 @@ TEST(Chapter7, ValidPartitionsByValue) {
   }
 }
 
+TEST(Chapter7, ValidBlockPartitionsByValue) {
+  int range = 1000;
+  for (int i = 1; i < 10; ++i) {
+    int size = 7*i*i*i; // sizes on either side of the block size
+    int pivotValue = (477*i + i) % range;
+
+    std::vector<int> input = generateRandomIntVector(size, range);
+    std::vector<int> sortedInput = input;
+    std::sort(sortedInput.begin(), sortedInput.end());
+    int pivotIndex = Chapter7::blockPartitionByValue(input, pivotValue, 0, size - 1, std::less<int>());
+
+    EXPECT_EQ(pivotIndex + 1, std::upper_bound(sortedInput.begin(), sortedInput.end(), pivotValue) - sortedInput.begin());
+    EXPECT_TRUE(std::all_of(input.begin(), input.begin() + pivotIndex + 1, [pivotValue](int x) { return x <= pivotValue; }));
+    EXPECT_TRUE(std::all_of(input.begin() + pivotIndex + 1, input.end(), [pivotValue](int x) { return x > pivotValue; }));
+    std::sort(input.begin(), input.end());
+    EXPECT_EQ(input, sortedInput);
+  }
+}
+
 TEST(Chapter7, ValidPartitions) {
   std::vector<std::function<int(std::vector<int>&, int, int, std::less<int>)>> partitionFunctions{
     Chapter7::partition<int>,
     Chapter7::randomPartition<int>,
-    Chapter7::medianOfThreePartition<int>
+    Chapter7::medianOfThreePartition<int>,
+    Chapter7::nintherPartition<int>,
+    Chapter7::blockPartition<int>,
+    Chapter7::randomPartition<int, std::less<int>, Chapter7::PartitionScheme::Block>
   };
   int partitionCount = partitionFunctions.size();
-  std::vector<std::vector<int>> inputs(3);
-  std::vector<int> pivots(3);
+  std::vector<std::vector<int>> inputs(partitionCount);
+  std::vector<int> pivots(partitionCount);
 
   int range = 50;
   for (int i = 1; i < 10; ++i) {
-    int size = 3*i;
+    int size = 3*i*i*i;
     for (int j = 0; j < partitionCount; ++j) {
       inputs[j] = generateRandomIntVector(size, range);
       pivots[j] = partitionFunctions[j](inputs[j], 0, size - 1, std::less<int>());
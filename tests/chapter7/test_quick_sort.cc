@@ -3,17 +3,92 @@
 #include "chapter7/quick_sort.h"
 #include "fixtures/sorting_fixture.h"
 #include "helpers/printing_helpers.h"
+#include "helpers/random_generators.h"
 
 #include <random>
 #include <algorithm>
+#include <numeric>
 
 GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(StableSortingTest);
 
 INSTANTIATE_TEST_SUITE_P(QuickSorts, SortingTest, ::testing::Values(
   Chapter7::quickSort<int>,
-  Chapter7::randomQuickSort<int>
+  Chapter7::randomQuickSort<int>,
+  [](std::vector<int> &vec, std::less<int> lessThan) { Chapter7::parallelQuickSort(vec, lessThan, 4, 64); },
+  [](std::vector<int> &vec, std::less<int> lessThan) { Chapter7::introSort(vec, lessThan); },
+  Chapter7::quickSort<int, std::less<int>, Chapter7::PartitionScheme::Block>,
+  Chapter7::randomQuickSort<int, std::less<int>, Chapter7::PartitionScheme::Block>
 ));
 
+TEST(Chapter7, SeededRandomQuickSortIsReproducible) {
+  // equal keys end up in an order that depends on the random pivots
+  auto byFirst = [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first < b.first; };
+  std::vector<int> keys = generateRandomIntVector(5000, 20);
+  std::vector<std::pair<int, int>> input(keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) input[i] = std::pair<int, int>(keys[i], i);
+
+  std::vector<std::pair<int, int>> first = input, second = input;
+  Chapter5::seedThreadRandom(2024);
+  Chapter7::randomQuickSort(first, byFirst);
+  Chapter5::seedThreadRandom(2024);
+  Chapter7::randomQuickSort(second, byFirst);
+  EXPECT_EQ(first, second);
+}
+
+TEST(Chapter7, AdversarialInputs) {
+  int size = 300000;
+  std::vector<int> sorted(size);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  std::vector<int> reversed(sorted.rbegin(), sorted.rend());
+  std::vector<int> equal(size, 7);
+  std::vector<int> organPipe(size);
+  for (int i = 0; i < size; ++i) organPipe[i] = std::min(i, size - i);
+
+  for (std::vector<int> *input : {&sorted, &reversed, &equal, &organPipe}) {
+    std::vector<int> expected = *input;
+    std::sort(expected.begin(), expected.end());
+    // the deterministic quickSorts used to recurse n deep on these
+    std::vector<int> lomuto = *input, block = *input, parallel = *input;
+    Chapter7::quickSort(lomuto);
+    EXPECT_EQ(lomuto, expected);
+    Chapter7::quickSort<int, std::less<int>, Chapter7::PartitionScheme::Block>(block);
+    EXPECT_EQ(block, expected);
+    Chapter7::parallelQuickSort(parallel, std::less<int>(), 4);
+    EXPECT_EQ(parallel, expected);
+    Chapter7::introSort(*input);
+    EXPECT_EQ(*input, expected);
+  }
+}
+
+TEST(Chapter7, IntroSortCustomComparator) {
+  std::vector<int> vec = generateRandomIntVector(1000, 50);
+  Chapter7::introSort(vec, std::greater<int>());
+  EXPECT_TRUE(std::is_sorted(vec.begin(), vec.end(), std::greater<int>()));
+}
+
+TEST(Chapter7, IntroSortRange) {
+  std::vector<int> vec = generateRandomIntVector(5000, 100);
+  std::vector<int> expected = vec;
+  std::sort(expected.begin() + 1000, expected.begin() + 4001);
+  Chapter7::introSort(vec, 1000, 4000, std::less<int>());
+  EXPECT_EQ(vec, expected);
+}
+
+TEST(Chapter7, ParallelQuickSortMatchesSequential) {
+  auto byFirst = [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first < b.first; };
+  std::vector<int> keys = generateRandomIntVector(50000, 1000);
+  std::vector<std::pair<int, int>> vec(keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) vec[i] = std::pair<int, int>(keys[i], i);
+
+  std::vector<std::pair<int, int>> expected = vec;
+  Chapter7::quickSort(expected, byFirst);
+  for (int threads : {1, 2, 3, 8}) {
+    std::vector<std::pair<int, int>> parallel = vec;
+    Chapter7::parallelQuickSort(parallel, byFirst, threads, 256);
+    EXPECT_EQ(parallel, expected) << "threads = " << threads;
+  }
+}
+
 // TEST(Chapter7, FuzzySort) {
 //   // Random generators / distributions
 //   std::random_device rd;
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <functional>
 #include <random>
+#include <string>
 
 GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(StableSortingTest);
 GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(SortingTest);
@@ -29,6 +30,30 @@ TEST(Chapter8, CustomCountingSort) {
   EXPECT_EQ(input, expected);
 }
 
+TEST(Chapter8, RecordCountingSort) {
+  struct Record {
+    int priority;
+    std::string name;
+  };
+  std::vector<Record> input{{2, "c"}, {0, "a"}, {2, "d"}, {1, "b"}, {0, "e"}};
+  Chapter8::countingSort(input, 2, [](const Record &r) { return r.priority; });
+  std::vector<std::string> names;
+  for (const auto &r : input) names.push_back(r.name);
+  EXPECT_EQ(names, std::vector<std::string>({"a", "e", "b", "c", "d"}));
+}
+
+TEST(Chapter8, CountingSortReusedBuffers) {
+  std::vector<int> count;
+  std::vector<int> buffer;
+  for (int i = 0; i < 5; ++i) {
+    std::vector<int> input = generateRandomIntVector(100 * (i+1), 20 * (i+1));
+    std::vector<int> expected = input;
+    std::sort(expected.begin(), expected.end());
+    Chapter8::countingSort(input, 20 * (i+1), std::identity(), count, buffer);
+    EXPECT_EQ(input, expected);
+  }
+}
+
 TEST(Chapter8, RangeQueryTest) {
   int range = 10;
   int size = 50;
@@ -45,6 +70,80 @@ TEST(Chapter8, RangeQueryTest) {
   }
 }
 
+TEST(Chapter8, RadixSortSignedIntegers) {
+  std::vector<int> input{5, -3, 2147483647, 0, -2147483647 - 1, 42, -1, 1, -42, 7};
+  std::vector<int> expected = input;
+  std::sort(expected.begin(), expected.end());
+  Chapter8::lsdRadixSort(input);
+  EXPECT_EQ(input, expected);
+
+  std::vector<long long> wide{-5000000000LL, 3, -1, 9000000000000000000LL, 0, -9000000000000000000LL};
+  std::vector<long long> expectedWide = wide;
+  std::sort(expectedWide.begin(), expectedWide.end());
+  Chapter8::lsdRadixSort(wide);
+  EXPECT_EQ(wide, expectedWide);
+}
+
+TEST(Chapter8, RadixSortUnsigned64) {
+  std::mt19937_64 gen(17);
+  std::vector<uint64_t> input(5000);
+  for (auto &x : input) x = gen();
+  input.push_back(0); input.push_back(UINT64_MAX);
+  std::vector<uint64_t> expected = input;
+  std::sort(expected.begin(), expected.end());
+  Chapter8::lsdRadixSort(input);
+  EXPECT_EQ(input, expected);
+}
+
+TEST(Chapter8, RadixSortFloatingPoint) {
+  std::vector<double> input{3.5, -0.25, 1e300, -1e-300, 0.0, -7.0, 2.0, -1e300, 0.125};
+  std::vector<double> expected = input;
+  std::sort(expected.begin(), expected.end());
+  Chapter8::lsdRadixSort(input);
+  EXPECT_EQ(input, expected);
+
+  std::vector<float> floats{1.5f, -2.5f, 0.0f, 100.0f, -100.0f, 3.25f};
+  std::vector<float> expectedFloats = floats;
+  std::sort(expectedFloats.begin(), expectedFloats.end());
+  Chapter8::lsdRadixSort(floats);
+  EXPECT_EQ(floats, expectedFloats);
+}
+
+TEST(Chapter8, RadixSortKeyValuePairs) {
+  std::vector<int> keys = generateRandomIntVector(2000, 50);
+  std::vector<std::pair<int, int>> input(keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) input[i] = std::pair<int, int>(keys[i] - 25, i);
+  std::vector<std::pair<int, int>> expected = input;
+  std::stable_sort(expected.begin(), expected.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first < b.first; });
+  Chapter8::lsdRadixSortByKey(input, [](const std::pair<int, int> &p) { return p.first; });
+  EXPECT_EQ(input, expected);
+}
+
+TEST(Chapter8, ParallelRadixSort) {
+  std::vector<int> ints = generateRandomIntVector(200000, 1000000);
+  for (std::size_t i = 0; i < ints.size(); i += 3) ints[i] = -ints[i];
+  std::mt19937_64 gen(5);
+  std::vector<uint64_t> wide(200000);
+  for (auto &x : wide) x = gen() >> (gen() % 64);
+  std::uniform_real_distribution<double> real(-1000.0, 1000.0);
+  std::vector<double> reals(100000);
+  for (auto &x : reals) x = real(gen);
+
+  std::vector<int> sortedInts = ints;
+  std::sort(sortedInts.begin(), sortedInts.end());
+  for (int threads : {1, 2, 4}) {
+    std::vector<int> intCopy = ints;
+    std::vector<uint64_t> wideCopy = wide;
+    std::vector<double> realCopy = reals;
+    Chapter8::parallelRadixSort(intCopy, threads);
+    Chapter8::parallelRadixSort(wideCopy, threads);
+    Chapter8::parallelRadixSort(realCopy, threads);
+    EXPECT_EQ(intCopy, sortedInts) << "threads = " << threads;
+    EXPECT_TRUE(std::is_sorted(wideCopy.begin(), wideCopy.end())) << "threads = " << threads;
+    EXPECT_TRUE(std::is_sorted(realCopy.begin(), realCopy.end())) << "threads = " << threads;
+  }
+}
+
 TEST(Chapter8, BasicBucketSort) {
   std::vector<double> input{0.78, 0.17, 0.39, 0.26, 0.72, 0.94, 0.21, 0.12, 0.23, 0.68};
   Chapter8::bucketSort(input);
@@ -106,6 +205,41 @@ TEST(Chapter8, CustomBucketSort) {
 }
 
 
+TEST(Chapter8, BucketSortStats) {
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<double> uniform{0.0, 1.0};
+  std::vector<double> input(10000);
+  std::generate(input.begin(), input.end(), [&uniform, &gen]() { return uniform(gen); });
+  std::vector<double> expected = input;
+  std::sort(expected.begin(), expected.end());
+
+  Chapter8::BucketStats stats = Chapter8::bucketSort(input);
+  EXPECT_EQ(input, expected);
+  EXPECT_EQ(stats.bucketCount, 10000 / Chapter8::BUCKET_TARGET_LOAD);
+  EXPECT_LT(stats.largestBucket, 32);
+  // uniform input with load a has expected sum of squares n * (a + 1 - 1/buckets)
+  EXPECT_LT(stats.squaredSizeSum, 2 * 10000 * (Chapter8::BUCKET_TARGET_LOAD + 1));
+}
+
+TEST(Chapter8, BucketSortSkewedCdf) {
+  // values far outside [0, 1] and a cdf that puts almost everything in one bucket must still sort
+  std::mt19937 gen(13);
+  std::uniform_real_distribution<double> wide{-1e6, 1e6};
+  std::vector<double> input(5000);
+  std::generate(input.begin(), input.end(), [&wide, &gen]() { return wide(gen); });
+  std::vector<double> expected = input;
+  std::sort(expected.begin(), expected.end());
+  Chapter8::BucketStats stats = Chapter8::bucketSort(input, [](double x) { return x > 9e5 ? 1.0 : 0.0; });
+  EXPECT_EQ(input, expected);
+  EXPECT_GT(stats.largestBucket, 4000);
+
+  std::generate(input.begin(), input.end(), [&wide, &gen]() { return wide(gen); });
+  expected = input;
+  std::sort(expected.begin(), expected.end());
+  Chapter8::bucketSort(input);
+  EXPECT_EQ(input, expected);
+}
+
 // TODO: Fix this. It doesnt make sense to be sorting integers using bucketSort, since only integer
 // indexed buckets will be used. Fix sorting_fixture to be more dynamic and allow doubles
 std::function<double(int)> uniformBucketCDF = [](int x) {
@@ -117,5 +251,7 @@ std::function<double(int)> uniformBucketCDF = [](int x) {
 INSTANTIATE_TEST_SUITE_P(LinearSorts, SortingTest, ::testing::Values(
   [](std::vector<int> &vec, std::less<int> lessThan) { Chapter8::countingSort(vec, 100); },
   [](std::vector<int> &vec, std::less<int> lessThan) { Chapter8::bucketSort(vec, uniformBucketCDF); },
-  [](std::vector<int> &vec, std::less<int> lessThan) { Chapter8::radixSort(vec); }
+  [](std::vector<int> &vec, std::less<int> lessThan) { Chapter8::radixSort(vec); },
+  [](std::vector<int> &vec, std::less<int> lessThan) { Chapter8::lsdRadixSort(vec); },
+  [](std::vector<int> &vec, std::less<int> lessThan) { Chapter8::parallelRadixSort(vec, 4); }
 ));
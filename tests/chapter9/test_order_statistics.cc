@@ -78,6 +78,16 @@ TEST(Chapter9, ValidSelects) {
   }
 }
 
+TEST(Chapter9, BlockPartitionSelects) {
+  std::vector<int> input = generateRandomIntVector(5000, 1000);
+  std::vector<int> sorted = input;
+  std::sort(sorted.begin(), sorted.end());
+  for (int index : {0, 1, 255, 2500, 4998, 4999}) {
+    int selected = Chapter9::select<int, std::less<int>, Chapter7::PartitionScheme::Block>(input, index);
+    EXPECT_EQ(selected, sorted[index]);
+  }
+}
+
 TEST(Chapter9, BasicMedianTwoSorted) {
   std::vector<int> input1{1, 4, 5, 6, 8, 11, 23, 35};
   std::vector<int> input2{4, 7, 9, 10, 20, 21, 33, 44};
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "gtest/gtest.h"
+
+#include "helpers/random_generators.h"
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+// Runs a map with the std::unordered_map interface against std::unordered_map itself. Keys and
+// mapped values are ints or strings made from ints, long enough to leave the small string buffer.
+template <typename T>
+class HashMapTest : public ::testing::Test {
+ protected:
+  using Key = typename T::key_type;
+  using Mapped = typename T::mapped_type;
+  using BaseType = std::unordered_map<Key, Mapped>;
+  using TestType = T;
+
+  BaseType base;
+  TestType test;
+
+  template <typename V>
+  static V make(int i) {
+    if constexpr (std::is_same_v<V, std::string>) {
+      return "a string long enough to allocate #" + std::to_string(i);
+    } else {
+      return static_cast<V>(i);
+    }
+  }
+  static Key key(int i) { return make<Key>(i); }
+  static Mapped mapped(int i) { return make<Mapped>(i); }
+
+  void checkElements(const std::string &message = std::string()) {
+    std::vector<std::pair<Key, Mapped>> baseContents(base.begin(), base.end());
+    std::vector<std::pair<Key, Mapped>> testContents;
+    for (const auto &[k, v] : test) testContents.emplace_back(k, v);
+    std::sort(baseContents.begin(), baseContents.end());
+    std::sort(testContents.begin(), testContents.end());
+    EXPECT_EQ(baseContents, testContents) << message;
+    EXPECT_EQ(base.empty(), test.empty());
+    EXPECT_EQ(base.size(), test.size());
+  }
+
+  void testModifiers(const std::string &message = std::string()) {
+    for (int i : {100, 101, 102, 101}) {
+      auto [baseIter, baseInserted] = base.insert({key(i), mapped(i)});
+      auto [testIter, testInserted] = test.insert({key(i), mapped(i)});
+      EXPECT_EQ(*baseIter, *testIter);
+      EXPECT_EQ(baseInserted, testInserted);
+      checkElements(message);
+    }
+
+    int baseRemoved = base.erase(key(101));
+    int testRemoved = test.erase(key(101));
+    EXPECT_EQ(baseRemoved, testRemoved);
+    checkElements(message);
+
+    base.erase(test.begin()->first);
+    test.erase(test.begin());
+    checkElements(message);
+  }
+};
+
+TYPED_TEST_SUITE_P(HashMapTest);
+
+TYPED_TEST_P(HashMapTest, DestructEmpty) {
+  // do nothing, ensures that a default constructed object is valid, and is destroyed properly when empty
+  typename TestFixture::TestType emptyTest;
+  EXPECT_TRUE(emptyTest.begin() == emptyTest.end());
+  EXPECT_EQ(emptyTest.find(TestFixture::key(1)), emptyTest.end());
+}
+
+TYPED_TEST_P(HashMapTest, DefaultConstructor) {
+  typename TestFixture::BaseType newBase;
+  typename TestFixture::TestType newTest;
+  this->base = newBase;
+  this->test = newTest;
+  this->testModifiers();
+}
+
+TYPED_TEST_P(HashMapTest, InitListConstructor) {
+  auto k = [](int i) { return TestFixture::key(i); };
+  auto v = [](int i) { return TestFixture::mapped(i); };
+  typename TestFixture::BaseType newBase{{k(4), v(4)}, {k(2), v(2)}, {k(6), v(6)}, {k(4), v(5)}};
+  typename TestFixture::TestType newTest{{k(4), v(4)}, {k(2), v(2)}, {k(6), v(6)}, {k(4), v(5)}};
+  this->base = newBase;
+  this->test = newTest;
+  this->checkElements();
+  this->testModifiers();
+}
+
+TYPED_TEST_P(HashMapTest, CopyAndMove) {
+  for (int i = 0; i < 100; ++i) {
+    this->base.emplace(TestFixture::key(i), TestFixture::mapped(i));
+    this->test.emplace(TestFixture::key(i), TestFixture::mapped(i));
+  }
+  typename TestFixture::TestType copy = this->test;
+  EXPECT_TRUE(copy == this->test);
+  copy.erase(TestFixture::key(5));
+  EXPECT_FALSE(copy == this->test);
+  this->checkElements("copy is independent");
+
+  typename TestFixture::TestType moved = std::move(this->test);
+  EXPECT_TRUE(this->test.empty()); // a moved-from map is left empty and usable
+  this->test = moved;
+  this->checkElements("beforeMove");
+  this->testModifiers("afterMove");
+}
+
+TYPED_TEST_P(HashMapTest, InsertAndEraseByKey) {
+  RandomValue rand;
+  for (int i = 0; i < 10000; ++i) {
+    int randomValue = rand(0, 500);
+    if (rand(0, 1) == 0) {
+      auto baseResult = this->base.insert({TestFixture::key(randomValue), TestFixture::mapped(i)});
+      auto testResult = this->test.insert({TestFixture::key(randomValue), TestFixture::mapped(i)});
+      EXPECT_EQ(*baseResult.first, *testResult.first);
+      EXPECT_EQ(baseResult.second, testResult.second);
+    } else {
+      int baseRemoved = this->base.erase(TestFixture::key(randomValue));
+      int testRemoved = this->test.erase(TestFixture::key(randomValue));
+      EXPECT_EQ(baseRemoved, testRemoved);
+    }
+    if (i % 100 == 0) this->checkElements();
+  }
+  this->checkElements();
+}
+
+TYPED_TEST_P(HashMapTest, FindAndCount) {
+  RandomValue rand;
+  for (int i = 0; i < 1000; ++i) {
+    int randomValue = rand(0, 2000);
+    this->base.emplace(TestFixture::key(randomValue), TestFixture::mapped(i));
+    this->test.emplace(TestFixture::key(randomValue), TestFixture::mapped(i));
+  }
+  for (int i = 0; i < 2000; ++i) {
+    auto k = TestFixture::key(rand(0, 2000));
+    auto baseIter = this->base.find(k);
+    auto testIter = this->test.find(k);
+    EXPECT_EQ(baseIter == this->base.end(), testIter == this->test.end());
+    if (baseIter != this->base.end()) {
+      EXPECT_EQ(*baseIter, *testIter);
+    }
+    EXPECT_EQ(this->base.count(k), this->test.count(k));
+    EXPECT_EQ(this->base.contains(k), this->test.contains(k));
+  }
+}
+
+TYPED_TEST_P(HashMapTest, SubscriptAndAt) {
+  for (int i = 0; i < 300; ++i) {
+    this->base[TestFixture::key(i % 120)] = TestFixture::mapped(i);
+    this->test[TestFixture::key(i % 120)] = TestFixture::mapped(i);
+  }
+  this->checkElements();
+  EXPECT_EQ(this->test.at(TestFixture::key(7)), this->base.at(TestFixture::key(7)));
+  EXPECT_THROW(this->test.at(TestFixture::key(500)), std::out_of_range);
+  // operator[] on a missing key inserts a value-initialized element
+  EXPECT_EQ(this->test[TestFixture::key(500)], this->base[TestFixture::key(500)]);
+  this->checkElements();
+}
+
+TYPED_TEST_P(HashMapTest, InsertOrAssignAndEmplace) {
+  for (int i = 0; i < 200; ++i) {
+    auto baseResult = this->base.insert_or_assign(TestFixture::key(i % 50), TestFixture::mapped(i));
+    auto testResult = this->test.insert_or_assign(TestFixture::key(i % 50), TestFixture::mapped(i));
+    EXPECT_EQ(baseResult.second, testResult.second);
+    EXPECT_EQ(*baseResult.first, *testResult.first);
+
+    baseResult = this->base.try_emplace(TestFixture::key(i % 70), TestFixture::mapped(-i));
+    testResult = this->test.try_emplace(TestFixture::key(i % 70), TestFixture::mapped(-i));
+    EXPECT_EQ(baseResult.second, testResult.second);
+    EXPECT_EQ(*baseResult.first, *testResult.first);
+
+    baseResult = this->base.emplace(TestFixture::key(i % 90), TestFixture::mapped(i));
+    testResult = this->test.emplace(TestFixture::key(i % 90), TestFixture::mapped(i));
+    EXPECT_EQ(baseResult.second, testResult.second);
+    EXPECT_EQ(*baseResult.first, *testResult.first);
+  }
+  this->checkElements();
+}
+
+TYPED_TEST_P(HashMapTest, EraseWhileIterating) {
+  for (int i = 0; i < 1000; ++i) {
+    this->base.emplace(TestFixture::key(i), TestFixture::mapped(i));
+    this->test.emplace(TestFixture::key(i), TestFixture::mapped(i));
+  }
+  // erase returns the next element, and erasing never disturbs the others
+  bool eraseThis = true;
+  for (auto it = this->test.begin(); it != this->test.end(); eraseThis = !eraseThis) {
+    if (eraseThis) {
+      this->base.erase(it->first);
+      it = this->test.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  this->checkElements();
+  this->test.erase(this->test.begin(), this->test.end());
+  this->base.clear();
+  this->checkElements();
+  this->testModifiers("afterErasingEverything");
+}
+
+TYPED_TEST_P(HashMapTest, ClearAndRehash) {
+  for (int i = 0; i < 500; ++i) {
+    this->base.emplace(TestFixture::key(i), TestFixture::mapped(i));
+    this->test.emplace(TestFixture::key(i), TestFixture::mapped(i));
+  }
+  this->test.rehash(5000);
+  EXPECT_GE(this->test.bucket_count(), 5000u);
+  this->checkElements("afterRehash");
+  EXPECT_LE(this->test.load_factor(), this->test.max_load_factor());
+
+  this->base.clear();
+  this->test.clear();
+  this->checkElements("afterClear");
+  this->test.reserve(2000);
+  auto buckets = this->test.bucket_count();
+  for (int i = 0; i < 2000; ++i) {
+    this->base.emplace(TestFixture::key(i), TestFixture::mapped(i));
+    this->test.emplace(TestFixture::key(i), TestFixture::mapped(i));
+  }
+  EXPECT_EQ(this->test.bucket_count(), buckets); // reserve made room for all of them
+  this->checkElements("afterReserve");
+}
+
+REGISTER_TYPED_TEST_SUITE_P(HashMapTest, DestructEmpty, DefaultConstructor, InitListConstructor, CopyAndMove,
+                            InsertAndEraseByKey, FindAndCount, SubscriptAndAt, InsertOrAssignAndEmplace,
+                            EraseWhileIterating, ClearAndRehash);
@@ -1,7 +1,12 @@
 #pragma once
 
+#include "bignum/big_int.h"
+#include "chapter31/prime_testing.h"
+
 #include <vector>
 #include <random>
+#include <cstdint>
+#include <limits>
 
 std::vector<int> generateRandomIntVector(int size, int range);
 
@@ -19,6 +24,19 @@ class RandomValue {
   std::mt19937 generator;
 };
 
+// A BigInt uniform over [0, 2^bits). gen must return 64 random bits per call, e.g. std::mt19937_64
+template <typename Generator>
+BigNum::BigInt randomBigInt(Generator &gen, int bits);
+
+// A BigInt in [0, bound) for bound > 0, reduced from one more limb than bound has so the bias is
+// below 2^-64
+template <typename Generator>
+BigNum::BigInt randomBelow(Generator &gen, const BigNum::BigInt &bound);
+
+// The first prime after a random value of exactly bits bits, for bits >= 2
+template <typename Generator>
+BigNum::BigInt randomPrime(Generator &gen, int bits);
+
 template <typename Dist>
 RandomValue<Dist>::RandomValue(): initialSeed{rd()} {
   resetSeed();
@@ -34,4 +52,27 @@ typename RandomValue<Dist>::T RandomValue<Dist>::operator()(Args &&... args) {
 template <typename T>
 void RandomValue<T>::resetSeed() {
   generator.seed(initialSeed);
-}
\ No newline at end of file
+}
+
+template <typename Generator>
+BigNum::BigInt randomBigInt(Generator &gen, int bits) {
+  static_assert(Generator::max() == std::numeric_limits<uint64_t>::max() && Generator::min() == 0,
+                "randomBigInt needs a generator of 64-bit values");
+  int draws = (bits + 63) / 64;
+  BigNum::BigInt result = 0;
+  for (int i = 0; i < draws; ++i) {
+    result <<= 64;
+    result += BigNum::BigInt(static_cast<uint64_t>(gen()));
+  }
+  return result.binaryScaleDown(64 * draws - bits);
+}
+
+template <typename Generator>
+BigNum::BigInt randomBelow(Generator &gen, const BigNum::BigInt &bound) {
+  return randomBigInt(gen, 64 * (static_cast<int>(bound.bits.size()) + 1)) % bound;
+}
+
+template <typename Generator>
+BigNum::BigInt randomPrime(Generator &gen, int bits) {
+  return NumberTheory::nextPrime(randomBigInt(gen, bits - 1) + BigNum::BigInt(1).binaryScaleUp(bits - 1));
+}
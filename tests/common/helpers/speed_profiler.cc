@@ -1,3 +1,118 @@
 #include "helpers/speed_profiler.h"
 
+#include <algorithm>
+
 Profiler profiler;
+
+int Profiler::intern(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = ids.find(name);
+  if (it != ids.end()) return it->second;
+  if (names.size() == MAX_IDS) throw std::length_error("Profiler supports at most " + std::to_string(MAX_IDS) + " ids.");
+  names.push_back(name);
+  return ids[name] = names.size() - 1;
+}
+
+Profiler::ThreadBuffer& Profiler::registerThread() {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& buffer = buffers[std::this_thread::get_id()];
+  if (!buffer) buffer = std::make_unique<ThreadBuffer>();
+  return *buffer;
+}
+
+Profiler::Slot& Profiler::addSlot(ThreadBuffer& buffer, int id) {
+  buffer.owned.push_back(std::make_unique<Slot>());
+  Slot* slot = buffer.owned.back().get();
+  buffer.slots[id].store(slot, std::memory_order_release);
+  return *slot;
+}
+
+double Profiler::ticksPerNanosecond() {
+#if defined(__x86_64__) || defined(__i386__)
+  // calibrate the TSC against steady_clock once, over roughly 10ms
+  static const double rate = [] {
+    auto clockStart = std::chrono::steady_clock::now();
+    uint64_t tickStart = readTicks();
+    while (std::chrono::steady_clock::now() - clockStart < std::chrono::milliseconds(10)) {}
+    uint64_t ticks = readTicks() - tickStart;
+    double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - clockStart).count();
+    return ticks / nanoseconds;
+  }();
+  return rate;
+#else
+  return 1.0;
+#endif
+}
+
+double Profiler::bucketValue(int bucket) {
+  if (bucket < 16) return bucket;
+  int exponent = (bucket - 16) / 8 + 4;
+  int sub = (bucket - 16) % 8;
+  double width = static_cast<double>(uint64_t{1} << (exponent - 3));
+  return (8 + sub) * width + width / 2;
+}
+
+void Profiler::results(const std::string& testName) {
+  if (!testName.empty()) {
+    std::cout << "RESULTS for test: " << testName;
+  } else {
+    std::cout << "RESULTS";
+  }
+  std::cout << std::endl << std::endl;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  double nsPerTick = 1.0 / ticksPerNanosecond();
+  bool unmatched = false;
+
+  TableDisplay table{30, 12, 16, 14, 12, 12, 12};
+  table.printHeader("Functions", "Occurences", "Total Time (ms)", "Max Time (us)", "p50 (ns)", "p99 (ns)", "p999 (ns)");
+  for (int id = 0; id < static_cast<int>(names.size()); ++id) {
+    uint64_t count = 0, total = 0, max = 0;
+    std::vector<uint64_t> histogram(HISTOGRAM_BUCKETS, 0);
+    for (auto& [thread, buffer] : buffers) {
+      Slot* slot = buffer->slots[id].load(std::memory_order_acquire);
+      if (!slot) continue;
+      count += slot->count.load(std::memory_order_relaxed);
+      total += slot->total.load(std::memory_order_relaxed);
+      max = std::max(max, slot->max.load(std::memory_order_relaxed));
+      for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) histogram[b] += slot->histogram[b].load(std::memory_order_relaxed);
+      unmatched = unmatched || slot->depth.load(std::memory_order_relaxed) != 0;
+    }
+    if (count == 0) continue;
+
+    // smallest bucket whose cumulative count reaches the quantile, capped by the true maximum
+    auto percentile = [&histogram, count, max, nsPerTick](double q) {
+      uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(q * count + 0.5));
+      uint64_t seen = 0;
+      for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+        seen += histogram[b];
+        if (seen >= target) return formatFloatPrecision(std::min(bucketValue(b), static_cast<double>(max)) * nsPerTick, 0);
+      }
+      return formatFloatPrecision(max * nsPerTick, 0);
+    };
+
+    table.printRow(names[id],
+                   std::to_string(count),
+                   formatFloatPrecision(total * nsPerTick / 1e6, 3),
+                   formatFloatPrecision(max * nsPerTick / 1e3, 3),
+                   percentile(0.5), percentile(0.99), percentile(0.999));
+  }
+  std::cout << std::endl;
+
+  // check if a START was called without a matching END
+  if (unmatched) {
+    throw std::logic_error("Not every start time is matched with an end time.");
+  }
+
+  // if start/end time logic is correct, reset profiler
+  for (auto& [thread, buffer] : buffers) {
+    for (auto& pointer : buffer->slots) {
+      Slot* slot = pointer.load(std::memory_order_acquire);
+      if (!slot) continue;
+      slot->count.store(0, std::memory_order_relaxed);
+      slot->total.store(0, std::memory_order_relaxed);
+      slot->max.store(0, std::memory_order_relaxed);
+      for (auto& bucket : slot->histogram) bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+}
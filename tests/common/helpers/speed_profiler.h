@@ -2,80 +2,145 @@
 
 #include "helpers/printing_helpers.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <vector>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 #include <iostream>
 #include <stdexcept>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
+// Hot-path profiler. Each PROFILE_START/PROFILE_END call site interns its name once (a function
+// local static), so the per-call cost is a thread_local lookup, a timestamp read and a few relaxed
+// stores into a buffer owned by the calling thread. The name must therefore be a string literal,
+// which the macros enforce. results() merges every thread's buffer, including those of threads
+// that have exited. Build with -DCLRS_ENABLE_PROFILER=OFF to compile the macros out entirely.
 class Profiler {
-public:
-  Profiler() {}
+ public:
+  static constexpr int MAX_IDS = 256;
+  // log-linear histogram: exact below 16 ticks, then 8 sub-buckets per power of two
+  static constexpr int HISTOGRAM_BUCKETS = 16 + 60 * 8;
+
+  Profiler() : instance(nextInstance.fetch_add(1, std::memory_order_relaxed)) {}
 
-  ~Profiler() {}
+  // Returns the id of name, registering it on first use
+  int intern(const std::string& name);
 
-  void start(const std::string& id) {
-    startTimes[id].push_back(std::chrono::high_resolution_clock::now());
+  void start(int id) {
+    Slot& slot = threadSlot(id);
+    slot.starts.push_back(readTicks());
+    slot.depth.store(slot.starts.size(), std::memory_order_relaxed);
   }
 
-  void end(const std::string& id) {
-    auto endTime = std::chrono::high_resolution_clock::now();
-    auto startTime = startTimes[id].back();
-    startTimes[id].pop_back();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
-
-    TimingInfo& info = timings[id];
-    info.totalTime += duration;
-    info.totalOccurrences++;
-    if (duration > info.maxTime) {
-      info.maxTime = duration;
-    }
+  void end(int id) {
+    uint64_t now = readTicks();
+    Slot& slot = threadSlot(id);
+    if (slot.starts.empty()) throw std::logic_error("Profiler end called without a matching start.");
+    uint64_t elapsed = now - slot.starts.back();
+    slot.starts.pop_back();
+    slot.depth.store(slot.starts.size(), std::memory_order_relaxed);
+    record(slot, elapsed);
   }
 
-  void results(const std::string& testName = std::string()) {
-    if (!testName.empty()) {
-      std::cout << "RESULTS for test: " << testName;
-    } else {
-      std::cout << "RESULTS";
-    }
-    std::cout << std::endl << std::endl;
-
-    TableDisplay table{30, 15, 15, 15}; 
-    table.printHeader("Functions", "Occurences", "Total Time", "Max Time"); 
-    for (auto& entry : timings) {
-      table.printRow(entry.first,
-                    entry.second.totalOccurrences,
-                    formatFloatPrecision(static_cast<double>(entry.second.totalTime.count()) / 1000, 2),
-                    formatFloatPrecision(static_cast<double>(entry.second.maxTime.count()) / 1000, 2));
-    }
-    std::cout << std::endl;
+  // Interns on every call; prefer the macros on hot paths
+  void start(const std::string& name) { start(intern(name)); }
+  void end(const std::string& name) { end(intern(name)); }
+
+  // Prints occurrences, total/max time and p50/p99/p999 latency for every id, then resets the
+  // counters. Throws std::logic_error if a start has no matching end. Instrumented threads
+  // should be idle while this runs, since their in-flight updates may be lost by the reset.
+  void results(const std::string& testName = std::string());
+
+  // Timestamp in ticks: TSC cycles on x86, steady_clock nanoseconds elsewhere
+  static uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+  }
 
-    // check if a START was called without a matching END
-    if (!std::all_of(startTimes.begin(), startTimes.end(), [](auto const& x) { return x.second.empty(); })) {
-      throw std::logic_error("Not every start time is matched with an end time.");
-    }
+  static double ticksPerNanosecond();
 
-    // if start/end time logic is correct, reset profiler
-    timings.clear();
-    startTimes.clear();
+  // histogram bucket of a duration in ticks
+  static int bucketOf(uint64_t ticks) {
+    if (ticks < 16) return ticks;
+    int exponent = 63 - __builtin_clzll(ticks);
+    return 16 + (exponent - 4) * 8 + ((ticks >> (exponent - 3)) & 7);
   }
 
-private:
-  struct TimingInfo {
-    std::chrono::microseconds totalTime{0};
-    std::chrono::microseconds maxTime{0};
-    int totalOccurrences{0};
+  // midpoint of the ticks covered by bucket
+  static double bucketValue(int bucket);
+
+ private:
+  // Written only by the owning thread. Relaxed atomics let results() read concurrently without locks.
+  struct Slot {
+    std::vector<uint64_t> starts; // owner only
+    std::atomic<uint64_t> depth{0};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> max{0};
+    std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKETS> histogram{};
+  };
+
+  struct ThreadBuffer {
+    std::array<std::atomic<Slot*>, MAX_IDS> slots{};
+    std::vector<std::unique_ptr<Slot>> owned; // owner only
   };
 
-  std::unordered_map<std::string, std::vector<std::chrono::high_resolution_clock::time_point>> startTimes;
-  std::unordered_map<std::string, TimingInfo> timings;
+  Slot& threadSlot(int id) {
+    // keyed by instance rather than address, which a later profiler may reuse
+    thread_local uint64_t owner = 0;
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (owner != instance) {
+      buffer = &registerThread();
+      owner = instance;
+    }
+    Slot* slot = buffer->slots[id].load(std::memory_order_relaxed);
+    return slot ? *slot : addSlot(*buffer, id);
+  }
+
+  static void increment(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  static void record(Slot& slot, uint64_t elapsed) {
+    increment(slot.count, 1);
+    increment(slot.total, elapsed);
+    if (elapsed > slot.max.load(std::memory_order_relaxed)) slot.max.store(elapsed, std::memory_order_relaxed);
+    increment(slot.histogram[bucketOf(elapsed)], 1);
+  }
+
+  ThreadBuffer& registerThread();
+  Slot& addSlot(ThreadBuffer& buffer, int id);
+
+  static inline std::atomic<uint64_t> nextInstance{1};
+  const uint64_t instance;
+  std::mutex mutex; // guards names, ids and buffers; never taken on the hot path once warmed up
+  std::vector<std::string> names;
+  std::unordered_map<std::string, int> ids;
+  std::unordered_map<std::thread::id, std::unique_ptr<ThreadBuffer>> buffers;
 };
 
 // Singleton pattern to ensure only one profiler instance exists.
 extern Profiler profiler;
 
-#define PROFILE_START(id) profiler.start(id)
-#define PROFILE_END(id) profiler.end(id)
-#define PROFILE_RESULTS(test_name) profiler.results(test_name)
\ No newline at end of file
+// id "" only compiles when id is a string literal, since a call site keeps the id of its first name
+#ifdef CLRS_DISABLE_PROFILER
+#define PROFILE_START(id) ((void)sizeof(id ""))
+#define PROFILE_END(id) ((void)sizeof(id ""))
+#define PROFILE_RESULTS(test_name) ((void)0)
+#else
+#define PROFILE_START(id) do { static const int profileId = profiler.intern(id ""); profiler.start(profileId); } while (0)
+#define PROFILE_END(id) do { static const int profileId = profiler.intern(id ""); profiler.end(profileId); } while (0)
+#define PROFILE_RESULTS(test_name) profiler.results(test_name)
+#endif
@@ -0,0 +1,9 @@
+// Compiled with CLRS_DISABLE_PROFILER whatever the build options, for test_speed_profiler
+#include "helpers/speed_profiler.h"
+
+void disabledProfileSection() {
+  PROFILE_START("disabled section");
+  PROFILE_END("disabled section");
+  PROFILE_END("disabled section");
+  PROFILE_RESULTS("disabled section");
+}
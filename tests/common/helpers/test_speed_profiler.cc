@@ -0,0 +1,115 @@
+#include "gtest/gtest.h"
+
+#include "helpers/speed_profiler.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// defined in speed_profiler_disabled.cc, which is compiled with CLRS_DISABLE_PROFILER
+void disabledProfileSection();
+
+namespace {
+  // runs results() and returns the occurrences printed for name, or -1 if it has no row
+  long long occurrences(Profiler &p, const std::string &name) {
+    testing::internal::CaptureStdout();
+    p.results();
+    std::istringstream output(testing::internal::GetCapturedStdout());
+    std::string line;
+    // rows are "name   |  occurrences|..."
+    while (std::getline(output, line)) {
+      auto bar = line.find('|');
+      if (bar == std::string::npos || line.compare(0, name.size() + 1, name + " ") != 0) continue;
+      if (line.find_first_not_of(' ', name.size()) == bar) return std::stoll(line.substr(bar + 1));
+    }
+    return -1;
+  }
+}
+
+TEST(SpeedProfiler, BucketMath) {
+  for (uint64_t ticks = 0; ticks < 16; ++ticks) {
+    EXPECT_EQ(Profiler::bucketOf(ticks), static_cast<int>(ticks));
+    EXPECT_EQ(Profiler::bucketValue(ticks), ticks);
+  }
+  // each power of two starts a run of 8 buckets
+  for (int exponent = 4; exponent < 64; ++exponent) {
+    uint64_t power = uint64_t{1} << exponent;
+    EXPECT_EQ(Profiler::bucketOf(power), 16 + (exponent - 4) * 8) << exponent;
+    EXPECT_EQ(Profiler::bucketOf(power - 1) + 1, Profiler::bucketOf(power)) << exponent;
+  }
+  EXPECT_EQ(Profiler::bucketOf(std::numeric_limits<uint64_t>::max()), Profiler::HISTOGRAM_BUCKETS - 1);
+
+  // buckets never decrease, and the midpoint is within 1/16 of every value in the bucket
+  std::mt19937_64 gen(1);
+  for (int i = 0; i < 100000; ++i) {
+    uint64_t ticks = gen() >> (gen() % 64);
+    int bucket = Profiler::bucketOf(ticks);
+    ASSERT_LT(bucket, Profiler::HISTOGRAM_BUCKETS);
+    EXPECT_LE(bucket, Profiler::bucketOf(ticks + (ticks < std::numeric_limits<uint64_t>::max())));
+    double value = static_cast<double>(ticks);
+    EXPECT_LE(std::abs(Profiler::bucketValue(bucket) - value), value / 16) << ticks;
+  }
+}
+
+TEST(SpeedProfiler, MergesExitedThreads) {
+  Profiler p;
+  int id = p.intern("merged");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&p, id, t]() {
+      for (int i = 0; i <= t; ++i) {
+        p.start(id);
+        p.end(id);
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  p.start(id);
+  p.end(id);
+  EXPECT_EQ(occurrences(p, "merged"), 1 + 2 + 3 + 4 + 1);
+  // results() resets the counters, so an idle id has no row
+  EXPECT_EQ(occurrences(p, "merged"), -1);
+}
+
+TEST(SpeedProfiler, UnmatchedStartThrows) {
+  Profiler p;
+  int id = p.intern("unmatched");
+  EXPECT_THROW(p.end(id), std::logic_error);
+  p.start(id);
+  p.start(id);
+  p.end(id);
+  testing::internal::CaptureStdout();
+  EXPECT_THROW(p.results(), std::logic_error);
+  testing::internal::GetCapturedStdout();
+  p.end(id);
+  EXPECT_EQ(occurrences(p, "unmatched"), 2);
+
+  // a thread that exits inside a section leaves it open for good
+  std::thread([&p, id]() { p.start(id); }).join();
+  testing::internal::CaptureStdout();
+  EXPECT_THROW(p.results(), std::logic_error);
+  testing::internal::GetCapturedStdout();
+}
+
+TEST(SpeedProfiler, CompileOutSwitch) {
+  // the disabled section ends an id it never started and interns nothing
+  int before = profiler.intern("before the disabled section");
+  EXPECT_NO_THROW(disabledProfileSection());
+  EXPECT_EQ(profiler.intern("after the disabled section"), before + 1);
+}
+
+#ifndef CLRS_DISABLE_PROFILER
+TEST(SpeedProfiler, MacrosRecordEveryCall) {
+  for (int i = 0; i < 100; ++i) {
+    PROFILE_START("macro section");
+    PROFILE_END("macro section");
+  }
+  EXPECT_EQ(occurrences(profiler, "macro section"), 100);
+}
+#endif